@@ -1,34 +1,189 @@
 // Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
 
 #include "VlcMediaPrivatePCH.h"
-#include "Ticker.h"
 #include "vlc/vlc.h"
 #include <mutex>
 
 #define LOCTEXT_NAMESPACE "FVlcMediaPlayer"
 
 
+/** Maximum number of player events that can be pending between two game ticks. */
+#define VLCMEDIA_MAX_PLAYER_EVENTS 1024
+
+/** Media option that makes libvlc repeat looping media by itself (65535 is libvlc's maximum). */
+#define VLCMEDIA_INPUT_REPEAT_OPTION ":input-repeat=65535"
+
+
+namespace VlcMediaPlayer
+{
+	/**
+	 * Convert a libvlc track type to a media track type.
+	 *
+	 * @param Type The libvlc track type.
+	 * @param OutType Will contain the media track type.
+	 * @return true on success, false if the track type is not supported.
+	 */
+	bool ConvertTrackType(ELibvlcTrackType Type, EMediaTrackTypes& OutType)
+	{
+		switch (Type)
+		{
+		case ELibvlcTrackType::Audio:
+			OutType = EMediaTrackTypes::Audio;
+			return true;
+
+		case ELibvlcTrackType::Text:
+			OutType = EMediaTrackTypes::Caption;
+			return true;
+
+		case ELibvlcTrackType::Video:
+			OutType = EMediaTrackTypes::Video;
+			return true;
+
+		default:
+			return false;
+		}
+	}
+
+
+	/**
+	 * Convert a libvlc event to a player event.
+	 *
+	 * @param Event The libvlc event.
+	 * @param OutEvent Will contain the player event.
+	 * @return true on success, false if the event is not forwarded.
+	 */
+	bool ConvertEvent(const FLibvlcEvent& Event, FVlcMediaPlayerEvent& OutEvent)
+	{
+		switch (Event.Type)
+		{
+		case ELibvlcEventType::MediaParsedChanged:
+			OutEvent.Type = EVlcMediaPlayerEventType::Parsed;
+			break;
+
+		case ELibvlcEventType::MediaPlayerBuffering:
+			OutEvent.Type = EVlcMediaPlayerEventType::Buffering;
+			OutEvent.Buffering = Event.Descriptor.MediaPlayerBuffering.NewCache;
+			break;
+
+		case ELibvlcEventType::MediaPlayerEncounteredError:
+			OutEvent.Type = EVlcMediaPlayerEventType::Error;
+			break;
+
+		case ELibvlcEventType::MediaPlayerEndReached:
+			OutEvent.Type = EVlcMediaPlayerEventType::EndReached;
+			break;
+
+		case ELibvlcEventType::MediaPlayerESAdded:
+			OutEvent.Type = EVlcMediaPlayerEventType::TrackAdded;
+			OutEvent.Track.Id = Event.Descriptor.MediaPlayerESChanged.Id;
+			return ConvertTrackType(Event.Descriptor.MediaPlayerESChanged.Type, OutEvent.Track.Type);
+
+		case ELibvlcEventType::MediaPlayerESDeleted:
+			OutEvent.Type = EVlcMediaPlayerEventType::TrackRemoved;
+			OutEvent.Track.Id = Event.Descriptor.MediaPlayerESChanged.Id;
+			return ConvertTrackType(Event.Descriptor.MediaPlayerESChanged.Type, OutEvent.Track.Type);
+
+		case ELibvlcEventType::MediaPlayerESSelected:
+			OutEvent.Type = EVlcMediaPlayerEventType::TrackSelected;
+			OutEvent.Track.Id = Event.Descriptor.MediaPlayerESChanged.Id;
+			return ConvertTrackType(Event.Descriptor.MediaPlayerESChanged.Type, OutEvent.Track.Type);
+
+		case ELibvlcEventType::MediaPlayerLengthChanged:
+			OutEvent.Type = EVlcMediaPlayerEventType::LengthChanged;
+			OutEvent.Length = Event.Descriptor.MediaPlayerLengthChanged.NewLength * ETimespan::TicksPerMillisecond;
+			break;
+
+		case ELibvlcEventType::MediaPlayerOpening:
+			OutEvent.Type = EVlcMediaPlayerEventType::Opening;
+			break;
+
+		case ELibvlcEventType::MediaPlayerPaused:
+			OutEvent.Type = EVlcMediaPlayerEventType::Paused;
+			break;
+
+		case ELibvlcEventType::MediaPlayerPlaying:
+			OutEvent.Type = EVlcMediaPlayerEventType::Playing;
+			break;
+
+		case ELibvlcEventType::MediaPlayerPositionChanged:
+			OutEvent.Type = EVlcMediaPlayerEventType::PositionChanged;
+			OutEvent.Position = Event.Descriptor.MediaPlayerPositionChanged.NewPosition;
+			break;
+
+		case ELibvlcEventType::MediaPlayerSeekableChanged:
+			OutEvent.Type = EVlcMediaPlayerEventType::SeekableChanged;
+			OutEvent.Seekable = (Event.Descriptor.MediaPlayerSeekableChanged.new_seekable != 0);
+			break;
+
+		case ELibvlcEventType::MediaPlayerStopped:
+			OutEvent.Type = EVlcMediaPlayerEventType::Stopped;
+			break;
+
+		case ELibvlcEventType::MediaPlayerTimeChanged:
+			OutEvent.Type = EVlcMediaPlayerEventType::TimeChanged;
+			OutEvent.Time = Event.Descriptor.MediaPlayerTimeChanged.NewTime * ETimespan::TicksPerMillisecond;
+			break;
+
+		default:
+			return false;
+		}
+
+		return true;
+	}
+
+
+	/**
+	 * Check whether only the latest event of the given type matters.
+	 *
+	 * @param Type The event type.
+	 * @return true if the event type can be coalesced, false otherwise.
+	 */
+	bool IsCoalescable(EVlcMediaPlayerEventType Type)
+	{
+		return ((Type == EVlcMediaPlayerEventType::Buffering) ||
+			(Type == EVlcMediaPlayerEventType::LengthChanged) ||
+			(Type == EVlcMediaPlayerEventType::PositionChanged) ||
+			(Type == EVlcMediaPlayerEventType::TimeChanged));
+	}
+}
+
+
 /* FVlcMediaPlayer structors
  *****************************************************************************/
 
 
-FVlcMediaPlayer::FVlcMediaPlayer(FLibvlcInstance* InVlcInstance)
-	: CurrentTime(0.0f)
-	, DataPosition(0)
+FVlcMediaPlayer::FVlcMediaPlayer(FLibvlcInstance* InVlcInstance, const FVlcMediaSchedulerRef& InScheduler, const FVlcMediaPlayerPoolRef& InPlayerPool)
+	: Clock(MakeShareable(new FVlcMediaPlayerClock))
 	, DesiredRate(0.0)
+	, EventGeneration(0)
+	, Events(VLCMEDIA_MAX_PLAYER_EVENTS)
+	, HandoffPending(false)
+	, NextPlayer(nullptr)
+	, NextPooled(false)
+	, NextRepeating(false)
+	, NextState((int32)ELibvlcState::NothingSpecial)
+	, NumDroppedEvents(0)
+	, OpenTime(0.0)
+	, PendingTeardowns(MakeShareable(new FThreadSafeCounter))
 	, Player(nullptr)
+	, PlayerPool(InPlayerPool)
+	, PrefetchRequested(false)
+	, Repeating(false)
+	, SchedulerIndex(INDEX_NONE)
+	, Scheduler(InScheduler)
 	, ShouldLoop(false)
+	, State(MakeShareable(new FVlcMediaPlayerState))
+	, Status((int32)EVlcMediaPlayerStatus::Closed)
 	, VlcInstance(InVlcInstance)
-{
-	TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FVlcMediaPlayer::HandleTicker), 0.0f);
-}
+{ }
 
 
 FVlcMediaPlayer::~FVlcMediaPlayer()
 {
 	Close();
 
-	FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	// the player stays active while its libvlc players are being stopped
+	Scheduler->Deactivate(*this);
 }
 
 
@@ -37,12 +192,7 @@ FVlcMediaPlayer::~FVlcMediaPlayer()
 
 FTimespan FVlcMediaPlayer::GetDuration() const
 {
-	if (Player == nullptr)
-	{
-		return FTimespan::Zero();
-	}
-
-	return FTimespan::FromMilliseconds(FVlc::MediaPlayerGetLength(Player));
+	return FTimespan::FromMilliseconds(State->GetSnapshot().Length);
 }
 
 
@@ -66,13 +216,13 @@ bool FVlcMediaPlayer::SupportsRate(float Rate, bool Unthinned) const
 
 bool FVlcMediaPlayer::SupportsScrubbing() const
 {
-	return ((Player != nullptr) && (FVlc::MediaPlayerIsSeekable(Player) != 0));
+	return State->GetSnapshot().Seekable;
 }
 
 
 bool FVlcMediaPlayer::SupportsSeeking() const
 {
-	return ((Player != nullptr) && (FVlc::MediaPlayerIsSeekable(Player) != 0));
+	return State->GetSnapshot().Seekable;
 }
 
 
@@ -81,22 +231,51 @@ bool FVlcMediaPlayer::SupportsSeeking() const
 
 void FVlcMediaPlayer::Close()
 {
+	ClearQueue();
+
 	if (Player == nullptr)
 	{
+		Source.Reset();
+
 		return;
 	}
 
-	Data.Reset();
-	Tracks.Reset();
+	DetachMediaEvents(Player);
+
+	// reads that wait for stream data or the read-ahead cache would hold up stopping
+	if (Source.IsValid())
+	{
+		Source->Interrupt();
+	}
+
+	// the media keeps its source alive until it is freed
+	RetiredTracks.Append(Tracks);
+	PlayerPool->ReleaseDeferred(Player, RetiredTracks, PendingTeardowns);
 
-	// release player
-	FVlc::MediaPlayerStop(Player);
-	FVlc::MediaPlayerRelease(Player);
 	Player = nullptr;
+	RetiredTracks.Reset();
+	Source.Reset();
+	Tracks.Reset();
+
+	// events that were sent before the player was detached are dropped when they are processed
+	FPlatformAtomics::InterlockedIncrement(&EventGeneration);
+
+	SetStatus(EVlcMediaPlayerStatus::Closing);
 
 	// reset fields
-	DataPosition = 0;
+	Clock->SetRunning(false);
+	Clock->Reset(FTimespan::Zero());
+	LoopDetector.Reset();
 	MediaUrl = FString();
+	Repeating = false;
+	OpenStats = FVlcMediaOpenStats();
+	OpenTime = 0.0;
+	State->Reset();
+
+	{
+		FScopeLock Lock(&LoopStatsCriticalSection);
+		LoopStats = FVlcMediaLoopStats();
+	}
 
 	ClosedEvent.Broadcast();
 }
@@ -110,12 +289,9 @@ const IMediaInfo& FVlcMediaPlayer::GetMediaInfo() const
 
 float FVlcMediaPlayer::GetRate() const
 {
-	if ((Player == nullptr) || !IsPlaying())
-	{
-		return 0.0f;
-	}
+	const FVlcMediaPlayerSnapshot Snapshot = State->GetSnapshot();
 
-	return FVlc::MediaPlayerGetRate(Player);
+	return (Snapshot.State == ELibvlcState::Playing) ? Snapshot.Rate : 0.0f;
 }
 
 
@@ -126,15 +302,7 @@ FTimespan FVlcMediaPlayer::GetTime() const
 		return FTimespan::Zero();
 	}
 
-	return FTimespan::FromSeconds(CurrentTime);
-	/*int64 Time = FMath::Min<int64>(0, FVlc::MediaPlayerGetTime(Player));
-
-	if (Time < 0)
-	{
-		return FTimespan::Zero();
-	}
-
-	return FTimespan::FromMilliseconds(Time);*/
+	return Clock->GetTime();
 }
 
 
@@ -152,26 +320,21 @@ bool FVlcMediaPlayer::IsLooping() const
 
 bool FVlcMediaPlayer::IsPaused() const
 {
-	return ((Player != nullptr) && (FVlc::MediaPlayerGetState(Player) == ELibvlcState::Paused));
+	return (State->GetSnapshot().State == ELibvlcState::Paused);
 }
 
 
 bool FVlcMediaPlayer::IsPlaying() const
 {
-	return ((Player != nullptr) && (FVlc::MediaPlayerGetState(Player) == ELibvlcState::Playing));
+	return (State->GetSnapshot().State == ELibvlcState::Playing);
 }
 
 
 bool FVlcMediaPlayer::IsReady() const
 {
-	if (Player == nullptr)
-	{
-		return false;
-	}
+	const ELibvlcState PlayerState = State->GetSnapshot().State;
 
-	ELibvlcState State = FVlc::MediaPlayerGetState(Player);
-
-	return ((State >= ELibvlcState::Playing) && (State < ELibvlcState::Error));
+	return ((PlayerState >= ELibvlcState::Playing) && (PlayerState < ELibvlcState::Error));
 }
 
 
@@ -184,9 +347,9 @@ bool FVlcMediaPlayer::Open(const FString& Url)
 
 	Close();
 
-	FLibvlcMedia* NewMedia = (Url.Contains(TEXT("://")))
-		? FVlc::MediaNewLocation(VlcInstance, TCHAR_TO_ANSI(*Url))
-		: FVlc::MediaNewPath(VlcInstance, TCHAR_TO_ANSI(*Url));
+	OpenTime = FPlatformTime::Seconds();
+
+	FLibvlcMedia* NewMedia = CreateMediaForUrl(Url, Source);
 
 	if (NewMedia == nullptr)
 	{
@@ -206,23 +369,20 @@ bool FVlcMediaPlayer::Open( const TSharedRef<TArray<uint8>, ESPMode::ThreadSafe>
 		return false;
 	}
 
-	Data = Buffer;
+	Close();
+
+	OpenTime = FPlatformTime::Seconds();
 
-	FLibvlcMedia* NewMedia = FVlc::MediaNewCallbacks(
-		VlcInstance,
-		&FVlcMediaPlayer::HandleMediaOpen,
-		&FVlcMediaPlayer::HandleMediaRead,
-		&FVlcMediaPlayer::HandleMediaSeek,
-		&FVlcMediaPlayer::HandleMediaClose,
-		this);
+	FVlcMediaSourceRef NewSource = MakeShareable(new FVlcMediaBufferSource(Buffer));
+	FLibvlcMedia* NewMedia = FVlcMediaSource::CreateMedia(VlcInstance, NewSource);
 
 	if (NewMedia == nullptr)
 	{
-		Data.Reset();
-
 		return false;
 	}
 
+	Source = NewSource;
+
 	MediaUrl = OriginalUrl;
 
 	return InitializeMediaPlayer(NewMedia);
@@ -237,7 +397,7 @@ bool FVlcMediaPlayer::Seek( const FTimespan& Time )
 	}
 
 	FVlc::MediaPlayerSetTime(Player, Time.GetTotalMilliseconds());
-	CurrentTime = Time.GetTotalSeconds();
+	Clock->Reset(Time);
 
 	return true;
 }
@@ -263,6 +423,12 @@ bool FVlcMediaPlayer::SetRate(float Rate)
 	}
 
 	DesiredRate = Rate;
+	State->SetRate(Rate);
+
+	if (!FMath::IsNearlyZero(Rate))
+	{
+		Clock->SetRate(Rate);
+	}
 
 	if (FMath::IsNearlyZero(Rate))
 	{
@@ -280,249 +446,1119 @@ bool FVlcMediaPlayer::SetRate(float Rate)
 }
 
 
-/* FVlcMediaPlayer implementation
+/* IVlcMediaPlayer interface
  *****************************************************************************/
 
-bool FVlcMediaPlayer::InitializeMediaPlayer(FLibvlcMedia* Media)
+IVlcMediaAudioTrack* FVlcMediaPlayer::GetAudioTrack(uint32 TrackIndex)
 {
-	Player = FVlc::MediaPlayerNewFromMedia(Media);
-
-	if (Player == nullptr)
+	if (!Tracks.IsValidIndex(TrackIndex) || (Tracks[TrackIndex]->GetType() != EMediaTrackTypes::Audio))
 	{
-		Close();
+		return nullptr;
+	}
 
-		return false;
+	return &static_cast<FVlcMediaAudioTrack&>(*Tracks[TrackIndex]);
+}
+
+
+FVlcMediaLoopStats FVlcMediaPlayer::GetLoopStats() const
+{
+	FScopeLock Lock(&LoopStatsCriticalSection);
+	return LoopStats;
+}
+
+
+FVlcMediaOpenStats FVlcMediaPlayer::GetOpenStats() const
+{
+	return OpenStats;
+}
+
+
+FVlcMediaPrefetchStats FVlcMediaPlayer::GetPrefetchStats() const
+{
+	return Source.IsValid() ? Source->GetPrefetchStats() : FVlcMediaPrefetchStats();
+}
+
+
+EVlcMediaPlayerStatus FVlcMediaPlayer::GetStatus() const
+{
+	return (EVlcMediaPlayerStatus)Status;
+}
+
+
+IVlcMediaVideoTrack* FVlcMediaPlayer::GetVideoTrack(uint32 TrackIndex)
+{
+	if (!Tracks.IsValidIndex(TrackIndex) || (Tracks[TrackIndex]->GetType() != EMediaTrackTypes::Video))
+	{
+		return nullptr;
 	}
 
-	// attach to event managers
-	FLibvlcEventManager* MediaEventManager = FVlc::MediaEventManager(Media);
-	FLibvlcEventManager* PlayerEventManager = FVlc::MediaPlayerEventManager(Player);
+	return &static_cast<FVlcMediaVideoTrack&>(*Tracks[TrackIndex]);
+}
+
 
-	if ((MediaEventManager == nullptr) || (PlayerEventManager == nullptr))
+void FVlcMediaPlayer::ClearQueue()
+{
+	HandoffPending = false;
+
+	if (NextPlayer == nullptr)
 	{
-		Close();
+		return;
+	}
+
+	// the pool removes the scratch callbacks once the player stopped
+	if (NextSource.IsValid())
+	{
+		NextSource->Interrupt();
+	}
 
+	PlayerPool->ReleaseDeferred(NextPlayer, TArray<IMediaTrackRef>(), PendingTeardowns);
+
+	NextPlayer = nullptr;
+	NextSource.Reset();
+	NextUrl = FString();
+}
+
+
+bool FVlcMediaPlayer::OpenStream(const IVlcMediaStreamRef& InStream, const FString& OriginalUrl)
+{
+	if (OriginalUrl.IsEmpty())
+	{
 		return false;
 	}
 
-	FVlc::EventAttach(MediaEventManager, ELibvlcEventType::MediaParsedChanged, &FVlcMediaPlayer::HandleEventCallback, this);
-	FVlc::EventAttach(PlayerEventManager, ELibvlcEventType::MediaPlayerEndReached, &FVlcMediaPlayer::HandleEventCallback, this);
-	FVlc::EventAttach(PlayerEventManager, ELibvlcEventType::MediaPlayerPlaying, &FVlcMediaPlayer::HandleEventCallback, this);
+	Close();
 
-	//FVlc::MediaParseAsync(Media);
-	FVlc::MediaPlayerPlay(Player);
-	FVlc::MediaRelease(Media);
+	OpenTime = FPlatformTime::Seconds();
 
-	OpenedEvent.Broadcast(MediaUrl);
+	// the module only creates streams of this type
+	FVlcMediaSourceRef NewSource = MakeShareable(new FVlcMediaStreamSource(StaticCastSharedRef<FVlcMediaStream>(InStream)));
+	FLibvlcMedia* NewMedia = FVlcMediaSource::CreateMedia(VlcInstance, NewSource);
 
-	return true;
+	if (NewMedia == nullptr)
+	{
+		return false;
+	}
+
+	Source = NewSource;
+
+	MediaUrl = OriginalUrl;
+
+	return InitializeMediaPlayer(NewMedia);
 }
 
 
-void FVlcMediaPlayer::InitializeTracks()
+bool FVlcMediaPlayer::QueueNext(const FString& Url)
 {
+	if (Url.IsEmpty())
+	{
+		return false;
+	}
+
 	if (Player == nullptr)
 	{
-		return;
+		return Open(Url);
 	}
-	
-	FVlc::MediaPlayerStop(Player);
 
-	FLibvlcMedia* Media = FVlc::MediaPlayerGetMedia(Player);
+	ClearQueue();
 
-	if (Media == nullptr)
+	FLibvlcMedia* NewMedia = CreateMediaForUrl(Url, NextSource);
+
+	if (NewMedia == nullptr)
 	{
-		return;
+		return false;
 	}
 
-	Tracks.Empty();
+	NextUrl = Url;
+
+	return InitializeNextPlayer(NewMedia);
+}
 
-	// audio tracks
-	FLibvlcTrackDescription* AudioTrackDescr = FVlc::AudioGetTrackDescription(Player);
 
-	while (AudioTrackDescr != nullptr)
+bool FVlcMediaPlayer::QueueNext(const TSharedRef<TArray<uint8>, ESPMode::ThreadSafe>& Buffer, const FString& OriginalUrl)
+{
+	if ((Buffer->Num() == 0) || OriginalUrl.IsEmpty())
 	{
-		if (AudioTrackDescr->Id != -1)
-		{
-			Tracks.Add(MakeShareable(new FVlcMediaAudioTrack(Player, Tracks.Num(), AudioTrackDescr)));
-		}
+		return false;
+	}
 
-		AudioTrackDescr = AudioTrackDescr->Next;
+	if (Player == nullptr)
+	{
+		return Open(Buffer, OriginalUrl);
 	}
 
-	FVlc::TrackDescriptionListRelease(AudioTrackDescr);
+	ClearQueue();
 
-	// caption tracks
-	FLibvlcTrackDescription* CaptionTrackDescr = FVlc::VideoGetSpuDescription(Player);
+	FVlcMediaSourceRef NewSource = MakeShareable(new FVlcMediaBufferSource(Buffer));
+	FLibvlcMedia* NewMedia = FVlcMediaSource::CreateMedia(VlcInstance, NewSource);
 
-	while (CaptionTrackDescr != nullptr)
+	if (NewMedia == nullptr)
 	{
-		if (CaptionTrackDescr->Id != -1)
-		{
-			Tracks.Add(MakeShareable(new FVlcMediaCaptionTrack(Player, Tracks.Num(), CaptionTrackDescr)));
-		}
-
-		CaptionTrackDescr = CaptionTrackDescr->Next;
+		return false;
 	}
 
-	FVlc::TrackDescriptionListRelease(AudioTrackDescr);
+	NextSource = NewSource;
 
-	// video tracks
-	FLibvlcTrackDescription* VideoTrackDescr = FVlc::VideoGetTrackDescription(Player);
+	NextUrl = OriginalUrl;
 
-	while (VideoTrackDescr != nullptr)
-	{
-		if (VideoTrackDescr->Id != -1)
-		{
-			Tracks.Add(MakeShareable(new FVlcMediaVideoTrack(Player, Tracks.Num(), VideoTrackDescr)));
-		}
+	return InitializeNextPlayer(NewMedia);
+}
 
-		VideoTrackDescr = VideoTrackDescr->Next;
-	}
 
-	FVlc::TrackDescriptionListRelease(VideoTrackDescr);
+void FVlcMediaPlayer::SetPrefetchOptions(const FVlcMediaPrefetchOptions& Options)
+{
+	PrefetchOptions = Options;
+	PrefetchRequested = true;
 }
 
 
-/* FVlcMediaPlayer callbacks
+/* FVlcMediaPlayer implementation
  *****************************************************************************/
 
-bool FVlcMediaPlayer::HandleTicker(float DeltaTime)
+FLibvlcMedia* FVlcMediaPlayer::CreateMediaForUrl(const FString& Url, FVlcMediaSourcePtr& OutSource) const
 {
-	if (Tracks.Num() == 0)
+	if (Url.Contains(TEXT("://")))
 	{
-		InitializeTracks();
+		return FVlc::MediaNewLocation(VlcInstance, TCHAR_TO_ANSI(*Url));
 	}
-	else
+
+	FVlcMediaSourcePtr NewSource;
+
+	if (IPlatformFile::GetPlatformPhysical().FileExists(*Url))
 	{
-		// process events
-		ELibvlcEventType Event;
+		// libvlc reads files on disk by itself unless read-ahead was requested
+		if (!PrefetchRequested)
+		{
+			return FVlc::MediaNewPath(VlcInstance, TCHAR_TO_ANSI(*Url));
+		}
+
+		// mapped files are paged in as they are read, so that only their working set stays resident
+		TSharedRef<FVlcMediaMappedFile, ESPMode::ThreadSafe> MappedFile = MakeShareable(new FVlcMediaMappedFile(Url));
 
-		while (Events.Dequeue(Event))
+		if (!MappedFile->IsValid())
 		{
-			switch (Event)
-			{
-			case ELibvlcEventType::MediaParsedChanged:
-				//MediaPlayer->InitializeTracks();
-				break;
+			UE_LOG(LogVlcMedia, Verbose, TEXT("Failed to map %s, falling back to file access."), *Url);
+		}
+		else if (PrefetchOptions.BlockSize > 0)
+		{
+			TSharedRef<FVlcMediaPrefetchReader, ESPMode::ThreadSafe> Reader = MakeShareable(new FVlcMediaMappedFileReader(MappedFile, PrefetchOptions));
+			Reader->Start();
 
-			case ELibvlcEventType::MediaPlayerEndReached:
-				FVlc::MediaPlayerStop(Player);
-				CurrentTime = 0.0f;
+			NewSource = MakeShareable(new FVlcMediaPrefetchSource(Reader));
+		}
+		else
+		{
+			NewSource = MakeShareable(new FVlcMediaMappedFileSource(MappedFile));
+		}
+	}
+	else
+	{
+		// files in pak files are not on disk, but the engine's file system reads them in blocks
+		IFileHandle* FileHandle = FPlatformFileManager::Get().GetPlatformFile().OpenRead(*Url);
+		const int64 FileSize = (FileHandle != nullptr) ? FileHandle->Size() : -1;
 
-				if (ShouldLoop && (DesiredRate != 0.0f))
-				{
-					SetRate(DesiredRate);
-				}
-				break;
+		if (FileSize > 0)
+		{
+			// these reads may be slow, so they always go through the cache
+			const FVlcMediaPrefetchOptions ReaderOptions = (PrefetchOptions.BlockSize > 0) ? PrefetchOptions : FVlcMediaPrefetchOptions();
 
-			case ELibvlcEventType::MediaPlayerPlaying:
-				break;
+			TSharedRef<FVlcMediaPrefetchReader, ESPMode::ThreadSafe> Reader = MakeShareable(new FVlcMediaFileHandleReader(FileHandle, (uint64)FileSize, ReaderOptions));
+			Reader->Start();
 
-			default:
-				continue;
-			}
+			NewSource = MakeShareable(new FVlcMediaPrefetchSource(Reader));
 		}
-
-		// update tracks
-		if (IsPlaying())
+		else
 		{
-			CurrentTime += GetRate() * DeltaTime;
+			delete FileHandle;
 
-			for (IMediaTrackRef& Track : Tracks)
-			{
-				FVlcMediaTrack& VlcTrack = static_cast<FVlcMediaTrack&>(*Track);
-				VlcTrack.SetTime(CurrentTime);
-			}
+			UE_LOG(LogVlcMedia, Verbose, TEXT("Failed to open %s through the engine's file system, falling back to file access."), *Url);
 		}
 	}
 
-	return true;
-}
+	if (NewSource.IsValid())
+	{
+		FLibvlcMedia* NewMedia = FVlcMediaSource::CreateMedia(VlcInstance, NewSource.ToSharedRef());
 
+		if (NewMedia != nullptr)
+		{
+			OutSource = NewSource;
 
-/* FVlcMediaPlayer static functions
- *****************************************************************************/
+			return NewMedia;
+		}
+	}
 
-void FVlcMediaPlayer::HandleEventCallback(FLibvlcEvent* Event, void* UserData)
-{
-	FVlcMediaPlayer* MediaPlayer = (FVlcMediaPlayer*)UserData;
-	MediaPlayer->Events.Enqueue(Event->Type);
+	return FVlc::MediaNewPath(VlcInstance, TCHAR_TO_ANSI(*Url));
 }
 
 
-int FVlcMediaPlayer::HandleMediaOpen(void* Opaque, void** OutData, uint64* OutSize)
+bool FVlcMediaPlayer::InitializeMediaPlayer(FLibvlcMedia* Media)
 {
-	FVlcMediaPlayer* MediaPlayer = (FVlcMediaPlayer*)Opaque;
+	// pooled players have their player events attached already
+	Player = PlayerPool->Acquire(&FVlcMediaPlayer::HandleEventCallback, this, OpenStats.UsedPooledPlayer);
 
-	if (!MediaPlayer->Data.IsValid())
+	if (Player == nullptr)
 	{
-		return 0;
+		FVlc::MediaRelease(Media);
+		Close();
+		SetStatus(EVlcMediaPlayerStatus::Error);
+
+		return false;
 	}
 
-	*OutData = MediaPlayer->Data->GetData();
-	*OutSize = MediaPlayer->Data->Num();
-	
-	return 0;
-}
+	// let libvlc wrap around inside the same input, so that demuxer and decoders stay primed
+	if (ShouldLoop)
+	{
+		FVlc::MediaAddOption(Media, VLCMEDIA_INPUT_REPEAT_OPTION);
+		Repeating = true;
+	}
 
+	FVlc::MediaPlayerSetMedia(Player, Media);
 
-SSIZE_T FVlcMediaPlayer::HandleMediaRead(void* Opaque, void* Buffer, SIZE_T Length)
-{
-	FVlcMediaPlayer* MediaPlayer = (FVlcMediaPlayer*)Opaque;
-	TSharedPtr<TArray<uint8>, ESPMode::ThreadSafe> Data = MediaPlayer->Data;
+	// attach to media events
+	FLibvlcEventManager* MediaEventManager = FVlc::MediaEventManager(Media);
 
-	if (!MediaPlayer->Data.IsValid())
+	if (MediaEventManager == nullptr)
 	{
-		return -1;
+		FVlc::MediaRelease(Media);
+		Close();
+		SetStatus(EVlcMediaPlayerStatus::Error);
+
+		return false;
 	}
 
-	SIZE_T DataSize = (SIZE_T)Data->Num();
-	SIZE_T BytesToRead = FMath::Min(Length, DataSize);
-	SIZE_T& DataPosition = MediaPlayer->DataPosition;
+	FVlc::EventAttach(MediaEventManager, ELibvlcEventType::MediaParsedChanged, &FVlcMediaPlayer::HandleEventCallback, this);
+
+	// libvlc opens the input on its own thread, so starting playback does not block
+	SetStatus(EVlcMediaPlayerStatus::Opening);
+
+	//FVlc::MediaParseAsync(Media);
+	FVlc::MediaPlayerPlay(Player);
+	FVlc::MediaRelease(Media);
+
+	Scheduler->Activate(*this);
+
+	OpenStats.OpenDuration = FPlatformTime::Seconds() - OpenTime;
+	OpenedEvent.Broadcast(MediaUrl);
+
+	return true;
+}
+
+
+bool FVlcMediaPlayer::InitializeNextPlayer(FLibvlcMedia* Media)
+{
+	NextPlayer = PlayerPool->Acquire(&FVlcMediaPlayer::HandleNextEventCallback, this, NextPooled);
 
-	if ((DataSize - BytesToRead) < DataPosition)
+	if (NextPlayer == nullptr)
 	{
-		BytesToRead = DataSize - DataPosition;
+		FVlc::MediaRelease(Media);
+		ClearQueue();
+
+		return false;
 	}
 
-	if (BytesToRead > 0)
+	// connect and buffer the input, but hold playback at the first frame
+	FVlc::MediaAddOption(Media, ":start-paused");
+
+	NextRepeating = ShouldLoop;
+
+	if (NextRepeating)
 	{
-		FMemory::Memcpy(Buffer, Data->GetData() + DataPosition, BytesToRead);
-		DataPosition += BytesToRead;
+		FVlc::MediaAddOption(Media, VLCMEDIA_INPUT_REPEAT_OPTION);
 	}
 
-	return (SSIZE_T)BytesToRead;
+	FPlatformAtomics::InterlockedExchange(&NextState, (int32)ELibvlcState::Opening);
+
+	SetDiscardOutput(NextPlayer);
+	FVlc::MediaPlayerSetMedia(NextPlayer, Media);
+	FVlc::MediaPlayerPlay(NextPlayer);
+	FVlc::MediaRelease(Media);
+
+	return true;
 }
 
 
-int FVlcMediaPlayer::HandleMediaSeek(void* Opaque, uint64 Offset)
+void FVlcMediaPlayer::AdvanceQueue()
 {
-	FVlcMediaPlayer* MediaPlayer = (FVlcMediaPlayer*)Opaque;
-	TSharedPtr<TArray<uint8>, ESPMode::ThreadSafe> Data = MediaPlayer->Data;
+	const ELibvlcState NextPlayerState = (ELibvlcState)NextState;
+
+	if (NextPlayerState == ELibvlcState::Error)
+	{
+		UE_LOG(LogVlcMedia, Warning, TEXT("Failed to preload %s"), *NextUrl);
+
+		ClearQueue();
+		FVlc::MediaPlayerStop(Player);
+		Clock->Reset(FTimespan::Zero());
 
-	if (!MediaPlayer->Data.IsValid())
+		return;
+	}
+
+	// wait until the queued media is held at its start
+	if (NextPlayerState != ELibvlcState::Paused)
 	{
-		return -1;
+		return;
 	}
 
-	if ((uint64)Data->Num() <= Offset)
+	HandoffPending = false;
+
+	// events that the finished player sends from now on, including while stopping, are dropped
+	FLibvlcMediaPlayer* PreviousPlayer = Player;
+	PlayerPool->SetCallback(PreviousPlayer, nullptr, nullptr);
+	DetachMediaEvents(PreviousPlayer);
+
+	// events that the finished player queued before are dropped when they are processed
+	FPlatformAtomics::InterlockedIncrement(&EventGeneration);
+
+	Player = NextPlayer;
+	NextPlayer = nullptr;
+
+	PlayerPool->SetCallback(Player, &FVlcMediaPlayer::HandleEventCallback, this);
+	AttachMediaEvents(Player);
+
+	// the finished media's source is released with its media
+	Source = NextSource;
+	NextSource.Reset();
+
+	Clock->SetRunning(false);
+	Clock->Reset(FTimespan::Zero());
+	LoopDetector.Reset();
+	MediaUrl = NextUrl;
+	NextUrl = FString();
+	OpenStats = FVlcMediaOpenStats();
+	OpenStats.UsedPooledPlayer = NextPooled;
+	OpenTime = FPlatformTime::Seconds();
+	Repeating = NextRepeating;
+	State->Reset();
+
 	{
-		return -1;
+		FScopeLock Lock(&LoopStatsCriticalSection);
+		LoopStats = FVlcMediaLoopStats();
 	}
 
-	MediaPlayer->DataPosition = SIZE_T(Offset);
+	// move each track to the next stream of its type, and drop the tracks that have no counterpart
+	FLibvlcMedia* Media = FVlc::MediaPlayerGetMedia(Player);
+	FLibvlcMediaTrack** MediaTracks = nullptr;
+	const uint32 NumMediaTracks = (Media != nullptr) ? FVlc::MediaTracksGet(Media, &MediaTracks) : 0;
+
+	TArray<bool> UsedMediaTracks;
+	UsedMediaTracks.AddZeroed(NumMediaTracks);
+
+	TArray<FVlcMediaPlayerEventTrack> UnmatchedTracks;
+	const int32 NumPreviousTracks = Tracks.Num();
+
+	for (const IMediaTrackRef& Track : Tracks)
+	{
+		FVlcMediaTrack& VlcTrack = static_cast<FVlcMediaTrack&>(*Track);
+		int32 NewTrackId = -1;
+
+		for (uint32 MediaTrackIndex = 0; MediaTrackIndex < NumMediaTracks; ++MediaTrackIndex)
+		{
+			EMediaTrackTypes MediaTrackType;
+
+			if (!UsedMediaTracks[MediaTrackIndex] && VlcMediaPlayer::ConvertTrackType(MediaTracks[MediaTrackIndex]->Type, MediaTrackType) && (MediaTrackType == Track->GetType()))
+			{
+				UsedMediaTracks[MediaTrackIndex] = true;
+				NewTrackId = MediaTracks[MediaTrackIndex]->Id;
 
-	return 0;
+				break;
+			}
+		}
+
+		if (NewTrackId != -1)
+		{
+			VlcTrack.Rebind(Player, NewTrackId);
+		}
+		else
+		{
+			FVlcMediaPlayerEventTrack& UnmatchedTrack = UnmatchedTracks[UnmatchedTracks.AddZeroed()];
+			{
+				UnmatchedTrack.Type = Track->GetType();
+				UnmatchedTrack.Id = VlcTrack.GetTrackId();
+			}
+		}
+	}
+
+	if (MediaTracks != nullptr)
+	{
+		FVlc::MediaTracksRelease(MediaTracks, NumMediaTracks);
+	}
+
+	if (Media != nullptr)
+	{
+		FVlc::MediaRelease(Media);
+	}
+
+	// the finished media ended, so its outputs are idle, but they refer to the tracks until the player stopped in the background
+	RetiredTracks.Append(Tracks);
+	PlayerPool->ReleaseDeferred(PreviousPlayer, RetiredTracks, PendingTeardowns);
+	RetiredTracks.Reset();
+
+	for (const FVlcMediaPlayerEventTrack& UnmatchedTrack : UnmatchedTracks)
+	{
+		RemoveTrack(UnmatchedTrack.Type, UnmatchedTrack.Id);
+	}
+
+	// the preloading player reported its length and seekability before its events were forwarded
+	const int64 Length = FMath::Max<int64>(FVlc::MediaPlayerGetLength(Player), 0);
+	const bool Seekable = (FVlc::MediaPlayerIsSeekable(Player) != 0);
+
+	State->SetLength(Length);
+	State->SetSeekable(Seekable);
+
+	// the preloading player selected its streams before its events were forwarded
+	State->SetSelectedTrack(ELibvlcTrackType::Audio, FVlc::AudioGetTrack(Player));
+	State->SetSelectedTrack(ELibvlcTrackType::Text, FVlc::VideoGetSpu(Player));
+	State->SetSelectedTrack(ELibvlcTrackType::Video, FVlc::VideoGetTrack(Player));
+
+	// streams that had no counterpart in the previous media
+	SyncTracks();
+
+	// new tracks restart their streams as well, so that no output keeps the preloading player's scratch callbacks
+	for (int32 TrackIndex = NumPreviousTracks - UnmatchedTracks.Num(); TrackIndex < Tracks.Num(); ++TrackIndex)
+	{
+		FVlcMediaTrack& VlcTrack = static_cast<FVlcMediaTrack&>(*Tracks[TrackIndex]);
+		VlcTrack.Rebind(Player, VlcTrack.GetTrackId());
+	}
+
+	// continue at the rate of the finished media
+	if (FMath::IsNearlyZero(DesiredRate))
+	{
+		FVlc::MediaPlayerPlay(Player);
+	}
+	else
+	{
+		SetRate(DesiredRate);
+	}
+
+	FVlcMediaPlayerEvent& AdvancedEvent = EventBatch[EventBatch.AddZeroed()];
+	{
+		AdvancedEvent.Type = EVlcMediaPlayerEventType::QueueAdvanced;
+	}
+
+	// subscribers did not receive the preloading player's events either
+	FVlcMediaPlayerEvent& LengthEvent = EventBatch[EventBatch.AddZeroed()];
+	{
+		LengthEvent.Type = EVlcMediaPlayerEventType::LengthChanged;
+		LengthEvent.Length = Length * ETimespan::TicksPerMillisecond;
+	}
+
+	FVlcMediaPlayerEvent& SeekableEvent = EventBatch[EventBatch.AddZeroed()];
+	{
+		SeekableEvent.Type = EVlcMediaPlayerEventType::SeekableChanged;
+		SeekableEvent.Seekable = Seekable;
+	}
+
+	UE_LOG(LogVlcMedia, Verbose, TEXT("Advanced to %s (pooled player: %s)"), *MediaUrl, OpenStats.UsedPooledPlayer ? TEXT("yes") : TEXT("no"));
+}
+
+
+void FVlcMediaPlayer::SetDiscardAudioOutput(FLibvlcMediaPlayer* TargetPlayer)
+{
+	// the callbacks do not refer to this player, because the libvlc player may be stopped after it is gone
+	FVlc::AudioSetCallbacks(TargetPlayer, &FVlcMediaPlayer::HandleDiscardAudioPlay, nullptr, nullptr, nullptr, nullptr, nullptr);
+	FVlc::AudioSetFormatCallbacks(TargetPlayer, nullptr, nullptr);
+	FVlc::AudioSetFormat(TargetPlayer, "S16N", 44100, 2);
+}
+
+
+void FVlcMediaPlayer::SetDiscardOutput(FLibvlcMediaPlayer* TargetPlayer)
+{
+	SetDiscardAudioOutput(TargetPlayer);
+	SetDiscardVideoOutput(TargetPlayer);
+}
+
+
+void FVlcMediaPlayer::SetDiscardVideoOutput(FLibvlcMediaPlayer* TargetPlayer)
+{
+	FVlc::VideoSetCallbacks(TargetPlayer, &FVlcMediaPlayer::HandleDiscardVideoLock, nullptr, nullptr, nullptr);
+	FVlc::VideoSetFormatCallbacks(TargetPlayer, &FVlcMediaPlayer::HandleDiscardVideoSetup, &FVlcMediaPlayer::HandleDiscardVideoCleanup);
+}
+
+
+void FVlcMediaPlayer::SetStatus(EVlcMediaPlayerStatus NewStatus)
+{
+	if (FPlatformAtomics::InterlockedExchange(&Status, (int32)NewStatus) == (int32)NewStatus)
+	{
+		return;
+	}
+
+	FVlcMediaPlayerEvent StatusEvent;
+	{
+		FMemory::Memzero(StatusEvent);
+		StatusEvent.Type = EVlcMediaPlayerEventType::StatusChanged;
+		StatusEvent.Status = NewStatus;
+	}
+
+	QueueEvent(StatusEvent);
+}
+
+
+void FVlcMediaPlayer::QueueEvent(const FVlcMediaPlayerEvent& Event)
+{
+	FQueuedEvent QueuedEvent;
+	{
+		QueuedEvent.Event = Event;
+		QueuedEvent.Generation = EventGeneration;
+		QueuedEvent.Time = FPlatformTime::Seconds();
+	}
+
+	if (!Events.Enqueue(QueuedEvent))
+	{
+		FPlatformAtomics::InterlockedIncrement(&NumDroppedEvents);
+	}
+}
+
+
+void FVlcMediaPlayer::AttachMediaEvents(FLibvlcMediaPlayer* TargetPlayer)
+{
+	FLibvlcMedia* Media = FVlc::MediaPlayerGetMedia(TargetPlayer);
+
+	if (Media == nullptr)
+	{
+		return;
+	}
+
+	FLibvlcEventManager* MediaEventManager = FVlc::MediaEventManager(Media);
+
+	if (MediaEventManager != nullptr)
+	{
+		FVlc::EventAttach(MediaEventManager, ELibvlcEventType::MediaParsedChanged, &FVlcMediaPlayer::HandleEventCallback, this);
+	}
+
+	FVlc::MediaRelease(Media);
+}
+
+
+void FVlcMediaPlayer::DetachMediaEvents(FLibvlcMediaPlayer* TargetPlayer)
+{
+	FLibvlcMedia* Media = FVlc::MediaPlayerGetMedia(TargetPlayer);
+
+	if (Media == nullptr)
+	{
+		return;
+	}
+
+	FLibvlcEventManager* MediaEventManager = FVlc::MediaEventManager(Media);
+
+	if (MediaEventManager != nullptr)
+	{
+		FVlc::EventDetach(MediaEventManager, ELibvlcEventType::MediaParsedChanged, &FVlcMediaPlayer::HandleEventCallback, this);
+	}
+
+	FVlc::MediaRelease(Media);
+}
+
+
+void FVlcMediaPlayer::AddTrack(EMediaTrackTypes Type, int32 Id)
+{
+	if ((Player == nullptr) || (Id == -1) || (FindTrack(Type, Id) != INDEX_NONE))
+	{
+		return;
+	}
+
+	// only the description list of the stream's type is needed for the track name
+	FLibvlcTrackDescription* Descriptions = nullptr;
+
+	switch (Type)
+	{
+	case EMediaTrackTypes::Audio:
+		Descriptions = FVlc::AudioGetTrackDescription(Player);
+		break;
+
+	case EMediaTrackTypes::Caption:
+		Descriptions = FVlc::VideoGetSpuDescription(Player);
+		break;
+
+	case EMediaTrackTypes::Video:
+		Descriptions = FVlc::VideoGetTrackDescription(Player);
+		break;
+
+	default:
+		return;
+	}
+
+	ANSICHAR EmptyName[] = "";
+
+	FLibvlcTrackDescription Descr;
+	{
+		Descr.Id = Id;
+		Descr.Name = EmptyName;
+		Descr.Next = nullptr;
+	}
+
+	for (FLibvlcTrackDescription* Description = Descriptions; Description != nullptr; Description = Description->Next)
+	{
+		if ((Description->Id == Id) && (Description->Name != nullptr))
+		{
+			Descr.Name = Description->Name;
+			break;
+		}
+	}
+
+	TSharedPtr<FVlcMediaTrack, ESPMode::ThreadSafe> Track;
+
+	if (Type == EMediaTrackTypes::Audio)
+	{
+		Track = MakeShareable(new FVlcMediaAudioTrack(Player, Clock, State, Tracks.Num(), &Descr));
+	}
+	else if (Type == EMediaTrackTypes::Caption)
+	{
+		Track = MakeShareable(new FVlcMediaCaptionTrack(Player, Clock, State, Tracks.Num(), &Descr));
+	}
+	else
+	{
+		Track = MakeShareable(new FVlcMediaVideoTrack(Player, Clock, State, Tracks.Num(), &Descr));
+	}
+
+	if (Descriptions != nullptr)
+	{
+		FVlc::TrackDescriptionListRelease(Descriptions);
+	}
+
+	Tracks.Add(Track.ToSharedRef());
+
+	// the stream's output may have started before the track installed its callbacks
+	if ((Type != EMediaTrackTypes::Caption) && Track->IsEnabled())
+	{
+		Track->Disable();
+		Track->Enable();
+	}
+}
+
+
+int32 FVlcMediaPlayer::FindTrack(EMediaTrackTypes Type, int32 Id) const
+{
+	for (int32 TrackIndex = 0; TrackIndex < Tracks.Num(); ++TrackIndex)
+	{
+		const IMediaTrackRef& Track = Tracks[TrackIndex];
+
+		if ((Track->GetType() == Type) && (static_cast<FVlcMediaTrack&>(*Track).GetTrackId() == Id))
+		{
+			return TrackIndex;
+		}
+	}
+
+	return INDEX_NONE;
+}
+
+
+void FVlcMediaPlayer::RemoveTrack(EMediaTrackTypes Type, int32 Id)
+{
+	const int32 TrackIndex = FindTrack(Type, Id);
+
+	if (TrackIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	const bool HasOutput = ((Type == EMediaTrackTypes::Audio) || (Type == EMediaTrackTypes::Video));
+	const bool BoundToPlayer = (static_cast<FVlcMediaTrack&>(*Tracks[TrackIndex]).GetPlayer() == Player);
+
+	// outputs that libvlc already created keep calling into the track until the player is stopped
+	if (HasOutput && BoundToPlayer)
+	{
+		RetiredTracks.Add(Tracks[TrackIndex]);
+	}
+
+	Tracks.RemoveAt(TrackIndex);
+
+	// track indices must match the positions in the track list
+	for (int32 Index = TrackIndex; Index < Tracks.Num(); ++Index)
+	{
+		static_cast<FVlcMediaTrack&>(*Tracks[Index]).SetIndex(Index);
+	}
+
+	if (!HasOutput || !BoundToPlayer || (Player == nullptr))
+	{
+		return;
+	}
+
+	// outputs that libvlc creates from now on must not pick up the removed track
+	for (const IMediaTrackRef& Track : Tracks)
+	{
+		if (Track->GetType() == Type)
+		{
+			static_cast<FVlcMediaTrack&>(*Track).BindOutput();
+
+			return;
+		}
+	}
+
+	if (Type == EMediaTrackTypes::Audio)
+	{
+		SetDiscardAudioOutput(Player);
+	}
+	else
+	{
+		SetDiscardVideoOutput(Player);
+	}
+}
+
+
+void FVlcMediaPlayer::SyncTracks()
+{
+	if (Player == nullptr)
+	{
+		return;
+	}
+
+	FLibvlcMedia* Media = FVlc::MediaPlayerGetMedia(Player);
+
+	if (Media == nullptr)
+	{
+		return;
+	}
+
+	FLibvlcMediaTrack** MediaTracks = nullptr;
+	const uint32 NumMediaTracks = FVlc::MediaTracksGet(Media, &MediaTracks);
+
+	for (uint32 MediaTrackIndex = 0; MediaTrackIndex < NumMediaTracks; ++MediaTrackIndex)
+	{
+		EMediaTrackTypes TrackType;
+
+		if (VlcMediaPlayer::ConvertTrackType(MediaTracks[MediaTrackIndex]->Type, TrackType))
+		{
+			AddTrack(TrackType, MediaTracks[MediaTrackIndex]->Id);
+		}
+	}
+
+	if (MediaTracks != nullptr)
+	{
+		FVlc::MediaTracksRelease(MediaTracks, NumMediaTracks);
+	}
+
+	FVlc::MediaRelease(Media);
+}
+
+
+void FVlcMediaPlayer::TickEvents()
+{
+	if ((PendingTeardowns->GetValue() == 0) && (Status == (int32)EVlcMediaPlayerStatus::Closing))
+	{
+		SetStatus(EVlcMediaPlayerStatus::Closed);
+	}
+
+	if ((OpenStats.TimeToFirstFrame < 0.0) && (Tracks.Num() > 0))
+	{
+		UpdateOpenStats();
+	}
+
+	// decoder threads skip the sinks that were destroyed, but leave their removal to the game thread
+	for (const IMediaTrackRef& Track : Tracks)
+	{
+		static_cast<FVlcMediaTrack&>(*Track).RemoveExpiredDispatchers();
+	}
+
+	const int32 NumDropped = FPlatformAtomics::InterlockedExchange(&NumDroppedEvents, 0);
+
+	if (NumDropped > 0)
+	{
+		UE_LOG(LogVlcMedia, Warning, TEXT("Dropped %i player events, because the event queue was full."), NumDropped);
+	}
+
+	// collect the events of this tick, keeping only the latest of each coalescable type
+	int32 CoalescedIndices[(int32)EVlcMediaPlayerEventType::TrackSelected + 1];
+	FMemory::Memset(CoalescedIndices, 0xff, sizeof(CoalescedIndices));
+
+	FQueuedEvent QueuedEvent;
+	EventBatch.Reset();
+
+	while (Events.Dequeue(QueuedEvent))
+	{
+		// events of a libvlc player that was detached in the meantime
+		if (QueuedEvent.Generation != EventGeneration)
+		{
+			continue;
+		}
+
+		const FVlcMediaPlayerEvent& Event = QueuedEvent.Event;
+
+		// wraps are detected before the reported times are coalesced
+		if ((Event.Type == EVlcMediaPlayerEventType::TimeChanged) && DetectLoop(Event.Time / ETimespan::TicksPerMillisecond, QueuedEvent.Time))
+		{
+			FVlcMediaPlayerEvent& LoopedEvent = EventBatch[EventBatch.AddZeroed()];
+			LoopedEvent.Type = EVlcMediaPlayerEventType::Looped;
+		}
+
+		if (VlcMediaPlayer::IsCoalescable(Event.Type))
+		{
+			int32& CoalescedIndex = CoalescedIndices[(int32)Event.Type];
+
+			if (CoalescedIndex != INDEX_NONE)
+			{
+				EventBatch[CoalescedIndex] = Event;
+				continue;
+			}
+
+			CoalescedIndex = EventBatch.Num();
+		}
+
+		EventBatch.Add(Event);
+	}
+
+	for (const FVlcMediaPlayerEvent& BatchedEvent : EventBatch)
+	{
+		switch (BatchedEvent.Type)
+		{
+		case EVlcMediaPlayerEventType::EndReached:
+			if (NextPlayer != nullptr)
+			{
+				HandoffPending = true;
+				break;
+			}
+
+			// looping was enabled after opening, or libvlc ran out of repeats
+			FVlc::MediaPlayerStop(Player);
+			Clock->Reset(FTimespan::Zero());
+			Repeating = false;
+
+			if (ShouldLoop && (DesiredRate != 0.0f))
+			{
+				SetRate(DesiredRate);
+			}
+			break;
+
+		case EVlcMediaPlayerEventType::Looped:
+			// libvlc keeps repeating after looping was disabled
+			if (!ShouldLoop && (NextPlayer != nullptr))
+			{
+				HandoffPending = true;
+			}
+			else if (!ShouldLoop)
+			{
+				FVlc::MediaPlayerStop(Player);
+				Clock->Reset(FTimespan::Zero());
+				Repeating = false;
+			}
+			break;
+
+		case EVlcMediaPlayerEventType::Parsed:
+			SyncTracks();
+			break;
+
+		case EVlcMediaPlayerEventType::Playing:
+			if (Tracks.Num() == 0)
+			{
+				SyncTracks();
+			}
+			break;
+
+		case EVlcMediaPlayerEventType::TrackAdded:
+		case EVlcMediaPlayerEventType::TrackSelected:
+			AddTrack(BatchedEvent.Track.Type, BatchedEvent.Track.Id);
+			break;
+
+		case EVlcMediaPlayerEventType::TrackRemoved:
+			// streams also go away when playback stops, but their tracks (and sinks) stay for the next run
+			if (State->GetSnapshot().State < ELibvlcState::Stopped)
+			{
+				RemoveTrack(BatchedEvent.Track.Type, BatchedEvent.Track.Id);
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	// the queued media may still be buffering when the current media ends
+	if (HandoffPending)
+	{
+		AdvanceQueue();
+	}
+
+	// closed players are updated until their libvlc players stopped
+	if ((Player == nullptr) && (PendingTeardowns->GetValue() == 0))
+	{
+		Scheduler->Deactivate(*this);
+	}
+
+	if (EventBatch.Num() == 0)
+	{
+		return;
+	}
+
+	// listeners may close or even destroy the player, so the batch is moved out and nothing touches the player afterwards
+	const TArray<FVlcMediaPlayerEvent> BroadcastBatch = MoveTemp(EventBatch);
+	PlayerEventsEvent.Broadcast(BroadcastBatch);
+}
+
+
+bool FVlcMediaPlayer::DetectLoop(int64 NewTime, double ReportTime)
+{
+	double Latency = 0.0;
+
+	if (!LoopDetector.Detect(NewTime, State->GetSnapshot().Length, ReportTime, Latency))
+	{
+		return false;
+	}
+
+	FScopeLock Lock(&LoopStatsCriticalSection);
+
+	++LoopStats.NumLoops;
+	LoopStats.LastTransitionLatency = Latency;
+	LoopStats.MaxTransitionLatency = FMath::Max(LoopStats.MaxTransitionLatency, Latency);
+
+	UE_LOG(LogVlcMedia, Verbose, TEXT("Loop transition %u took %.1f ms"), LoopStats.NumLoops, Latency * 1000.0);
+
+	return true;
+}
+
+
+void FVlcMediaPlayer::UpdateOpenStats()
+{
+	for (const IMediaTrackRef& Track : Tracks)
+	{
+		if (Track->GetType() != EMediaTrackTypes::Video)
+		{
+			continue;
+		}
+
+		const double FirstSampleTime = static_cast<FVlcMediaTrack&>(*Track).GetFirstSampleTime();
+
+		if (FirstSampleTime > 0.0)
+		{
+			OpenStats.TimeToFirstFrame = FirstSampleTime - OpenTime;
+
+			UE_LOG(LogVlcMedia, Verbose, TEXT("First frame of %s after %.1f ms (opened in %.1f ms, pooled player: %s)"),
+				*MediaUrl,
+				OpenStats.TimeToFirstFrame * 1000.0,
+				OpenStats.OpenDuration * 1000.0,
+				OpenStats.UsedPooledPlayer ? TEXT("yes") : TEXT("no"));
+
+			return;
+		}
+	}
+}
+
+
+void FVlcMediaPlayer::TickTracks()
+{
+	const FTimespan Time = Clock->GetTime();
+
+	for (const IMediaTrackRef& Track : Tracks)
+	{
+		static_cast<FVlcMediaTrack&>(*Track).Tick(Time);
+	}
+}
+
+
+/* FVlcMediaPlayer static functions
+ *****************************************************************************/
+
+void FVlcMediaPlayer::HandleEventCallback(FLibvlcEvent* Event, void* UserData)
+{
+	FVlcMediaPlayer* MediaPlayer = (FVlcMediaPlayer*)UserData;
+
+	// the state and clock are updated right away, so that they don't lag behind by a game tick
+	MediaPlayer->State->HandleEvent(*Event);
+
+	switch (Event->Type)
+	{
+	case ELibvlcEventType::MediaPlayerEndReached:
+	case ELibvlcEventType::MediaPlayerPaused:
+	case ELibvlcEventType::MediaPlayerStopped:
+		MediaPlayer->Clock->SetRunning(false);
+		break;
+
+	case ELibvlcEventType::MediaPlayerPlaying:
+		MediaPlayer->Clock->SetRunning(true);
+		break;
+
+	case ELibvlcEventType::MediaPlayerTimeChanged:
+		MediaPlayer->Clock->Update(FTimespan::FromMilliseconds(Event->Descriptor.MediaPlayerTimeChanged.NewTime));
+		break;
+
+	default:
+		break;
+	}
+
+	// everything else happens on the game thread
+	FVlcMediaPlayerEvent PlayerEvent;
+	FMemory::Memzero(PlayerEvent);
+
+	if (VlcMediaPlayer::ConvertEvent(*Event, PlayerEvent))
+	{
+		MediaPlayer->QueueEvent(PlayerEvent);
+	}
+
+	switch (Event->Type)
+	{
+	case ELibvlcEventType::MediaPlayerBuffering:
+		MediaPlayer->SetStatus((Event->Descriptor.MediaPlayerBuffering.NewCache < 100.0f) ? EVlcMediaPlayerStatus::Buffering : EVlcMediaPlayerStatus::Ready);
+		break;
+
+	case ELibvlcEventType::MediaPlayerEncounteredError:
+		MediaPlayer->SetStatus(EVlcMediaPlayerStatus::Error);
+		break;
+
+	case ELibvlcEventType::MediaPlayerOpening:
+		MediaPlayer->SetStatus(EVlcMediaPlayerStatus::Opening);
+		break;
+
+	case ELibvlcEventType::MediaPlayerPaused:
+	case ELibvlcEventType::MediaPlayerPlaying:
+		MediaPlayer->SetStatus(EVlcMediaPlayerStatus::Ready);
+		break;
+
+	default:
+		break;
+	}
+}
+
+
+void FVlcMediaPlayer::HandleNextEventCallback(FLibvlcEvent* Event, void* UserData)
+{
+	FVlcMediaPlayer* MediaPlayer = (FVlcMediaPlayer*)UserData;
+
+	switch (Event->Type)
+	{
+	case ELibvlcEventType::MediaPlayerEncounteredError:
+		FPlatformAtomics::InterlockedExchange(&MediaPlayer->NextState, (int32)ELibvlcState::Error);
+		break;
+
+	case ELibvlcEventType::MediaPlayerPaused:
+		FPlatformAtomics::InterlockedExchange(&MediaPlayer->NextState, (int32)ELibvlcState::Paused);
+		break;
+
+	case ELibvlcEventType::MediaPlayerPlaying:
+		FPlatformAtomics::InterlockedExchange(&MediaPlayer->NextState, (int32)ELibvlcState::Playing);
+		break;
+
+	default:
+		break;
+	}
+}
+
+
+void FVlcMediaPlayer::HandleDiscardAudioPlay(void* /*Opaque*/, const void* /*Samples*/, uint32 /*Count*/, int64 /*Pts*/)
+{
+	// the preloading player's audio is not needed
+}
+
+
+uint32 FVlcMediaPlayer::HandleDiscardVideoSetup(void** Opaque, ANSICHAR* Chroma, uint32* Width, uint32* Height, uint32* Pitches, uint32* Lines)
+{
+	FMemory::Memcpy(Chroma, "RV32", 4);
+	Pitches[0] = *Width * 4;
+	Lines[0] = *Height;
+
+	// the scratch buffer becomes the opaque pointer of the other callbacks
+	*Opaque = FMemory::Malloc(Pitches[0] * Lines[0]);
+
+	return 1;
+}
+
+
+void FVlcMediaPlayer::HandleDiscardVideoCleanup(void* Opaque)
+{
+	FMemory::Free(Opaque);
 }
 
 
-void FVlcMediaPlayer::HandleMediaClose(void* Opaque)
+void* FVlcMediaPlayer::HandleDiscardVideoLock(void* Opaque, void** Planes)
 {
-	FVlcMediaPlayer* MediaPlayer = (FVlcMediaPlayer*)Opaque;
+	Planes[0] = Opaque;
 
-	MediaPlayer->Data.Reset();
-	MediaPlayer->DataPosition = 0;
+	return nullptr;
 }
 
 
@@ -11,6 +11,7 @@
 class FVlcMediaPlayer
 	: public IMediaInfo
 	, public IMediaPlayer
+	, public IVlcMediaPlayer
 {
 public:
 
@@ -18,8 +19,10 @@ public:
 	 * Create and initialize a new instance.
 	 *
 	 * @param InInstance The LibVLC instance to use. 
+	 * @param InScheduler The scheduler that updates the player.
+	 * @param InPlayerPool The pool of pre-created libvlc players.
 	 */
-	FVlcMediaPlayer(FLibvlcInstance* InInstance);
+	FVlcMediaPlayer(FLibvlcInstance* InInstance, const FVlcMediaSchedulerRef& InScheduler, const FVlcMediaPlayerPoolRef& InPlayerPool);
 
 	/** Destructor. */
 	~FVlcMediaPlayer();
@@ -66,8 +69,86 @@ public:
 		return OpenedEvent;
 	}
 
+public:
+
+	// IVlcMediaPlayer interface
+
+	virtual IVlcMediaAudioTrack* GetAudioTrack(uint32 TrackIndex) override;
+	virtual FVlcMediaLoopStats GetLoopStats() const override;
+	virtual FVlcMediaOpenStats GetOpenStats() const override;
+	virtual FVlcMediaPrefetchStats GetPrefetchStats() const override;
+	virtual EVlcMediaPlayerStatus GetStatus() const override;
+	virtual IVlcMediaVideoTrack* GetVideoTrack(uint32 TrackIndex) override;
+	virtual void ClearQueue() override;
+	virtual bool OpenStream(const IVlcMediaStreamRef& InStream, const FString& OriginalUrl) override;
+	virtual bool QueueNext(const FString& Url) override;
+	virtual bool QueueNext(const TSharedRef<TArray<uint8>, ESPMode::ThreadSafe>& Buffer, const FString& OriginalUrl) override;
+	virtual void SetPrefetchOptions(const FVlcMediaPrefetchOptions& Options) override;
+
+	DECLARE_DERIVED_EVENT(FVlcMediaPlayer, IVlcMediaPlayer::FOnPlayerEvents, FOnPlayerEvents);
+	virtual FOnPlayerEvents& OnPlayerEvents() override
+	{
+		return PlayerEventsEvent;
+	}
+
+public:
+
+	/**
+	 * Get the player's position in the scheduler's list of active players.
+	 *
+	 * @return Index, or INDEX_NONE if the player is not active.
+	 * @see SetSchedulerIndex
+	 */
+	int32 GetSchedulerIndex() const
+	{
+		return SchedulerIndex;
+	}
+
+	/**
+	 * Check whether the player's tracks need to be updated in this tick.
+	 *
+	 * @return true if the tracks need to be updated, false otherwise.
+	 * @see TickTracks
+	 */
+	bool HasTracksToTick() const
+	{
+		return ((Tracks.Num() > 0) && (State->GetSnapshot().State == ELibvlcState::Playing));
+	}
+
+	/**
+	 * Set the player's position in the scheduler's list of active players.
+	 *
+	 * @param Index The index to set, or INDEX_NONE if the player is not active.
+	 * @see GetSchedulerIndex
+	 */
+	void SetSchedulerIndex(int32 Index)
+	{
+		SchedulerIndex = Index;
+	}
+
+	/** Process the player events that arrived since the last tick (called by the scheduler on the game thread). */
+	void TickEvents();
+
+	/** Let the tracks release the samples that are due (called by the scheduler on any thread). */
+	void TickTracks();
+
 protected:
 
+	/**
+	 * Create a libvlc media for a URL or local file path.
+	 *
+	 * Files on disk are opened by libvlc itself, unless read-ahead options were set, in which case
+	 * they are mapped into memory and read through the read-ahead cache if it is enabled. Files that
+	 * are not on disk, such as the ones in pak files, are read through the engine's file system and
+	 * the cache.
+	 *
+	 * @param Url The URL or file path of the media.
+	 * @param OutSource Will contain the I/O context if the media is read through callbacks.
+	 * @return The media, or nullptr on failure.
+	 * @see SetPrefetchOptions
+	 */
+	FLibvlcMedia* CreateMediaForUrl(const FString& Url, FVlcMediaSourcePtr& OutSource) const;
+
 	/**
 	 * Initialize the media player object.
 	 *
@@ -76,59 +157,256 @@ protected:
 	 */
 	bool InitializeMediaPlayer(FLibvlcMedia* Media);
 
-	/** Initialize the media tracks. */
-	void InitializeTracks();
+	/**
+	 * Open media on the preloading player and hold it at its start.
+	 *
+	 * @param Media The media to play next.
+	 * @return true on success, false otherwise.
+	 * @see AdvanceQueue
+	 */
+	bool InitializeNextPlayer(FLibvlcMedia* Media);
 
-private:
+	/**
+	 * Switch to the preloaded media once it is ready (called after the current media ended).
+	 *
+	 * @see InitializeNextPlayer
+	 */
+	void AdvanceQueue();
+
+	/**
+	 * Make a player decode into scratch buffers instead of opening its own outputs.
+	 *
+	 * The tracks replace the scratch callbacks when they are rebound to the player, and
+	 * the pool removes them when the player is stopped.
+	 *
+	 * @param TargetPlayer The player to change.
+	 * @see SetDiscardAudioOutput, SetDiscardVideoOutput
+	 */
+	static void SetDiscardOutput(FLibvlcMediaPlayer* TargetPlayer);
 
-	/** Handles the ticker. */
-	bool HandleTicker(float DeltaTime);
+	/**
+	 * Make a player decode audio into a scratch callback.
+	 *
+	 * @param TargetPlayer The player to change.
+	 * @see SetDiscardOutput
+	 */
+	static void SetDiscardAudioOutput(FLibvlcMediaPlayer* TargetPlayer);
+
+	/**
+	 * Make a player decode video into a scratch buffer.
+	 *
+	 * @param TargetPlayer The player to change.
+	 * @see SetDiscardOutput
+	 */
+	static void SetDiscardVideoOutput(FLibvlcMediaPlayer* TargetPlayer);
+
+	/**
+	 * Queue an event for the next tick, tagged with the current event generation (called on any thread).
+	 *
+	 * @param Event The event to queue.
+	 */
+	void QueueEvent(const FVlcMediaPlayerEvent& Event);
+
+	/**
+	 * Forward the events of a player's media to this player.
+	 *
+	 * @param TargetPlayer The player whose media to attach to.
+	 * @see DetachMediaEvents
+	 */
+	void AttachMediaEvents(FLibvlcMediaPlayer* TargetPlayer);
+
+	/**
+	 * Stop forwarding the events of a player's media to this player.
+	 *
+	 * @param TargetPlayer The player whose media to detach from.
+	 * @see AttachMediaEvents
+	 */
+	void DetachMediaEvents(FLibvlcMediaPlayer* TargetPlayer);
+
+	/**
+	 * Change the lifecycle status and queue a StatusChanged event (called on any thread).
+	 *
+	 * @param NewStatus The status to set.
+	 */
+	void SetStatus(EVlcMediaPlayerStatus NewStatus);
+
+	/**
+	 * Check whether a reported time means that looping playback wrapped around, and update the loop statistics.
+	 *
+	 * @param NewTime The reported playback time (in milliseconds).
+	 * @param ReportTime The platform time at which the playback time was reported (in seconds).
+	 * @return true if playback wrapped around, false otherwise.
+	 */
+	bool DetectLoop(int64 NewTime, double ReportTime);
+
+	/** Check whether the first video frame was delivered since the media was opened. */
+	void UpdateOpenStats();
+
+protected:
+
+	/**
+	 * Add a track for an elementary stream, unless it already exists.
+	 *
+	 * @param Type The type of the elementary stream.
+	 * @param Id The identifier of the elementary stream.
+	 * @see FindTrack, RemoveTrack
+	 */
+	void AddTrack(EMediaTrackTypes Type, int32 Id);
+
+	/**
+	 * Find the track of an elementary stream.
+	 *
+	 * @param Type The type of the elementary stream.
+	 * @param Id The identifier of the elementary stream.
+	 * @return Index of the track, or INDEX_NONE if not found.
+	 * @see AddTrack, RemoveTrack
+	 */
+	int32 FindTrack(EMediaTrackTypes Type, int32 Id) const;
+
+	/**
+	 * Remove the track of an elementary stream.
+	 *
+	 * @param Type The type of the elementary stream.
+	 * @param Id The identifier of the elementary stream.
+	 * @see AddTrack, FindTrack
+	 */
+	void RemoveTrack(EMediaTrackTypes Type, int32 Id);
+
+	/** Add tracks for all elementary streams that the media reports. */
+	void SyncTracks();
 
 private:
 
 	/** Handles event callbacks. */
 	static void HandleEventCallback(FLibvlcEvent* Event, void* UserData);
 
-	/** Handles open callbacks from VLC. */
-	static int HandleMediaOpen(void* Opaque, void** OutData, uint64* OutSize);
+	/** Handles event callbacks from the preloading player. */
+	static void HandleNextEventCallback(FLibvlcEvent* Event, void* UserData);
+
+	/** Handles audio play callbacks from the preloading player. */
+	static void HandleDiscardAudioPlay(void* Opaque, const void* Samples, uint32 Count, int64 Pts);
 
-	/** Handles read callbacks from VLC. */
-	static SSIZE_T HandleMediaRead(void* Opaque, void* Buffer, SIZE_T Length);
+	/** Handles video format setup callbacks from the preloading player. */
+	static uint32 HandleDiscardVideoSetup(void** Opaque, ANSICHAR* Chroma, uint32* Width, uint32* Height, uint32* Pitches, uint32* Lines);
 
-	/** Handles seek callbacks from VLC. */
-	static int HandleMediaSeek(void* Opaque, uint64 Offset);
+	/** Handles video format cleanup callbacks from the preloading player. */
+	static void HandleDiscardVideoCleanup(void* Opaque);
 
-	/** Handles close callbacks from VLC. */
-	static void HandleMediaClose(void* Opaque);
+	/** Handles video lock callbacks from the preloading player. */
+	static void* HandleDiscardVideoLock(void* Opaque, void** Planes);
 
 private:
 
-	/** Current playback time to work around VLC's broken time tracking. */
-	float CurrentTime;
+	/** A queued player event. */
+	struct FQueuedEvent
+	{
+		/** The event. */
+		FVlcMediaPlayerEvent Event;
 
-	/** Buffer holding media data (for in-memory playback only). */
-	TSharedPtr<TArray<uint8>, ESPMode::ThreadSafe> Data;
+		/** The event generation at the time the event was queued. */
+		int32 Generation;
 
-	/** The current read position in the media data (for in-memory playback only). */
-	SIZE_T DataPosition;
+		/** The platform time at which the event was queued (in seconds). */
+		double Time;
+	};
+
+private:
+
+	/** High resolution playback clock. */
+	FVlcMediaPlayerClockRef Clock;
 
 	/** The desired playback rate. */
 	float DesiredRate;
 
+	/** Events of the current tick until they are broadcast (only accessed on the game thread). */
+	TArray<FVlcMediaPlayerEvent> EventBatch;
+
+	/** Incremented whenever a libvlc player is detached, so that the events it queued before can be dropped. */
+	volatile int32 EventGeneration;
+
 	/** Collection of received player events. */
-	TQueue<ELibvlcEventType, EQueueMode::Mpsc> Events;
+	TVlcMediaBoundedQueue<FQueuedEvent> Events;
+
+	/** Whether the current media ended and playback switches to the queued media once it is ready. */
+	bool HandoffPending;
+
+	/** Detects when looping playback wraps around (only accessed on the game thread). */
+	FVlcMediaLoopDetector LoopDetector;
+
+	/** Critical section for synchronizing access to the loop statistics. */
+	mutable FCriticalSection LoopStatsCriticalSection;
+
+	/** Statistics of looping playback. */
+	FVlcMediaLoopStats LoopStats;
 
 	// Currently opened media.
 	FString MediaUrl;
 
+	/** The player that preloads the queued media. */
+	FLibvlcMediaPlayer* NextPlayer;
+
+	/** Whether the preloading player was taken from the pool. */
+	bool NextPooled;
+
+	/** Whether libvlc repeats the queued media by itself. */
+	bool NextRepeating;
+
+	/** The I/O context of the queued media (for media that is read through callbacks only). */
+	FVlcMediaSourcePtr NextSource;
+
+	/** The state of the preloading player (as ELibvlcState). */
+	volatile int32 NextState;
+
+	/** The URL of the queued media. */
+	FString NextUrl;
+
+	/** Number of events that were dropped because the queue was full. */
+	volatile int32 NumDroppedEvents;
+
+	/** Statistics of opening the current media. */
+	FVlcMediaOpenStats OpenStats;
+
+	/** The platform time at which the current media was opened (in seconds). */
+	double OpenTime;
+
+	/** Number of libvlc players of this player that are still being stopped. */
+	FVlcMediaTeardownCounterRef PendingTeardowns;
+
 	/** The VLC media player object. */
 	FLibvlcMediaPlayer* Player;
 
+	/** The pool of pre-created libvlc players. */
+	FVlcMediaPlayerPoolRef PlayerPool;
+
+	/** Options for the read-ahead cache of media opened from now on. */
+	FVlcMediaPrefetchOptions PrefetchOptions;
+
+	/** Whether read-ahead options were set, so that files on disk are read through callbacks. */
+	bool PrefetchRequested;
+
+	/** Whether libvlc repeats the current media by itself. */
+	bool Repeating;
+
+	/** Removed tracks that the current libvlc player's outputs may still call into until it is stopped. */
+	TArray<IMediaTrackRef> RetiredTracks;
+
+	/** The player's position in the scheduler's list of active players. */
+	int32 SchedulerIndex;
+
+	/** The scheduler that updates the player. */
+	FVlcMediaSchedulerRef Scheduler;
+
 	/** Whether playback should be looping. */
 	bool ShouldLoop;
 
-	/** Handle to the registered ticker. */
-	FDelegateHandle TickerHandle;
+	/** The I/O context of the current media (for media that is read through callbacks only). */
+	FVlcMediaSourcePtr Source;
+
+	/** Cached player state, which is updated from libvlc events. */
+	FVlcMediaPlayerStateRef State;
+
+	/** The player's lifecycle status (as EVlcMediaPlayerStatus). */
+	volatile int32 Status;
 
 	/** The pseudo-tracks in the media. */
 	TArray<IMediaTrackRef> Tracks;
@@ -143,4 +421,7 @@ private:
 
 	/** Holds an event delegate that is invoked when media has been opened. */
 	FOnMediaOpened OpenedEvent;
+
+	/** Holds an event delegate that is invoked with the player events of each tick. */
+	FOnPlayerEvents PlayerEventsEvent;
 };
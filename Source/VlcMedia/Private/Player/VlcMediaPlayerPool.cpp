@@ -0,0 +1,453 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+
+
+/** Maximum number of players that can be stopped in the background at the same time. */
+#define VLCMEDIA_MAX_PENDING_STOPS 64
+
+
+namespace VlcMediaPlayerPool
+{
+	/** The player events that pooled players forward. */
+	const ELibvlcEventType Events[] =
+	{
+		ELibvlcEventType::MediaPlayerBuffering,
+		ELibvlcEventType::MediaPlayerEncounteredError,
+		ELibvlcEventType::MediaPlayerEndReached,
+		ELibvlcEventType::MediaPlayerESAdded,
+		ELibvlcEventType::MediaPlayerESDeleted,
+		ELibvlcEventType::MediaPlayerESSelected,
+		ELibvlcEventType::MediaPlayerLengthChanged,
+		ELibvlcEventType::MediaPlayerNothingSpecial,
+		ELibvlcEventType::MediaPlayerOpening,
+		ELibvlcEventType::MediaPlayerPaused,
+		ELibvlcEventType::MediaPlayerPlaying,
+		ELibvlcEventType::MediaPlayerPositionChanged,
+		ELibvlcEventType::MediaPlayerSeekableChanged,
+		ELibvlcEventType::MediaPlayerStopped,
+		ELibvlcEventType::MediaPlayerTimeChanged,
+	};
+}
+
+
+/* FVlcMediaPlayerPool structors
+ *****************************************************************************/
+
+FVlcMediaPlayerPool::FVlcMediaPlayerPool(FLibvlcInstance* InVlcInstance, int32 InCapacity)
+	: Capacity(InCapacity)
+	, CreatedEntries(VLCMEDIA_MAX_PENDING_STOPS)
+	, NumCreating(0)
+	, NumStopping(0)
+	, NumToCreate(0)
+	, PendingStops(VLCMEDIA_MAX_PENDING_STOPS)
+	, StoppedEntries(VLCMEDIA_MAX_PENDING_STOPS)
+	, Stopping(false)
+	, Thread(nullptr)
+	, VlcInstance(InVlcInstance)
+	, WorkEvent(FPlatformProcess::GetSynchEventFromPool(false))
+{
+	for (int32 Index = 0; Index < Capacity; ++Index)
+	{
+		FEntry* Entry = CreateEntry();
+
+		if (Entry == nullptr)
+		{
+			break;
+		}
+
+		Entries.Add(Entry);
+	}
+
+	Thread = FRunnableThread::Create(this, TEXT("VlcMediaPlayerPool"), 0, TPri_BelowNormal);
+}
+
+
+FVlcMediaPlayerPool::~FVlcMediaPlayerPool()
+{
+	Shutdown();
+	FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+}
+
+
+/* FVlcMediaPlayerPool interface
+ *****************************************************************************/
+
+FLibvlcMediaPlayer* FVlcMediaPlayerPool::Acquire(FLibvlcCallback Callback, void* UserData, bool& OutPooled)
+{
+	CollectEntries();
+
+	FEntry* Entry = nullptr;
+
+	for (FEntry* Candidate : Entries)
+	{
+		if (!Candidate->InUse)
+		{
+			Entry = Candidate;
+			break;
+		}
+	}
+
+	OutPooled = (Entry != nullptr);
+
+	if (Entry == nullptr)
+	{
+		Entry = CreateEntry();
+
+		if (Entry == nullptr)
+		{
+			return nullptr;
+		}
+
+		Entries.Add(Entry);
+	}
+
+	FScopeLock Lock(&Entry->CriticalSection);
+
+	Entry->Callback = Callback;
+	Entry->InUse = true;
+	Entry->UserData = UserData;
+
+	Refill();
+
+	return Entry->Player;
+}
+
+
+void FVlcMediaPlayerPool::CollectEntries()
+{
+	FEntry* Entry = nullptr;
+
+	while (CreatedEntries.Dequeue(Entry))
+	{
+		--NumCreating;
+
+		if (Entry != nullptr)
+		{
+			Entries.Add(Entry);
+		}
+	}
+
+	while (StoppedEntries.Dequeue(Entry))
+	{
+		--NumStopping;
+
+		// the tracks are destroyed on the game thread, now that the player no longer calls into them
+		Entry->KeepAlive.Reset();
+		Entry->PendingTeardowns->Decrement();
+		Entry->PendingTeardowns.Reset();
+		Entry->InUse = false;
+
+		Trim(Entries.Find(Entry));
+	}
+}
+
+
+int32 FVlcMediaPlayerPool::GetNumAvailable() const
+{
+	int32 NumAvailable = 0;
+
+	for (const FEntry* Entry : Entries)
+	{
+		if (!Entry->InUse)
+		{
+			++NumAvailable;
+		}
+	}
+
+	return NumAvailable;
+}
+
+
+void FVlcMediaPlayerPool::Release(FLibvlcMediaPlayer* Player)
+{
+	const int32 EntryIndex = FindEntry(Player);
+
+	if (EntryIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	FEntry* Entry = Entries[EntryIndex];
+
+	// the owner still receives the events that are sent while stopping
+	ResetPlayer(Player);
+	{
+		FScopeLock Lock(&Entry->CriticalSection);
+
+		Entry->Callback = nullptr;
+		Entry->InUse = false;
+		Entry->UserData = nullptr;
+	}
+
+	Trim(EntryIndex);
+}
+
+
+void FVlcMediaPlayerPool::ReleaseDeferred(FLibvlcMediaPlayer* Player, const TArray<IMediaTrackRef>& Tracks, const FVlcMediaTeardownCounterRef& PendingTeardowns)
+{
+	const int32 EntryIndex = FindEntry(Player);
+
+	if (EntryIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	SetCallback(Player, nullptr, nullptr);
+
+	if ((Thread == nullptr) || (NumStopping >= VLCMEDIA_MAX_PENDING_STOPS))
+	{
+		Release(Player);
+
+		return;
+	}
+
+	FEntry* Entry = Entries[EntryIndex];
+
+	Entry->KeepAlive = Tracks;
+	Entry->PendingTeardowns = PendingTeardowns;
+	PendingTeardowns->Increment();
+
+	++NumStopping;
+	verify(PendingStops.Enqueue(Entry));
+	WorkEvent->Trigger();
+}
+
+
+void FVlcMediaPlayerPool::SetCallback(FLibvlcMediaPlayer* Player, FLibvlcCallback Callback, void* UserData)
+{
+	const int32 EntryIndex = FindEntry(Player);
+
+	if (EntryIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	FEntry* Entry = Entries[EntryIndex];
+	FScopeLock Lock(&Entry->CriticalSection);
+
+	Entry->Callback = Callback;
+	Entry->UserData = UserData;
+}
+
+
+void FVlcMediaPlayerPool::Shutdown()
+{
+	if (Thread != nullptr)
+	{
+		Stop();
+		Thread->WaitForCompletion();
+
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	// players that the worker did not get to are stopped when their entries are destroyed
+	FEntry* Entry = nullptr;
+
+	while (PendingStops.Dequeue(Entry) || StoppedEntries.Dequeue(Entry))
+	{
+		Entry->PendingTeardowns->Decrement();
+		Entry->PendingTeardowns.Reset();
+	}
+
+	while (CreatedEntries.Dequeue(Entry))
+	{
+		if (Entry != nullptr)
+		{
+			Entries.Add(Entry);
+		}
+	}
+
+	for (FEntry* Candidate : Entries)
+	{
+		DestroyEntry(Candidate);
+	}
+
+	Entries.Empty();
+	NumCreating = 0;
+	NumStopping = 0;
+	NumToCreate = 0;
+	VlcInstance = nullptr;
+}
+
+
+/* FRunnable interface
+ *****************************************************************************/
+
+uint32 FVlcMediaPlayerPool::Run()
+{
+	while (!Stopping)
+	{
+		FEntry* Entry = nullptr;
+
+		if (PendingStops.Dequeue(Entry))
+		{
+			const double StartTime = FPlatformTime::Seconds();
+
+			ResetPlayer(Entry->Player);
+
+			UE_LOG(LogVlcMedia, Verbose, TEXT("Stopped player in %.1f ms"), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+			// the queue holds as many entries as can be stopping
+			verify(StoppedEntries.Enqueue(Entry));
+
+			continue;
+		}
+
+		if (NumToCreate > 0)
+		{
+			FPlatformAtomics::InterlockedDecrement(&NumToCreate);
+
+			// failures are handed over as well, so that the game thread stops counting on them
+			verify(CreatedEntries.Enqueue(CreateEntry()));
+
+			continue;
+		}
+
+		WorkEvent->Wait(100);
+	}
+
+	return 0;
+}
+
+
+void FVlcMediaPlayerPool::Stop()
+{
+	Stopping = true;
+	WorkEvent->Trigger();
+}
+
+
+/* FVlcMediaPlayerPool implementation
+ *****************************************************************************/
+
+FVlcMediaPlayerPool::FEntry* FVlcMediaPlayerPool::CreateEntry()
+{
+	// the pool was shut down
+	if (VlcInstance == nullptr)
+	{
+		return nullptr;
+	}
+
+	FLibvlcMediaPlayer* Player = FVlc::MediaPlayerNew(VlcInstance);
+
+	if (Player == nullptr)
+	{
+		return nullptr;
+	}
+
+	FLibvlcEventManager* EventManager = FVlc::MediaPlayerEventManager(Player);
+
+	if (EventManager == nullptr)
+	{
+		FVlc::MediaPlayerRelease(Player);
+
+		return nullptr;
+	}
+
+	FEntry* Entry = new FEntry;
+	{
+		Entry->Callback = nullptr;
+		Entry->InUse = false;
+		Entry->Player = Player;
+		Entry->UserData = nullptr;
+	}
+
+	for (ELibvlcEventType EventType : VlcMediaPlayerPool::Events)
+	{
+		FVlc::EventAttach(EventManager, EventType, &FVlcMediaPlayerPool::HandleEventCallback, Entry);
+	}
+
+	return Entry;
+}
+
+
+void FVlcMediaPlayerPool::DestroyEntry(FEntry* Entry)
+{
+	FLibvlcEventManager* EventManager = FVlc::MediaPlayerEventManager(Entry->Player);
+
+	for (ELibvlcEventType EventType : VlcMediaPlayerPool::Events)
+	{
+		FVlc::EventDetach(EventManager, EventType, &FVlcMediaPlayerPool::HandleEventCallback, Entry);
+	}
+
+	FVlc::MediaPlayerStop(Entry->Player);
+
+	// the stopped player no longer calls into the tracks
+	Entry->KeepAlive.Reset();
+	FVlc::MediaPlayerRelease(Entry->Player);
+
+	delete Entry;
+}
+
+
+int32 FVlcMediaPlayerPool::FindEntry(FLibvlcMediaPlayer* Player) const
+{
+	for (int32 EntryIndex = 0; EntryIndex < Entries.Num(); ++EntryIndex)
+	{
+		if (Entries[EntryIndex]->Player == Player)
+		{
+			return EntryIndex;
+		}
+	}
+
+	return INDEX_NONE;
+}
+
+
+void FVlcMediaPlayerPool::ResetPlayer(FLibvlcMediaPlayer* Player)
+{
+	FVlc::MediaPlayerStop(Player);
+	FVlc::MediaPlayerSetMedia(Player, nullptr);
+	FVlc::MediaPlayerSetRate(Player, 1.0f);
+
+	// the outputs are closed now, and the next owner must not inherit callbacks into the previous owner's tracks
+	FVlc::AudioSetCallbacks(Player, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr);
+	FVlc::AudioSetFormatCallbacks(Player, nullptr, nullptr);
+	FVlc::VideoSetCallbacks(Player, nullptr, nullptr, nullptr, nullptr);
+	FVlc::VideoSetFormatCallbacks(Player, nullptr, nullptr);
+}
+
+
+void FVlcMediaPlayerPool::Refill()
+{
+	const int32 NumMissing = Capacity - GetNumAvailable() - NumCreating;
+
+	if ((NumMissing <= 0) || (Thread == nullptr))
+	{
+		return;
+	}
+
+	NumCreating += NumMissing;
+	FPlatformAtomics::InterlockedAdd(&NumToCreate, NumMissing);
+	WorkEvent->Trigger();
+}
+
+
+void FVlcMediaPlayerPool::Trim(int32 EntryIndex)
+{
+	// players that were created beyond the capacity are not kept
+	if ((EntryIndex != INDEX_NONE) && (GetNumAvailable() > Capacity))
+	{
+		FEntry* Entry = Entries[EntryIndex];
+
+		Entries.RemoveAtSwap(EntryIndex);
+		DestroyEntry(Entry);
+	}
+}
+
+
+/* FVlcMediaPlayerPool static functions
+ *****************************************************************************/
+
+void FVlcMediaPlayerPool::HandleEventCallback(FLibvlcEvent* Event, void* UserData)
+{
+	FEntry* Entry = (FEntry*)UserData;
+	FScopeLock Lock(&Entry->CriticalSection);
+
+	if (Entry->Callback != nullptr)
+	{
+		Entry->Callback(Event, Entry->UserData);
+	}
+}
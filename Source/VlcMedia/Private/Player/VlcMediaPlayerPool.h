@@ -0,0 +1,232 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#pragma once
+
+#include "VlcMediaBoundedQueue.h"
+
+
+/** Type definition for shared references to counters of pending player teardowns. */
+typedef TSharedRef<FThreadSafeCounter, ESPMode::ThreadSafe> FVlcMediaTeardownCounterRef;
+
+
+/**
+ * Implements a pool of pre-created libvlc media players.
+ *
+ * Creating a libvlc media player and attaching to its events is expensive enough to
+ * cause a visible hitch when switching media. Pooled players are created up front with
+ * their events already attached, and the events are forwarded to whichever media player
+ * currently uses them.
+ *
+ * Stopping a player blocks until libvlc's input thread exits, which can take hundreds
+ * of milliseconds for network streams. Players that are released with ReleaseDeferred
+ * are therefore stopped on a worker thread, which also creates the players that refill
+ * the pool. Apart from that, the pool must only be used on the game thread.
+ */
+class FVlcMediaPlayerPool
+	: public FRunnable
+{
+public:
+
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InVlcInstance The LibVLC instance to create players with.
+	 * @param InCapacity The number of players to keep ready.
+	 */
+	FVlcMediaPlayerPool(FLibvlcInstance* InVlcInstance, int32 InCapacity);
+
+	/** Virtual destructor. */
+	virtual ~FVlcMediaPlayerPool();
+
+public:
+
+	/**
+	 * Take a player from the pool, creating a new one if the pool is empty.
+	 *
+	 * @param Callback The function that receives the player's events.
+	 * @param UserData User data to pass to the event callback.
+	 * @param OutPooled Will be true if the player was taken from the pool, false if it was created.
+	 * @return The player, or nullptr if a player could not be created.
+	 * @see Release, ReleaseDeferred
+	 */
+	FLibvlcMediaPlayer* Acquire(FLibvlcCallback Callback, void* UserData, bool& OutPooled);
+
+	/**
+	 * Take over the players that the worker thread stopped or created.
+	 *
+	 * This must be called regularly on the game thread (i.e. by the scheduler's ticker),
+	 * because the tracks of players that were released with ReleaseDeferred are only
+	 * destroyed, and their owners' teardown counters only decremented, in here.
+	 */
+	void CollectEntries();
+
+	/**
+	 * Get the number of players that are ready to be used.
+	 *
+	 * @return Number of players.
+	 */
+	int32 GetNumAvailable() const;
+
+	/**
+	 * Stop a player and return it to the pool.
+	 *
+	 * The player's event callback is no longer invoked after this returns.
+	 *
+	 * @param Player The player to return.
+	 * @see Acquire, ReleaseDeferred
+	 */
+	void Release(FLibvlcMediaPlayer* Player);
+
+	/**
+	 * Return a player to the pool without waiting for it to stop.
+	 *
+	 * The player's event callback is no longer invoked after this returns. The player is
+	 * stopped on the worker thread, and the given tracks are kept alive until then, because
+	 * the player's outputs may still call into them. The media that the player plays must
+	 * not depend on its owner anymore.
+	 *
+	 * @param Player The player to return.
+	 * @param Tracks The tracks to keep alive until the player stopped.
+	 * @param PendingTeardowns Counter that is decremented on the game thread once the player stopped.
+	 * @see Acquire, Release
+	 */
+	void ReleaseDeferred(FLibvlcMediaPlayer* Player, const TArray<IMediaTrackRef>& Tracks, const FVlcMediaTeardownCounterRef& PendingTeardowns);
+
+	/**
+	 * Change the function that receives the events of a player that is in use.
+	 *
+	 * @param Player The player.
+	 * @param Callback The function that receives the player's events.
+	 * @param UserData User data to pass to the event callback.
+	 */
+	void SetCallback(FLibvlcMediaPlayer* Player, FLibvlcCallback Callback, void* UserData);
+
+	/**
+	 * Join the worker thread and release all libvlc players.
+	 *
+	 * This includes the players that wait to be stopped, and it destroys the tracks that
+	 * they kept alive. It must be called before the libvlc instance is released, and the
+	 * pool does not create players anymore afterwards.
+	 */
+	void Shutdown();
+
+public:
+
+	// FRunnable interface
+
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+protected:
+
+	/** A pooled player. */
+	struct FEntry
+	{
+		/** The function that receives the player's events (nullptr while pooled). */
+		FLibvlcCallback Callback;
+
+		/** Critical section for synchronizing event forwarding with changes of the callback. */
+		FCriticalSection CriticalSection;
+
+		/** Whether the player is in use or being stopped. */
+		bool InUse;
+
+		/** Tracks that must outlive a player that is being stopped. */
+		TArray<IMediaTrackRef> KeepAlive;
+
+		/** Counter of the owner's pending teardowns (only set while the player is being stopped). */
+		TSharedPtr<FThreadSafeCounter, ESPMode::ThreadSafe> PendingTeardowns;
+
+		/** The libvlc media player. */
+		FLibvlcMediaPlayer* Player;
+
+		/** User data to pass to the event callback. */
+		void* UserData;
+	};
+
+	/**
+	 * Create a player and attach to its events.
+	 *
+	 * @return The new entry, or nullptr on failure.
+	 */
+	FEntry* CreateEntry();
+
+	/**
+	 * Release a player and its entry.
+	 *
+	 * @param Entry The entry to destroy.
+	 */
+	void DestroyEntry(FEntry* Entry);
+
+	/**
+	 * Find the entry of a player.
+	 *
+	 * @param Player The player.
+	 * @return Index of the entry, or INDEX_NONE if the player does not belong to the pool.
+	 */
+	int32 FindEntry(FLibvlcMediaPlayer* Player) const;
+
+	/**
+	 * Reset a stopped player, so that it can be used again.
+	 *
+	 * @param Player The player to reset.
+	 */
+	static void ResetPlayer(FLibvlcMediaPlayer* Player);
+
+	/** Ask the worker thread to create players until the pool is full again. */
+	void Refill();
+
+	/**
+	 * Destroy players beyond the capacity that are not in use.
+	 *
+	 * @param EntryIndex The index of the entry that was just returned to the pool.
+	 */
+	void Trim(int32 EntryIndex);
+
+private:
+
+	/** Handles event callbacks from pooled players. */
+	static void HandleEventCallback(FLibvlcEvent* Event, void* UserData);
+
+private:
+
+	/** The number of players to keep ready. */
+	int32 Capacity;
+
+	/** Players that the worker thread created. */
+	TVlcMediaBoundedQueue<FEntry*> CreatedEntries;
+
+	/** All players that were created by the pool. */
+	TArray<FEntry*> Entries;
+
+	/** Number of players that the worker thread was asked to create (only accessed on the game thread). */
+	int32 NumCreating;
+
+	/** Number of players that were released with ReleaseDeferred and not taken over yet (only accessed on the game thread). */
+	int32 NumStopping;
+
+	/** Number of players that the worker thread should create. */
+	volatile int32 NumToCreate;
+
+	/** Players that wait to be stopped by the worker thread. */
+	TVlcMediaBoundedQueue<FEntry*> PendingStops;
+
+	/** Players that the worker thread stopped. */
+	TVlcMediaBoundedQueue<FEntry*> StoppedEntries;
+
+	/** Whether the worker thread should stop. */
+	volatile bool Stopping;
+
+	/** The worker thread. */
+	FRunnableThread* Thread;
+
+	/** The LibVLC instance. */
+	FLibvlcInstance* VlcInstance;
+
+	/** Signaled when the worker thread has something to do. */
+	FEvent* WorkEvent;
+};
+
+
+/** Type definition for shared references to player pools. */
+typedef TSharedRef<FVlcMediaPlayerPool, ESPMode::ThreadSafe> FVlcMediaPlayerPoolRef;
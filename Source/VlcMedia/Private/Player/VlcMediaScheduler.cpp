@@ -0,0 +1,185 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+#include "ParallelFor.h"
+#include "Ticker.h"
+
+
+/** Minimum number of playing players for updating tracks on task graph workers. */
+#define VLCMEDIA_MIN_PARALLEL_PLAYERS 8
+
+
+/* FVlcMediaScheduler structors
+ *****************************************************************************/
+
+FVlcMediaScheduler::FVlcMediaScheduler(const FVlcMediaPlayerPoolRef& InPlayerPool)
+	: NumRemovedPlayers(0)
+	, PlayerPool(InPlayerPool)
+	, Ticking(false)
+{
+	TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FVlcMediaScheduler::HandleTicker), 0.0f);
+}
+
+
+FVlcMediaScheduler::~FVlcMediaScheduler()
+{
+	Shutdown();
+}
+
+
+/* FVlcMediaScheduler interface
+ *****************************************************************************/
+
+void FVlcMediaScheduler::Activate(FVlcMediaPlayer& Player)
+{
+	if (Player.GetSchedulerIndex() != INDEX_NONE)
+	{
+		return;
+	}
+
+	Player.SetSchedulerIndex(ActivePlayers.Add(&Player));
+}
+
+
+void FVlcMediaScheduler::Deactivate(FVlcMediaPlayer& Player)
+{
+	const int32 PlayerIndex = Player.GetSchedulerIndex();
+
+	if (PlayerIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	Player.SetSchedulerIndex(INDEX_NONE);
+
+	// players may close while the list is being iterated, so the removal is deferred
+	if (Ticking)
+	{
+		ActivePlayers[PlayerIndex] = nullptr;
+		PlayingPlayers.Remove(&Player);
+		++NumRemovedPlayers;
+
+		return;
+	}
+
+	ActivePlayers.RemoveAtSwap(PlayerIndex, 1, false);
+
+	if (PlayerIndex < ActivePlayers.Num())
+	{
+		ActivePlayers[PlayerIndex]->SetSchedulerIndex(PlayerIndex);
+	}
+}
+
+
+void FVlcMediaScheduler::Shutdown()
+{
+	if (!TickerHandle.IsValid())
+	{
+		return;
+	}
+
+	FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	TickerHandle.Reset();
+
+	// players that outlive the module are no longer updated
+	for (FVlcMediaPlayer* Player : ActivePlayers)
+	{
+		if (Player != nullptr)
+		{
+			Player->SetSchedulerIndex(INDEX_NONE);
+		}
+	}
+
+	ActivePlayers.Empty();
+	NumRemovedPlayers = 0;
+	PlayingPlayers.Empty();
+}
+
+
+void FVlcMediaScheduler::Tick()
+{
+	// players that were closed still finish stopping in the background
+	PlayerPool->CollectEntries();
+
+	if (ActivePlayers.Num() == 0)
+	{
+		return;
+	}
+
+	// events may call back into the player and its listeners, so they are processed on the game thread
+	Ticking = true;
+	PlayingPlayers.Reset();
+
+	for (int32 PlayerIndex = 0; PlayerIndex < ActivePlayers.Num(); ++PlayerIndex)
+	{
+		FVlcMediaPlayer* Player = ActivePlayers[PlayerIndex];
+
+		if (Player == nullptr)
+		{
+			continue;
+		}
+
+		Player->TickEvents();
+
+		if ((ActivePlayers[PlayerIndex] != nullptr) && Player->HasTracksToTick())
+		{
+			PlayingPlayers.Add(Player);
+		}
+	}
+
+	Ticking = false;
+
+	if (NumRemovedPlayers > 0)
+	{
+		Compact();
+	}
+
+	// track updates only touch the player's own tracks, so players can be updated concurrently
+	if (PlayingPlayers.Num() >= VLCMEDIA_MIN_PARALLEL_PLAYERS)
+	{
+		ParallelFor(PlayingPlayers.Num(), [this](int32 PlayerIndex) {
+			PlayingPlayers[PlayerIndex]->TickTracks();
+		});
+	}
+	else
+	{
+		for (FVlcMediaPlayer* Player : PlayingPlayers)
+		{
+			Player->TickTracks();
+		}
+	}
+}
+
+
+/* FVlcMediaScheduler implementation
+ *****************************************************************************/
+
+void FVlcMediaScheduler::Compact()
+{
+	int32 NumKept = 0;
+
+	for (int32 PlayerIndex = 0; PlayerIndex < ActivePlayers.Num(); ++PlayerIndex)
+	{
+		FVlcMediaPlayer* Player = ActivePlayers[PlayerIndex];
+
+		if (Player != nullptr)
+		{
+			Player->SetSchedulerIndex(NumKept);
+			ActivePlayers[NumKept++] = Player;
+		}
+	}
+
+	ActivePlayers.RemoveAt(NumKept, ActivePlayers.Num() - NumKept, false);
+	NumRemovedPlayers = 0;
+}
+
+
+/* FVlcMediaScheduler callbacks
+ *****************************************************************************/
+
+bool FVlcMediaScheduler::HandleTicker(float DeltaTime)
+{
+	Tick();
+
+	return true;
+}
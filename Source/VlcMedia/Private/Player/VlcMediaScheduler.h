@@ -0,0 +1,109 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#pragma once
+
+
+class FVlcMediaPlayer;
+
+
+/**
+ * Updates all media players of the module from a single ticker.
+ *
+ * Only players that have media opened are kept in a contiguous list, so closed
+ * players cost nothing. Each tick first takes over the pooled players that finished
+ * stopping, then processes the players' events on the game thread, and then updates
+ * the tracks of all playing players in one pass, which is spread across task graph
+ * workers if there are enough players.
+ */
+class FVlcMediaScheduler
+{
+public:
+
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InPlayerPool The pool of libvlc media players.
+	 */
+	FVlcMediaScheduler(const FVlcMediaPlayerPoolRef& InPlayerPool);
+
+	/** Destructor. */
+	~FVlcMediaScheduler();
+
+public:
+
+	/**
+	 * Start updating a player (i.e. after it opened media).
+	 *
+	 * @param Player The player to update.
+	 * @see Deactivate
+	 */
+	void Activate(FVlcMediaPlayer& Player);
+
+	/**
+	 * Stop updating a player (i.e. after it closed its media).
+	 *
+	 * @param Player The player to stop updating.
+	 * @see Activate
+	 */
+	void Deactivate(FVlcMediaPlayer& Player);
+
+	/**
+	 * Get the number of players that are being updated.
+	 *
+	 * @return Number of players.
+	 */
+	int32 GetNumActivePlayers() const
+	{
+		return ActivePlayers.Num() - NumRemovedPlayers;
+	}
+
+	/**
+	 * Stop updating all players and remove the ticker.
+	 *
+	 * This must be called before the libvlc instance is released, because the ticker
+	 * takes over the pool's stopped players and ticks players that use libvlc.
+	 */
+	void Shutdown();
+
+	/**
+	 * Update all active players once.
+	 *
+	 * This is called by the ticker on the game thread, and it may be called directly
+	 * on the game thread by code that drives the scheduler itself (i.e. benchmarks).
+	 */
+	void Tick();
+
+protected:
+
+	/** Remove the entries of players that were deactivated during a tick. */
+	void Compact();
+
+private:
+
+	/** Handles the ticker. */
+	bool HandleTicker(float DeltaTime);
+
+private:
+
+	/** The players that are being updated (may contain nullptr while ticking). */
+	TArray<FVlcMediaPlayer*> ActivePlayers;
+
+	/** Number of players that were deactivated during the current tick. */
+	int32 NumRemovedPlayers;
+
+	/** The pool of libvlc media players. */
+	FVlcMediaPlayerPoolRef PlayerPool;
+
+	/** Players whose tracks are updated in the current tick (only accessed by the ticker). */
+	TArray<FVlcMediaPlayer*> PlayingPlayers;
+
+	/** Handle to the registered ticker. */
+	FDelegateHandle TickerHandle;
+
+	/** Whether the players are being ticked. */
+	bool Ticking;
+};
+
+
+/** Type definition for shared references to player schedulers. */
+typedef TSharedRef<FVlcMediaScheduler, ESPMode::ThreadSafe> FVlcMediaSchedulerRef;
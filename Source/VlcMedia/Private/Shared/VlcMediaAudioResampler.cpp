@@ -0,0 +1,350 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+#include "VlcMediaSimd.h"
+
+
+namespace VlcMediaAudioResampler
+{
+	/** Gain of the center and surround channels when down-mixing to stereo (-3 dB). */
+	const float SurroundGain = 0.70710678f;
+
+	/**
+	 * Interpolate between P1 and P2 with a Catmull-Rom spline.
+	 *
+	 * The operations are ordered like in the SIMD implementation, so both produce the same results.
+	 *
+	 * @param P0 The sample before P1.
+	 * @param P1 The sample at the start of the interval.
+	 * @param P2 The sample at the end of the interval.
+	 * @param P3 The sample after P2.
+	 * @param T The position within the interval (0..1).
+	 * @return The interpolated sample.
+	 */
+	FORCEINLINE float CatmullRom(float P0, float P1, float P2, float P3, float T)
+	{
+		const float A = ((P1 - P2) * 3.0f + P3) - P0;
+		const float B = ((P0 * 2.0f - P1 * 5.0f) + P2 * 4.0f) - P3;
+		const float C = P2 - P0;
+
+		return P1 + (T * 0.5f) * (C + T * (B + T * A));
+	}
+}
+
+
+/* FVlcMediaAudioResampler structors
+ *****************************************************************************/
+
+FVlcMediaAudioResampler::FVlcMediaAudioResampler()
+	: InputChannels(0)
+	, InputRate(0)
+	, OutputChannels(0)
+	, OutputRate(0)
+	, Passthrough(true)
+	, Position(0.0)
+	, Step(1.0)
+{
+	FMemory::Memzero(Matrix);
+}
+
+
+/* FVlcMediaAudioResampler interface
+ *****************************************************************************/
+
+bool FVlcMediaAudioResampler::Configure(uint32 InInputChannels, uint32 InInputRate, uint32 InOutputChannels, uint32 InOutputRate)
+{
+	if ((InInputChannels == 0) || (InInputChannels > MaxChannels) || (InOutputChannels == 0) || (InOutputChannels > MaxChannels) || (InInputRate == 0) || (InOutputRate == 0))
+	{
+		return false;
+	}
+
+	InputChannels = InInputChannels;
+	InputRate = InInputRate;
+	OutputChannels = InOutputChannels;
+	OutputRate = InOutputRate;
+	Passthrough = ((InputChannels == OutputChannels) && (InputRate == OutputRate));
+	Step = (double)InputRate / OutputRate;
+
+	// build the down-mix matrix
+	FMemory::Memzero(Matrix);
+
+	if (InputChannels <= OutputChannels)
+	{
+		// mono is copied to all outputs, otherwise additional outputs are silent
+		for (uint32 OutputIndex = 0; OutputIndex < OutputChannels; ++OutputIndex)
+		{
+			if (InputChannels == 1)
+			{
+				Matrix[OutputIndex][0] = 1.0f;
+			}
+			else if (OutputIndex < InputChannels)
+			{
+				Matrix[OutputIndex][OutputIndex] = 1.0f;
+			}
+		}
+	}
+	else if ((InputChannels == 6) && (OutputChannels == 2))
+	{
+		// libvlc orders 5.1 channels as L, R, Ls, Rs, C, LFE; the LFE channel is dropped
+		const float Scale = 1.0f / (1.0f + 2.0f * VlcMediaAudioResampler::SurroundGain);
+
+		Matrix[0][0] = Scale;
+		Matrix[0][2] = VlcMediaAudioResampler::SurroundGain * Scale;
+		Matrix[0][4] = VlcMediaAudioResampler::SurroundGain * Scale;
+		Matrix[1][1] = Scale;
+		Matrix[1][3] = VlcMediaAudioResampler::SurroundGain * Scale;
+		Matrix[1][4] = VlcMediaAudioResampler::SurroundGain * Scale;
+	}
+	else
+	{
+		// each output is the average of every OutputChannels-th input
+		for (uint32 InputIndex = 0; InputIndex < InputChannels; ++InputIndex)
+		{
+			const uint32 OutputIndex = InputIndex % OutputChannels;
+			const uint32 NumSources = (InputChannels - OutputIndex + OutputChannels - 1) / OutputChannels;
+
+			Matrix[OutputIndex][InputIndex] = 1.0f / NumSources;
+		}
+	}
+
+	Reset();
+
+	return true;
+}
+
+
+uint32 FVlcMediaAudioResampler::GetMaxOutputFrames(uint32 NumInputFrames) const
+{
+	if (InputRate == OutputRate)
+	{
+		return NumInputFrames;
+	}
+
+	return (uint32)((NumInputFrames + HistoryFrames) / Step) + 2;
+}
+
+
+uint32 FVlcMediaAudioResampler::Process(const float* Input, uint32 NumInputFrames, int16* Output)
+{
+	if ((NumInputFrames == 0) || (OutputChannels == 0))
+	{
+		return 0;
+	}
+
+	if (Passthrough)
+	{
+		ConvertToInt16(Input, NumInputFrames * InputChannels, Output);
+
+		return NumInputFrames;
+	}
+
+	Downmix(Input, NumInputFrames);
+
+	const int32 NumFrames = HistoryFrames + NumInputFrames;
+	uint32 NumOutputFrames = 0;
+
+	if (InputRate == OutputRate)
+	{
+		NumOutputFrames = NumInputFrames;
+		Mixed.Reset();
+		Mixed.AddUninitialized(NumOutputFrames * OutputChannels);
+
+		for (uint32 ChannelIndex = 0; ChannelIndex < OutputChannels; ++ChannelIndex)
+		{
+			const float* Source = Planes[ChannelIndex].GetData() + HistoryFrames;
+
+			for (uint32 FrameIndex = 0; FrameIndex < NumOutputFrames; ++FrameIndex)
+			{
+				Mixed[FrameIndex * OutputChannels + ChannelIndex] = Source[FrameIndex];
+			}
+		}
+	}
+	else
+	{
+		// each output frame needs one input frame before and two after its position
+		while ((int32)(Position + NumOutputFrames * Step) + 2 < NumFrames)
+		{
+			++NumOutputFrames;
+		}
+
+		Mixed.Reset();
+		Mixed.AddUninitialized(NumOutputFrames * OutputChannels);
+
+		Interpolate(NumOutputFrames, Mixed.GetData());
+		Position += NumOutputFrames * Step - (NumFrames - HistoryFrames);
+	}
+
+	// keep the last input frames for the next block
+	for (uint32 ChannelIndex = 0; ChannelIndex < OutputChannels; ++ChannelIndex)
+	{
+		TArray<float>& Plane = Planes[ChannelIndex];
+
+		FMemory::Memmove(Plane.GetData(), Plane.GetData() + NumFrames - HistoryFrames, HistoryFrames * sizeof(float));
+		Plane.RemoveAt(HistoryFrames, Plane.Num() - HistoryFrames, false);
+	}
+
+	ConvertToInt16(Mixed.GetData(), NumOutputFrames * OutputChannels, Output);
+
+	return NumOutputFrames;
+}
+
+
+void FVlcMediaAudioResampler::Reset()
+{
+	for (uint32 ChannelIndex = 0; ChannelIndex < MaxChannels; ++ChannelIndex)
+	{
+		Planes[ChannelIndex].Reset();
+
+		if (ChannelIndex < OutputChannels)
+		{
+			Planes[ChannelIndex].AddZeroed(HistoryFrames);
+		}
+	}
+
+	// the first output frame coincides with the first input frame
+	Position = HistoryFrames;
+}
+
+
+/* FVlcMediaAudioResampler implementation
+ *****************************************************************************/
+
+void FVlcMediaAudioResampler::Downmix(const float* Input, uint32 NumFrames)
+{
+	for (uint32 ChannelIndex = 0; ChannelIndex < OutputChannels; ++ChannelIndex)
+	{
+		Planes[ChannelIndex].AddUninitialized(NumFrames);
+
+		const float* Row = Matrix[ChannelIndex];
+		float* Dest = Planes[ChannelIndex].GetData() + HistoryFrames;
+		uint32 FrameIndex = 0;
+
+#if VLCMEDIA_X86
+		const uint32 Stride = InputChannels;
+
+		for (; FrameIndex + 4 <= NumFrames; FrameIndex += 4)
+		{
+			const float* Frames = Input + FrameIndex * Stride;
+			__m128 Sum = _mm_setzero_ps();
+
+			for (uint32 InputIndex = 0; InputIndex < InputChannels; ++InputIndex)
+			{
+				if (Row[InputIndex] != 0.0f)
+				{
+					const __m128 Samples = _mm_setr_ps(Frames[InputIndex], Frames[InputIndex + Stride], Frames[InputIndex + 2 * Stride], Frames[InputIndex + 3 * Stride]);
+					Sum = _mm_add_ps(Sum, _mm_mul_ps(Samples, _mm_set1_ps(Row[InputIndex])));
+				}
+			}
+
+			_mm_storeu_ps(Dest + FrameIndex, Sum);
+		}
+#endif
+
+		for (; FrameIndex < NumFrames; ++FrameIndex)
+		{
+			const float* Frame = Input + FrameIndex * InputChannels;
+			float Sum = 0.0f;
+
+			for (uint32 InputIndex = 0; InputIndex < InputChannels; ++InputIndex)
+			{
+				if (Row[InputIndex] != 0.0f)
+				{
+					Sum += Frame[InputIndex] * Row[InputIndex];
+				}
+			}
+
+			Dest[FrameIndex] = Sum;
+		}
+	}
+}
+
+
+void FVlcMediaAudioResampler::Interpolate(uint32 NumFrames, float* Output)
+{
+	Indices.Reset();
+	Indices.AddUninitialized(NumFrames);
+	Fractions.Reset();
+	Fractions.AddUninitialized(NumFrames);
+
+	// positions are calculated from the block start, so rounding errors don't accumulate
+	for (uint32 FrameIndex = 0; FrameIndex < NumFrames; ++FrameIndex)
+	{
+		const double FramePosition = Position + FrameIndex * Step;
+		const int32 Index = (int32)FramePosition;
+
+		Indices[FrameIndex] = Index;
+		Fractions[FrameIndex] = (float)(FramePosition - Index);
+	}
+
+	for (uint32 ChannelIndex = 0; ChannelIndex < OutputChannels; ++ChannelIndex)
+	{
+		const float* Source = Planes[ChannelIndex].GetData();
+		uint32 FrameIndex = 0;
+
+#if VLCMEDIA_X86
+		const __m128 Two = _mm_set1_ps(2.0f);
+		const __m128 Three = _mm_set1_ps(3.0f);
+		const __m128 Four = _mm_set1_ps(4.0f);
+		const __m128 Five = _mm_set1_ps(5.0f);
+		const __m128 Half = _mm_set1_ps(0.5f);
+
+		for (; FrameIndex + 4 <= NumFrames; FrameIndex += 4)
+		{
+			const int32* Index = Indices.GetData() + FrameIndex;
+
+			const __m128 P0 = _mm_setr_ps(Source[Index[0] - 1], Source[Index[1] - 1], Source[Index[2] - 1], Source[Index[3] - 1]);
+			const __m128 P1 = _mm_setr_ps(Source[Index[0]], Source[Index[1]], Source[Index[2]], Source[Index[3]]);
+			const __m128 P2 = _mm_setr_ps(Source[Index[0] + 1], Source[Index[1] + 1], Source[Index[2] + 1], Source[Index[3] + 1]);
+			const __m128 P3 = _mm_setr_ps(Source[Index[0] + 2], Source[Index[1] + 2], Source[Index[2] + 2], Source[Index[3] + 2]);
+			const __m128 T = _mm_loadu_ps(Fractions.GetData() + FrameIndex);
+
+			const __m128 A = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(P1, P2), Three), P3), P0);
+			const __m128 B = _mm_sub_ps(_mm_add_ps(_mm_sub_ps(_mm_mul_ps(P0, Two), _mm_mul_ps(P1, Five)), _mm_mul_ps(P2, Four)), P3);
+			const __m128 C = _mm_sub_ps(P2, P0);
+			const __m128 Polynomial = _mm_add_ps(C, _mm_mul_ps(T, _mm_add_ps(B, _mm_mul_ps(T, A))));
+			const __m128 Result = _mm_add_ps(P1, _mm_mul_ps(_mm_mul_ps(T, Half), Polynomial));
+
+			float Samples[4];
+			_mm_storeu_ps(Samples, Result);
+
+			for (uint32 SampleIndex = 0; SampleIndex < 4; ++SampleIndex)
+			{
+				Output[(FrameIndex + SampleIndex) * OutputChannels + ChannelIndex] = Samples[SampleIndex];
+			}
+		}
+#endif
+
+		for (; FrameIndex < NumFrames; ++FrameIndex)
+		{
+			const int32 Index = Indices[FrameIndex];
+
+			Output[FrameIndex * OutputChannels + ChannelIndex] = VlcMediaAudioResampler::CatmullRom(
+				Source[Index - 1], Source[Index], Source[Index + 1], Source[Index + 2], Fractions[FrameIndex]);
+		}
+	}
+}
+
+
+void FVlcMediaAudioResampler::ConvertToInt16(const float* Input, uint32 NumSamples, int16* Output)
+{
+	uint32 SampleIndex = 0;
+
+#if VLCMEDIA_X86
+	const __m128 Min = _mm_set1_ps(-1.0f);
+	const __m128 Max = _mm_set1_ps(1.0f);
+	const __m128 Scale = _mm_set1_ps(32767.0f);
+
+	for (; SampleIndex + 8 <= NumSamples; SampleIndex += 8)
+	{
+		const __m128 Low = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(Input + SampleIndex), Min), Max), Scale);
+		const __m128 High = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(Input + SampleIndex + 4), Min), Max), Scale);
+
+		_mm_storeu_si128((__m128i*)(Output + SampleIndex), _mm_packs_epi32(_mm_cvtps_epi32(Low), _mm_cvtps_epi32(High)));
+	}
+#endif
+
+	for (; SampleIndex < NumSamples; ++SampleIndex)
+	{
+		Output[SampleIndex] = (int16)FMath::RoundToInt(FMath::Clamp(Input[SampleIndex], -1.0f, 1.0f) * 32767.0f);
+	}
+}
@@ -0,0 +1,142 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#pragma once
+
+
+/**
+ * Converts interleaved 32-bit float audio to interleaved 16-bit PCM at another
+ * sample rate and channel count.
+ *
+ * Channels are mixed with a fixed down-mix matrix, and the sample rate is converted
+ * with four point Catmull-Rom interpolation. The interpolation and sample conversion
+ * use SSE2 on x86 and x64 processors. The resampler keeps a short history between
+ * calls, so that a stream can be converted in blocks of any size without clicks.
+ */
+class FVlcMediaAudioResampler
+{
+public:
+
+	/** The maximum number of input and output channels. */
+	static const uint32 MaxChannels = 8;
+
+	/** Default constructor. */
+	FVlcMediaAudioResampler();
+
+public:
+
+	/**
+	 * Set the input and output formats.
+	 *
+	 * Changing the formats resets the resampler.
+	 *
+	 * @param InInputChannels The number of input channels.
+	 * @param InInputRate The input sample rate.
+	 * @param InOutputChannels The number of output channels.
+	 * @param InOutputRate The output sample rate.
+	 * @return true on success, false if the formats are not supported.
+	 */
+	bool Configure(uint32 InInputChannels, uint32 InInputRate, uint32 InOutputChannels, uint32 InOutputRate);
+
+	/**
+	 * Get the maximum number of frames that converting the given number of input frames can produce.
+	 *
+	 * @param NumInputFrames The number of input frames.
+	 * @return Maximum number of output frames.
+	 */
+	uint32 GetMaxOutputFrames(uint32 NumInputFrames) const;
+
+	/**
+	 * Check whether the resampler is set up for the given formats.
+	 *
+	 * @param InInputChannels The number of input channels.
+	 * @param InInputRate The input sample rate.
+	 * @param InOutputChannels The number of output channels.
+	 * @param InOutputRate The output sample rate.
+	 * @return true if the formats match, false otherwise.
+	 */
+	bool IsConfiguredFor(uint32 InInputChannels, uint32 InInputRate, uint32 InOutputChannels, uint32 InOutputRate) const
+	{
+		return ((InputChannels == InInputChannels) && (InputRate == InInputRate) && (OutputChannels == InOutputChannels) && (OutputRate == InOutputRate));
+	}
+
+	/**
+	 * Convert a block of audio.
+	 *
+	 * @param Input The interleaved input frames.
+	 * @param NumInputFrames The number of input frames.
+	 * @param Output Will contain the interleaved output frames (must hold GetMaxOutputFrames frames).
+	 * @return The number of output frames.
+	 */
+	uint32 Process(const float* Input, uint32 NumInputFrames, int16* Output);
+
+	/** Discard the history, i.e. after a seek. */
+	void Reset();
+
+protected:
+
+	/**
+	 * Mix input frames into the planar work buffers (after the history).
+	 *
+	 * @param Input The interleaved input frames.
+	 * @param NumFrames The number of frames to mix.
+	 */
+	void Downmix(const float* Input, uint32 NumFrames);
+
+	/**
+	 * Interpolate output frames from the planar work buffers.
+	 *
+	 * @param NumFrames The number of output frames to produce.
+	 * @param Output Will contain the interleaved output frames.
+	 */
+	void Interpolate(uint32 NumFrames, float* Output);
+
+	/**
+	 * Convert float samples to 16-bit integers with clamping.
+	 *
+	 * @param Input The samples to convert.
+	 * @param NumSamples The number of samples.
+	 * @param Output Will contain the converted samples.
+	 */
+	static void ConvertToInt16(const float* Input, uint32 NumSamples, int16* Output);
+
+private:
+
+	/** Number of history frames kept in front of the planar work buffers. */
+	static const uint32 HistoryFrames = 3;
+
+	/** The number of input channels. */
+	uint32 InputChannels;
+
+	/** The input sample rate. */
+	uint32 InputRate;
+
+	/** Frame indices of the current block's output frames (reused between calls). */
+	TArray<int32> Indices;
+
+	/** Interpolation weights of the current block's output frames (reused between calls). */
+	TArray<float> Fractions;
+
+	/** Interleaved float output (reused between calls). */
+	TArray<float> Mixed;
+
+	/** Down-mix coefficients (output channel major). */
+	float Matrix[MaxChannels][MaxChannels];
+
+	/** The number of output channels. */
+	uint32 OutputChannels;
+
+	/** The output sample rate. */
+	uint32 OutputRate;
+
+	/** Whether input is passed through without mixing or resampling. */
+	bool Passthrough;
+
+	/** Planar work buffers with history (one per output channel). */
+	TArray<float> Planes[MaxChannels];
+
+	/** Position of the next output frame in the work buffers (in input frames). */
+	double Position;
+
+	/** Distance between output frames (in input frames). */
+	double Step;
+};
@@ -0,0 +1,196 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#pragma once
+
+
+/**
+ * Implements a bounded lock-free queue.
+ *
+ * Any number of threads may enqueue and dequeue concurrently. Each slot carries a
+ * sequence number that tells producers and consumers whether it is free or filled,
+ * so neither side ever waits for the other (D. Vyukov's bounded MPMC queue).
+ *
+ * @param ElementType The type of elements held in the queue (must be default constructible).
+ */
+template<typename ElementType>
+class TVlcMediaBoundedQueue
+{
+public:
+
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InCapacity The maximum number of elements (rounded up to a power of two).
+	 */
+	explicit TVlcMediaBoundedQueue(uint32 InCapacity)
+		: DequeuePosition(0)
+		, EnqueuePosition(0)
+	{
+		Capacity = FMath::RoundUpToPowerOfTwo(FMath::Max(InCapacity, 2u));
+		Cells = new FCell[Capacity];
+
+		for (uint32 CellIndex = 0; CellIndex < Capacity; ++CellIndex)
+		{
+			Cells[CellIndex].Sequence = (int32)CellIndex;
+		}
+	}
+
+	/** Destructor. */
+	~TVlcMediaBoundedQueue()
+	{
+		delete[] Cells;
+	}
+
+public:
+
+	/**
+	 * Remove the oldest element from the queue.
+	 *
+	 * @param OutElement Will hold the element.
+	 * @return true if an element was removed, false if the queue was empty.
+	 */
+	bool Dequeue(ElementType& OutElement)
+	{
+		int32 Position = DequeuePosition;
+		FCell* Cell;
+
+		for (;;)
+		{
+			Cell = &Cells[Position & (Capacity - 1)];
+
+			const int32 Sequence = Cell->Sequence;
+			FPlatformMisc::MemoryBarrier();
+
+			const int32 Difference = Sequence - (Position + 1);
+
+			if (Difference == 0)
+			{
+				if (FPlatformAtomics::InterlockedCompareExchange(&DequeuePosition, Position + 1, Position) == Position)
+				{
+					break;
+				}
+			}
+			else if (Difference < 0)
+			{
+				return false;
+			}
+			else
+			{
+				Position = DequeuePosition;
+			}
+		}
+
+		OutElement = MoveTemp(Cell->Element);
+		Cell->Element = ElementType();
+
+		FPlatformMisc::MemoryBarrier();
+		Cell->Sequence = Position + (int32)Capacity;
+
+		return true;
+	}
+
+	/**
+	 * Add an element to the queue.
+	 *
+	 * @param Element The element to add.
+	 * @return true if the element was added, false if the queue was full.
+	 */
+	bool Enqueue(const ElementType& Element)
+	{
+		int32 Position = EnqueuePosition;
+		FCell* Cell;
+
+		for (;;)
+		{
+			Cell = &Cells[Position & (Capacity - 1)];
+
+			const int32 Sequence = Cell->Sequence;
+			FPlatformMisc::MemoryBarrier();
+
+			const int32 Difference = Sequence - Position;
+
+			if (Difference == 0)
+			{
+				if (FPlatformAtomics::InterlockedCompareExchange(&EnqueuePosition, Position + 1, Position) == Position)
+				{
+					break;
+				}
+			}
+			else if (Difference < 0)
+			{
+				return false;
+			}
+			else
+			{
+				Position = EnqueuePosition;
+			}
+		}
+
+		Cell->Element = Element;
+
+		FPlatformMisc::MemoryBarrier();
+		Cell->Sequence = Position + 1;
+
+		return true;
+	}
+
+	/**
+	 * Get the maximum number of elements.
+	 *
+	 * @return Capacity.
+	 */
+	uint32 GetCapacity() const
+	{
+		return Capacity;
+	}
+
+	/**
+	 * Get the number of elements in the queue.
+	 *
+	 * The result is only a snapshot if other threads are using the queue.
+	 *
+	 * @return Number of elements.
+	 */
+	int32 Num() const
+	{
+		return FMath::Clamp(EnqueuePosition - DequeuePosition, 0, (int32)Capacity);
+	}
+
+private:
+
+	/** A slot in the queue. */
+	struct FCell
+	{
+		/** Sequence number that tells whether the slot is free or holds an element. */
+		volatile int32 Sequence;
+
+		/** The element. */
+		ElementType Element;
+	};
+
+	/** The number of slots (a power of two). */
+	uint32 Capacity;
+
+	/** The slots. */
+	FCell* Cells;
+
+	/** Padding to keep the consumer position on its own cache line. */
+	uint8 Padding0[PLATFORM_CACHE_LINE_SIZE];
+
+	/** Position of the next element to dequeue. */
+	volatile int32 DequeuePosition;
+
+	/** Padding to keep the producer position on its own cache line. */
+	uint8 Padding1[PLATFORM_CACHE_LINE_SIZE];
+
+	/** Position of the next element to enqueue. */
+	volatile int32 EnqueuePosition;
+
+private:
+
+	/** Hidden copy constructor. */
+	TVlcMediaBoundedQueue(const TVlcMediaBoundedQueue&);
+
+	/** Hidden copy assignment operator. */
+	TVlcMediaBoundedQueue& operator=(const TVlcMediaBoundedQueue&);
+};
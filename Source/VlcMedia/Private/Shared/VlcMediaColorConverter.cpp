@@ -0,0 +1,482 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+#include "VlcMediaSimd.h"
+
+
+namespace VlcMediaColorConverter
+{
+	/** Number of fractional bits in the conversion coefficients. */
+	const int32 FractionalBits = 13;
+
+	/** Rounding term added before shifting out the fractional bits. */
+	const int32 Rounding = 1 << (FractionalBits - 1);
+
+	/** Type definition for functions that convert a single row of pixels. */
+	typedef void (*FConvertRowFunc)(const uint8* Y, const uint8* U, const uint8* V, uint8* Dest, int32 Width, const FVlcMediaColorCoefficients& C);
+
+	/**
+	 * Clamp a converted color component to the range of a byte.
+	 *
+	 * @param Value The value to clamp.
+	 * @return The clamped value.
+	 */
+	FORCEINLINE uint8 ClampComponent(int32 Value)
+	{
+		return (uint8)FMath::Clamp(Value, 0, 255);
+	}
+
+	/**
+	 * Convert a row of pixels (scalar reference implementation).
+	 *
+	 * Chroma samples are shared by two horizontally adjacent pixels. For semi-planar
+	 * (interleaved) input, U and V point into the same plane with a stride of two bytes.
+	 *
+	 * @param Y The row of luma samples.
+	 * @param U The row of U samples.
+	 * @param V The row of V samples.
+	 * @param Dest The row of BGRA pixels to write.
+	 * @param Width The number of pixels to convert.
+	 * @param C The conversion coefficients.
+	 */
+	template<bool Interleaved>
+	void ConvertRowScalar(const uint8* Y, const uint8* U, const uint8* V, uint8* Dest, int32 Width, const FVlcMediaColorCoefficients& C)
+	{
+		const int32 ChromaStep = Interleaved ? 2 : 1;
+
+		for (int32 X = 0; X < Width; ++X)
+		{
+			const int32 Luma = (Y[X] - C.YOffset) * C.Y + Rounding;
+			const int32 Cb = U[(X / 2) * ChromaStep] - 128;
+			const int32 Cr = V[(X / 2) * ChromaStep] - 128;
+
+			Dest[0] = ClampComponent((Luma + Cb * C.BU) >> FractionalBits);
+			Dest[1] = ClampComponent((Luma + Cb * C.GU + Cr * C.GV) >> FractionalBits);
+			Dest[2] = ClampComponent((Luma + Cr * C.RV) >> FractionalBits);
+			Dest[3] = 255;
+
+			Dest += 4;
+		}
+	}
+
+#if VLCMEDIA_X86
+
+	/**
+	 * Combine two 16-bit coefficients into a 32-bit value for use with multiply-add instructions.
+	 *
+	 * @param Low The coefficient applied to the even 16-bit lanes.
+	 * @param High The coefficient applied to the odd 16-bit lanes.
+	 * @return The combined coefficients.
+	 */
+	FORCEINLINE int32 PackCoefficients(int32 Low, int32 High)
+	{
+		return (int32)(((uint32)(uint16)High << 16) | (uint32)(uint16)Low);
+	}
+
+	/**
+	 * Read four unaligned bytes.
+	 *
+	 * @param Source The bytes to read.
+	 * @return A vector holding the bytes in its lowest 32 bits.
+	 */
+	FORCEINLINE __m128i LoadBytes4(const uint8* Source)
+	{
+		int32 Value;
+		FMemory::Memcpy(&Value, Source, sizeof(Value));
+
+		return _mm_cvtsi32_si128(Value);
+	}
+
+	/**
+	 * Convert and store eight pixels (SSE2).
+	 *
+	 * @param Y Eight luma samples (16-bit lanes).
+	 * @param U Eight U samples, one per pixel (16-bit lanes).
+	 * @param V Eight V samples, one per pixel (16-bit lanes).
+	 * @param Dest Where to write the 32 bytes of BGRA pixels.
+	 * @param C The conversion coefficients.
+	 */
+	FORCEINLINE void StorePixelsSse2(__m128i Y, __m128i U, __m128i V, uint8* Dest, const FVlcMediaColorCoefficients& C)
+	{
+		const __m128i Luma = _mm_sub_epi16(Y, _mm_set1_epi16(C.YOffset));
+		const __m128i Cb = _mm_sub_epi16(U, _mm_set1_epi16(128));
+		const __m128i Cr = _mm_sub_epi16(V, _mm_set1_epi16(128));
+
+		const __m128i LumaCb = _mm_set1_epi32(PackCoefficients(C.Y, C.BU));
+		const __m128i LumaCr = _mm_set1_epi32(PackCoefficients(C.Y, C.RV));
+		const __m128i LumaGreen = _mm_set1_epi32(PackCoefficients(C.Y, C.GU));
+		const __m128i CrGreen = _mm_set1_epi32(PackCoefficients(C.GV, Rounding));
+		const __m128i Round = _mm_set1_epi32(Rounding);
+		const __m128i One = _mm_set1_epi16(1);
+
+		const __m128i LumaCbLo = _mm_unpacklo_epi16(Luma, Cb);
+		const __m128i LumaCbHi = _mm_unpackhi_epi16(Luma, Cb);
+		const __m128i LumaCrLo = _mm_unpacklo_epi16(Luma, Cr);
+		const __m128i LumaCrHi = _mm_unpackhi_epi16(Luma, Cr);
+		const __m128i CrOneLo = _mm_unpacklo_epi16(Cr, One);
+		const __m128i CrOneHi = _mm_unpackhi_epi16(Cr, One);
+
+		const __m128i B = _mm_packs_epi32(
+			_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(LumaCbLo, LumaCb), Round), FractionalBits),
+			_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(LumaCbHi, LumaCb), Round), FractionalBits));
+
+		const __m128i G = _mm_packs_epi32(
+			_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(LumaCbLo, LumaGreen), _mm_madd_epi16(CrOneLo, CrGreen)), FractionalBits),
+			_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(LumaCbHi, LumaGreen), _mm_madd_epi16(CrOneHi, CrGreen)), FractionalBits));
+
+		const __m128i R = _mm_packs_epi32(
+			_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(LumaCrLo, LumaCr), Round), FractionalBits),
+			_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(LumaCrHi, LumaCr), Round), FractionalBits));
+
+		// saturate to bytes and interleave to BGRA
+		const __m128i BG = _mm_unpacklo_epi8(_mm_packus_epi16(B, B), _mm_packus_epi16(G, G));
+		const __m128i RA = _mm_unpacklo_epi8(_mm_packus_epi16(R, R), _mm_set1_epi8(-1));
+
+		_mm_storeu_si128((__m128i*)Dest, _mm_unpacklo_epi16(BG, RA));
+		_mm_storeu_si128((__m128i*)(Dest + 16), _mm_unpackhi_epi16(BG, RA));
+	}
+
+	/** Convert a row of pixels (SSE2). */
+	template<bool Interleaved>
+	void ConvertRowSse2(const uint8* Y, const uint8* U, const uint8* V, uint8* Dest, int32 Width, const FVlcMediaColorCoefficients& C)
+	{
+		const int32 ChromaStep = Interleaved ? 2 : 1;
+		const __m128i Zero = _mm_setzero_si128();
+		int32 X = 0;
+
+		for (; X + 8 <= Width; X += 8)
+		{
+			const __m128i Luma = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(Y + X)), Zero);
+			__m128i Cb, Cr;
+
+			if (Interleaved)
+			{
+				// U0 V0 U0 V0 U1 V1 U1 V1 ...
+				__m128i CbCr = _mm_loadl_epi64((const __m128i*)(U + X));
+				CbCr = _mm_unpacklo_epi16(CbCr, CbCr);
+
+				Cb = _mm_and_si128(CbCr, _mm_set1_epi16(0xff));
+				Cr = _mm_srli_epi16(CbCr, 8);
+			}
+			else
+			{
+				const __m128i CbBytes = LoadBytes4(U + X / 2);
+				const __m128i CrBytes = LoadBytes4(V + X / 2);
+
+				Cb = _mm_unpacklo_epi8(_mm_unpacklo_epi8(CbBytes, CbBytes), Zero);
+				Cr = _mm_unpacklo_epi8(_mm_unpacklo_epi8(CrBytes, CrBytes), Zero);
+			}
+
+			StorePixelsSse2(Luma, Cb, Cr, Dest + X * 4, C);
+		}
+
+		ConvertRowScalar<Interleaved>(Y + X, U + (X / 2) * ChromaStep, V + (X / 2) * ChromaStep, Dest + X * 4, Width - X, C);
+	}
+
+	/** Convert a row of pixels (SSSE3). */
+	template<bool Interleaved>
+	VLCMEDIA_TARGET("ssse3")
+	void ConvertRowSsse3(const uint8* Y, const uint8* U, const uint8* V, uint8* Dest, int32 Width, const FVlcMediaColorCoefficients& C)
+	{
+		const int32 ChromaStep = Interleaved ? 2 : 1;
+		const __m128i Zero = _mm_setzero_si128();
+
+		// widen each chroma sample to 16 bits and duplicate it for two pixels
+		const __m128i CbShuffle = Interleaved
+			? _mm_setr_epi8(0, -1, 0, -1, 2, -1, 2, -1, 4, -1, 4, -1, 6, -1, 6, -1)
+			: _mm_setr_epi8(0, -1, 0, -1, 1, -1, 1, -1, 2, -1, 2, -1, 3, -1, 3, -1);
+		const __m128i CrShuffle = Interleaved
+			? _mm_setr_epi8(1, -1, 1, -1, 3, -1, 3, -1, 5, -1, 5, -1, 7, -1, 7, -1)
+			: CbShuffle;
+
+		int32 X = 0;
+
+		for (; X + 8 <= Width; X += 8)
+		{
+			const __m128i Luma = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(Y + X)), Zero);
+			__m128i Cb, Cr;
+
+			if (Interleaved)
+			{
+				const __m128i CbCr = _mm_loadl_epi64((const __m128i*)(U + X));
+
+				Cb = _mm_shuffle_epi8(CbCr, CbShuffle);
+				Cr = _mm_shuffle_epi8(CbCr, CrShuffle);
+			}
+			else
+			{
+				Cb = _mm_shuffle_epi8(LoadBytes4(U + X / 2), CbShuffle);
+				Cr = _mm_shuffle_epi8(LoadBytes4(V + X / 2), CrShuffle);
+			}
+
+			StorePixelsSse2(Luma, Cb, Cr, Dest + X * 4, C);
+		}
+
+		ConvertRowScalar<Interleaved>(Y + X, U + (X / 2) * ChromaStep, V + (X / 2) * ChromaStep, Dest + X * 4, Width - X, C);
+	}
+
+	/** Convert a row of pixels (AVX2). */
+	template<bool Interleaved>
+	VLCMEDIA_TARGET("avx2")
+	void ConvertRowAvx2(const uint8* Y, const uint8* U, const uint8* V, uint8* Dest, int32 Width, const FVlcMediaColorCoefficients& C)
+	{
+		const int32 ChromaStep = Interleaved ? 2 : 1;
+
+		const __m256i YOffset = _mm256_set1_epi16(C.YOffset);
+		const __m256i ChromaOffset = _mm256_set1_epi16(128);
+		const __m256i LumaCb = _mm256_set1_epi32(PackCoefficients(C.Y, C.BU));
+		const __m256i LumaCr = _mm256_set1_epi32(PackCoefficients(C.Y, C.RV));
+		const __m256i LumaGreen = _mm256_set1_epi32(PackCoefficients(C.Y, C.GU));
+		const __m256i CrGreen = _mm256_set1_epi32(PackCoefficients(C.GV, Rounding));
+		const __m256i Round = _mm256_set1_epi32(Rounding);
+		const __m256i One = _mm256_set1_epi16(1);
+		const __m256i Alpha = _mm256_set1_epi8(-1);
+
+		// separates interleaved chroma into U0..U7 followed by V0..V7
+		const __m128i Deinterleave = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+
+		int32 X = 0;
+
+		for (; X + 16 <= Width; X += 16)
+		{
+			__m128i CbBytes, CrBytes;
+
+			if (Interleaved)
+			{
+				const __m128i CbCr = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(U + X)), Deinterleave);
+
+				CbBytes = _mm_unpacklo_epi8(CbCr, CbCr);
+				CrBytes = _mm_unpackhi_epi8(CbCr, CbCr);
+			}
+			else
+			{
+				CbBytes = _mm_loadl_epi64((const __m128i*)(U + X / 2));
+				CrBytes = _mm_loadl_epi64((const __m128i*)(V + X / 2));
+
+				CbBytes = _mm_unpacklo_epi8(CbBytes, CbBytes);
+				CrBytes = _mm_unpacklo_epi8(CrBytes, CrBytes);
+			}
+
+			const __m256i Luma = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(Y + X))), YOffset);
+			const __m256i Cb = _mm256_sub_epi16(_mm256_cvtepu8_epi16(CbBytes), ChromaOffset);
+			const __m256i Cr = _mm256_sub_epi16(_mm256_cvtepu8_epi16(CrBytes), ChromaOffset);
+
+			// unpacking works within 128-bit lanes, so the low halves hold pixels 0-3 and 8-11,
+			// and the high halves hold pixels 4-7 and 12-15; packing restores the original order
+			const __m256i LumaCbLo = _mm256_unpacklo_epi16(Luma, Cb);
+			const __m256i LumaCbHi = _mm256_unpackhi_epi16(Luma, Cb);
+			const __m256i LumaCrLo = _mm256_unpacklo_epi16(Luma, Cr);
+			const __m256i LumaCrHi = _mm256_unpackhi_epi16(Luma, Cr);
+			const __m256i CrOneLo = _mm256_unpacklo_epi16(Cr, One);
+			const __m256i CrOneHi = _mm256_unpackhi_epi16(Cr, One);
+
+			const __m256i B = _mm256_packs_epi32(
+				_mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(LumaCbLo, LumaCb), Round), FractionalBits),
+				_mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(LumaCbHi, LumaCb), Round), FractionalBits));
+
+			const __m256i G = _mm256_packs_epi32(
+				_mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(LumaCbLo, LumaGreen), _mm256_madd_epi16(CrOneLo, CrGreen)), FractionalBits),
+				_mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(LumaCbHi, LumaGreen), _mm256_madd_epi16(CrOneHi, CrGreen)), FractionalBits));
+
+			const __m256i R = _mm256_packs_epi32(
+				_mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(LumaCrLo, LumaCr), Round), FractionalBits),
+				_mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(LumaCrHi, LumaCr), Round), FractionalBits));
+
+			// each lane now holds eight pixels: interleave to BGRA, then reorder the lanes
+			const __m256i BG = _mm256_unpacklo_epi8(_mm256_packus_epi16(B, B), _mm256_packus_epi16(G, G));
+			const __m256i RA = _mm256_unpacklo_epi8(_mm256_packus_epi16(R, R), Alpha);
+			const __m256i PixelsLo = _mm256_unpacklo_epi16(BG, RA);
+			const __m256i PixelsHi = _mm256_unpackhi_epi16(BG, RA);
+
+			_mm256_storeu_si256((__m256i*)(Dest + X * 4), _mm256_permute2x128_si256(PixelsLo, PixelsHi, 0x20));
+			_mm256_storeu_si256((__m256i*)(Dest + X * 4 + 32), _mm256_permute2x128_si256(PixelsLo, PixelsHi, 0x31));
+		}
+
+		_mm256_zeroupper();
+
+		ConvertRowScalar<Interleaved>(Y + X, U + (X / 2) * ChromaStep, V + (X / 2) * ChromaStep, Dest + X * 4, Width - X, C);
+	}
+
+	/**
+	 * Query CPU features.
+	 *
+	 * @param Leaf The CPUID function.
+	 * @param SubLeaf The CPUID sub-function.
+	 * @param OutRegisters Will contain EAX, EBX, ECX and EDX.
+	 */
+	void CpuId(uint32 Leaf, uint32 SubLeaf, uint32 OutRegisters[4])
+	{
+#if defined(_MSC_VER)
+		__cpuidex((int32*)OutRegisters, Leaf, SubLeaf);
+#else
+		__cpuid_count(Leaf, SubLeaf, OutRegisters[0], OutRegisters[1], OutRegisters[2], OutRegisters[3]);
+#endif
+	}
+
+	/**
+	 * Query the register states that the operating system saves on context switches.
+	 *
+	 * @return The XCR0 register.
+	 */
+	uint64 GetXcr0()
+	{
+#if defined(_MSC_VER)
+		return _xgetbv(0);
+#else
+		uint32 Eax, Edx;
+		__asm__ __volatile__("xgetbv" : "=a"(Eax), "=d"(Edx) : "c"(0));
+
+		return ((uint64)Edx << 32) | Eax;
+#endif
+	}
+
+#endif // VLCMEDIA_X86
+
+	/**
+	 * Get the row conversion function for a SIMD level.
+	 *
+	 * @param SimdLevel The SIMD level.
+	 * @param Interleaved Whether chroma is interleaved (NV12) or planar (I420).
+	 * @return The conversion function.
+	 */
+	FConvertRowFunc GetConvertRowFunc(EVlcMediaSimdLevel SimdLevel, bool Interleaved)
+	{
+		switch (SimdLevel)
+		{
+#if VLCMEDIA_X86
+		case EVlcMediaSimdLevel::Avx2:
+			return Interleaved ? &ConvertRowAvx2<true> : &ConvertRowAvx2<false>;
+
+		case EVlcMediaSimdLevel::Ssse3:
+			return Interleaved ? &ConvertRowSsse3<true> : &ConvertRowSsse3<false>;
+
+		case EVlcMediaSimdLevel::Sse2:
+			return Interleaved ? &ConvertRowSse2<true> : &ConvertRowSse2<false>;
+#endif
+
+		default:
+			return Interleaved ? &ConvertRowScalar<true> : &ConvertRowScalar<false>;
+		}
+	}
+}
+
+
+/* FVlcMediaColorConverter structors
+ *****************************************************************************/
+
+FVlcMediaColorConverter::FVlcMediaColorConverter()
+	: SimdLevel(GetSupportedSimdLevel())
+{
+	SetColorSpace(EVlcMediaColorMatrix::Bt601, EVlcMediaColorRange::Limited);
+}
+
+
+/* FVlcMediaColorConverter interface
+ *****************************************************************************/
+
+bool FVlcMediaColorConverter::Convert(const FVlcMediaVideoLayout& Layout, const uint8* Source, uint8* Dest, uint32 DestPitch) const
+{
+	if ((Layout.Chroma != EVlcMediaVideoChroma::I420) && (Layout.Chroma != EVlcMediaVideoChroma::Nv12))
+	{
+		return false;
+	}
+
+	const bool Interleaved = (Layout.Chroma == EVlcMediaVideoChroma::Nv12);
+	const VlcMediaColorConverter::FConvertRowFunc ConvertRow = VlcMediaColorConverter::GetConvertRowFunc(SimdLevel, Interleaved);
+
+	// for NV12, the V samples follow the U samples in the same plane
+	const FVlcMediaVideoPlane& LumaPlane = Layout.Planes[0];
+	const FVlcMediaVideoPlane& CbPlane = Layout.Planes[1];
+	const FVlcMediaVideoPlane& CrPlane = Interleaved ? Layout.Planes[1] : Layout.Planes[2];
+	const uint32 CrOffset = CrPlane.Offset + (Interleaved ? 1 : 0);
+
+	for (int32 Row = 0; Row < Layout.Dimensions.Y; ++Row)
+	{
+		const int32 ChromaRow = Row / 2;
+
+		ConvertRow(
+			Source + LumaPlane.Offset + Row * LumaPlane.Pitch,
+			Source + CbPlane.Offset + ChromaRow * CbPlane.Pitch,
+			Source + CrOffset + ChromaRow * CrPlane.Pitch,
+			Dest + Row * DestPitch,
+			Layout.Dimensions.X,
+			Coefficients);
+	}
+
+	return true;
+}
+
+
+void FVlcMediaColorConverter::SetColorSpace(EVlcMediaColorMatrix Matrix, EVlcMediaColorRange Range)
+{
+	// luma weights of red and blue
+	const double Kr = (Matrix == EVlcMediaColorMatrix::Bt709) ? 0.2126 : 0.299;
+	const double Kb = (Matrix == EVlcMediaColorMatrix::Bt709) ? 0.0722 : 0.114;
+	const double Kg = 1.0 - Kr - Kb;
+
+	// limited range maps luma to [16, 235] and chroma to [16, 240]
+	const bool Limited = (Range == EVlcMediaColorRange::Limited);
+	const double LumaScale = Limited ? (255.0 / 219.0) : 1.0;
+	const double ChromaScale = Limited ? (255.0 / 224.0) : 1.0;
+	const double One = (double)(1 << VlcMediaColorConverter::FractionalBits);
+
+	Coefficients.YOffset = Limited ? 16 : 0;
+	Coefficients.Y = (int16)FMath::RoundToInt(LumaScale * One);
+	Coefficients.RV = (int16)FMath::RoundToInt(2.0 * (1.0 - Kr) * ChromaScale * One);
+	Coefficients.GU = (int16)FMath::RoundToInt(-2.0 * (1.0 - Kb) * Kb / Kg * ChromaScale * One);
+	Coefficients.GV = (int16)FMath::RoundToInt(-2.0 * (1.0 - Kr) * Kr / Kg * ChromaScale * One);
+	Coefficients.BU = (int16)FMath::RoundToInt(2.0 * (1.0 - Kb) * ChromaScale * One);
+}
+
+
+void FVlcMediaColorConverter::SetSimdLevel(EVlcMediaSimdLevel Level)
+{
+	SimdLevel = FMath::Min(Level, GetSupportedSimdLevel());
+}
+
+
+/* FVlcMediaColorConverter static functions
+ *****************************************************************************/
+
+EVlcMediaSimdLevel FVlcMediaColorConverter::GetSupportedSimdLevel()
+{
+#if VLCMEDIA_X86
+	static EVlcMediaSimdLevel SupportedLevel = []()
+	{
+		uint32 Registers[4];
+
+		VlcMediaColorConverter::CpuId(0, 0, Registers);
+		const uint32 MaxLeaf = Registers[0];
+
+		VlcMediaColorConverter::CpuId(1, 0, Registers);
+		const bool HasSse2 = (Registers[3] & (1 << 26)) != 0;
+		const bool HasSsse3 = (Registers[2] & (1 << 9)) != 0;
+		const bool HasOsxsave = (Registers[2] & (1 << 27)) != 0;
+		const bool HasAvx = (Registers[2] & (1 << 28)) != 0;
+
+		if (HasAvx && HasOsxsave && (MaxLeaf >= 7))
+		{
+			// the operating system must preserve the XMM and YMM registers
+			const bool HasAvxState = ((VlcMediaColorConverter::GetXcr0() & 0x6) == 0x6);
+
+			VlcMediaColorConverter::CpuId(7, 0, Registers);
+
+			if (HasAvxState && ((Registers[1] & (1 << 5)) != 0))
+			{
+				return EVlcMediaSimdLevel::Avx2;
+			}
+		}
+
+		if (HasSsse3)
+		{
+			return EVlcMediaSimdLevel::Ssse3;
+		}
+
+		return HasSse2 ? EVlcMediaSimdLevel::Sse2 : EVlcMediaSimdLevel::Scalar;
+	}();
+
+	return SupportedLevel;
+#else
+	return EVlcMediaSimdLevel::Scalar;
+#endif
+}
@@ -0,0 +1,123 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#pragma once
+
+
+/**
+ * Enumerates instruction set extensions used by the color converter.
+ */
+enum class EVlcMediaSimdLevel : uint8
+{
+	/** Portable scalar code. */
+	Scalar,
+
+	/** SSE2 instructions. */
+	Sse2,
+
+	/** SSSE3 instructions. */
+	Ssse3,
+
+	/** AVX2 instructions. */
+	Avx2
+};
+
+
+/**
+ * Fixed point YUV to RGB conversion coefficients (13 fractional bits).
+ */
+struct FVlcMediaColorCoefficients
+{
+	/** Luma offset (16 for limited range, 0 for full range). */
+	int16 YOffset;
+
+	/** Luma scale. */
+	int16 Y;
+
+	/** Red contribution of V. */
+	int16 RV;
+
+	/** Green contribution of U. */
+	int16 GU;
+
+	/** Green contribution of V. */
+	int16 GV;
+
+	/** Blue contribution of U. */
+	int16 BU;
+};
+
+
+/**
+ * Converts planar and semi-planar YUV 4:2:0 video frames to 32-bit BGRA.
+ *
+ * The fastest available implementation is selected at run-time based on the
+ * features of the CPU. All implementations use the same fixed point math and
+ * produce bit identical results to the scalar reference implementation.
+ */
+class FVlcMediaColorConverter
+{
+public:
+
+	/** Default constructor (BT.601, limited range, fastest available code path). */
+	FVlcMediaColorConverter();
+
+public:
+
+	/**
+	 * Convert a video frame to BGRA.
+	 *
+	 * @param Layout The memory layout of the source frame (must be I420 or NV12).
+	 * @param Source The source frame buffer.
+	 * @param Dest The buffer to write BGRA pixels to.
+	 * @param DestPitch Distance between two rows in the destination buffer (in bytes).
+	 * @return true on success, false if the source chroma is not supported.
+	 */
+	bool Convert(const FVlcMediaVideoLayout& Layout, const uint8* Source, uint8* Dest, uint32 DestPitch) const;
+
+	/**
+	 * Get the instruction set extensions used by this converter.
+	 *
+	 * @return SIMD level.
+	 * @see SetSimdLevel
+	 */
+	EVlcMediaSimdLevel GetSimdLevel() const
+	{
+		return SimdLevel;
+	}
+
+	/**
+	 * Set the color matrix and value range of the source video.
+	 *
+	 * @param Matrix The color matrix.
+	 * @param Range The value range.
+	 */
+	void SetColorSpace(EVlcMediaColorMatrix Matrix, EVlcMediaColorRange Range);
+
+	/**
+	 * Set the instruction set extensions to use.
+	 *
+	 * The level is clamped to what the CPU supports. Lower levels are mostly useful for
+	 * validating the optimized code paths against the scalar reference implementation.
+	 *
+	 * @param Level The desired SIMD level.
+	 * @see GetSimdLevel
+	 */
+	void SetSimdLevel(EVlcMediaSimdLevel Level);
+
+public:
+
+	/**
+	 * Get the highest SIMD level supported by the CPU and operating system.
+	 *
+	 * @return SIMD level.
+	 */
+	static EVlcMediaSimdLevel GetSupportedSimdLevel();
+
+private:
+
+	/** The conversion coefficients. */
+	FVlcMediaColorCoefficients Coefficients;
+
+	/** The SIMD level in use. */
+	EVlcMediaSimdLevel SimdLevel;
+};
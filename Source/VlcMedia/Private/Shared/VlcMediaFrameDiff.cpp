@@ -0,0 +1,173 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+#include "VlcMediaSimd.h"
+
+
+namespace VlcMediaFrameDiff
+{
+	/**
+	 * Describes how a plane's samples map to pixels.
+	 */
+	struct FPlaneGeometry
+	{
+		/** Number of bytes per sample. */
+		uint32 BytesPerSample;
+
+		/** Horizontal subsampling (as a shift). */
+		uint32 HorizontalShift;
+
+		/** Vertical subsampling (as a shift). */
+		uint32 VerticalShift;
+	};
+
+	/**
+	 * Get the geometry of a plane.
+	 *
+	 * @param Chroma The pixel format.
+	 * @param PlaneIndex The index of the plane.
+	 * @return Plane geometry.
+	 */
+	FPlaneGeometry GetPlaneGeometry(EVlcMediaVideoChroma Chroma, int32 PlaneIndex)
+	{
+		FPlaneGeometry Geometry = { 1, 0, 0 };
+
+		if (Chroma == EVlcMediaVideoChroma::Rv32)
+		{
+			Geometry.BytesPerSample = 4;
+		}
+		else if (PlaneIndex > 0)
+		{
+			// NV12 stores U and V interleaved in a single plane
+			Geometry.BytesPerSample = (Chroma == EVlcMediaVideoChroma::Nv12) ? 2 : 1;
+			Geometry.HorizontalShift = 1;
+			Geometry.VerticalShift = 1;
+		}
+
+		return Geometry;
+	}
+}
+
+
+/* FVlcMediaFrameDiff interface
+ *****************************************************************************/
+
+int32 FVlcMediaFrameDiff::Compare(const FVlcMediaVideoLayout& Layout, const uint8* Current, const uint8* Previous, bool StopAtFirstChange, TArray<FIntRect>& OutDirtyRects, int32& OutNumTiles)
+{
+	OutDirtyRects.Reset();
+
+	const int32 NumTilesX = FMath::DivideAndRoundUp(Layout.Dimensions.X, TileSize);
+	const int32 NumTilesY = FMath::DivideAndRoundUp(Layout.Dimensions.Y, TileSize);
+	int32 NumDirtyTiles = 0;
+
+	OutNumTiles = NumTilesX * NumTilesY;
+
+	for (int32 TileY = 0; TileY < NumTilesY; ++TileY)
+	{
+		const int32 Top = TileY * TileSize;
+		const int32 Bottom = FMath::Min(Top + TileSize, Layout.Dimensions.Y);
+
+		for (int32 TileX = 0; TileX < NumTilesX; ++TileX)
+		{
+			const int32 Left = TileX * TileSize;
+			const FIntRect Tile(Left, Top, FMath::Min(Left + TileSize, Layout.Dimensions.X), Bottom);
+
+			if (IsTileEqual(Layout, Current, Previous, Tile))
+			{
+				continue;
+			}
+
+			++NumDirtyTiles;
+
+			if (StopAtFirstChange)
+			{
+				return NumDirtyTiles;
+			}
+
+			// extend the previous rectangle if the tiles are adjacent
+			FIntRect* LastRect = (OutDirtyRects.Num() > 0) ? &OutDirtyRects.Last() : nullptr;
+
+			if ((LastRect != nullptr) && (LastRect->Min.Y == Top) && (LastRect->Max.X == Left))
+			{
+				LastRect->Max.X = Tile.Max.X;
+			}
+			else
+			{
+				OutDirtyRects.Add(Tile);
+			}
+		}
+	}
+
+	return NumDirtyTiles;
+}
+
+
+/* FVlcMediaFrameDiff implementation
+ *****************************************************************************/
+
+bool FVlcMediaFrameDiff::IsTileEqual(const FVlcMediaVideoLayout& Layout, const uint8* Current, const uint8* Previous, const FIntRect& Tile)
+{
+	for (int32 PlaneIndex = 0; PlaneIndex < Layout.NumPlanes; ++PlaneIndex)
+	{
+		const FVlcMediaVideoPlane& Plane = Layout.Planes[PlaneIndex];
+		const VlcMediaFrameDiff::FPlaneGeometry Geometry = VlcMediaFrameDiff::GetPlaneGeometry(Layout.Chroma, PlaneIndex);
+
+		// round outwards, so that odd sized frames include their last chroma sample
+		const uint32 HorizontalRound = (1 << Geometry.HorizontalShift) - 1;
+		const uint32 VerticalRound = (1 << Geometry.VerticalShift) - 1;
+
+		const uint32 FirstByte = (Tile.Min.X >> Geometry.HorizontalShift) * Geometry.BytesPerSample;
+		const uint32 EndByte = ((Tile.Max.X + HorizontalRound) >> Geometry.HorizontalShift) * Geometry.BytesPerSample;
+		const uint32 FirstRow = Tile.Min.Y >> Geometry.VerticalShift;
+		const uint32 EndRow = FMath::Min((uint32)(Tile.Max.Y + VerticalRound) >> Geometry.VerticalShift, Plane.Lines);
+
+		for (uint32 Row = FirstRow; Row < EndRow; ++Row)
+		{
+			const uint32 Offset = Plane.Offset + Row * Plane.Pitch + FirstByte;
+
+			if (!IsRangeEqual(Current + Offset, Previous + Offset, EndByte - FirstByte))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+bool FVlcMediaFrameDiff::IsRangeEqual(const uint8* A, const uint8* B, uint32 Length)
+{
+	uint32 Offset = 0;
+
+#if VLCMEDIA_X86
+	const __m128i Zero = _mm_setzero_si128();
+
+	// SSE2 is always available on the platforms we support, so no run-time check is needed
+	for (; Offset + 64 <= Length; Offset += 64)
+	{
+		const __m128i Difference0 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(A + Offset)), _mm_loadu_si128((const __m128i*)(B + Offset)));
+		const __m128i Difference1 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(A + Offset + 16)), _mm_loadu_si128((const __m128i*)(B + Offset + 16)));
+		const __m128i Difference2 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(A + Offset + 32)), _mm_loadu_si128((const __m128i*)(B + Offset + 32)));
+		const __m128i Difference3 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(A + Offset + 48)), _mm_loadu_si128((const __m128i*)(B + Offset + 48)));
+		const __m128i Difference = _mm_or_si128(_mm_or_si128(Difference0, Difference1), _mm_or_si128(Difference2, Difference3));
+
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(Difference, Zero)) != 0xffff)
+		{
+			return false;
+		}
+	}
+
+	for (; Offset + 16 <= Length; Offset += 16)
+	{
+		const __m128i Difference = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(A + Offset)), _mm_loadu_si128((const __m128i*)(B + Offset)));
+
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(Difference, Zero)) != 0xffff)
+		{
+			return false;
+		}
+	}
+#endif
+
+	return (FMemory::Memcmp(A + Offset, B + Offset, Length - Offset) == 0);
+}
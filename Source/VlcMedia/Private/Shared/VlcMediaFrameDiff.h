@@ -0,0 +1,55 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#pragma once
+
+
+/**
+ * Detects changes between consecutive video frames.
+ *
+ * Frames are compared tile by tile across all planes. Comparisons are exact (there
+ * are no hash collisions) and stop at the first difference in each tile, so unchanged
+ * regions cost one read of both frames, and changed regions usually cost much less.
+ */
+class FVlcMediaFrameDiff
+{
+public:
+
+	/** Width and height of the tiles that frames are compared in (in pixels). */
+	static const int32 TileSize = 64;
+
+	/**
+	 * Compare two frames.
+	 *
+	 * @param Layout The memory layout of both frames.
+	 * @param Current The current frame.
+	 * @param Previous The previous frame.
+	 * @param StopAtFirstChange Whether to stop comparing as soon as a changed tile was found.
+	 * @param OutDirtyRects Will contain the changed regions (in pixels), one per run of adjacent changed tiles in a row.
+	 * @param OutNumTiles Will contain the total number of tiles in a frame.
+	 * @return The number of changed tiles.
+	 */
+	static int32 Compare(const FVlcMediaVideoLayout& Layout, const uint8* Current, const uint8* Previous, bool StopAtFirstChange, TArray<FIntRect>& OutDirtyRects, int32& OutNumTiles);
+
+protected:
+
+	/**
+	 * Check whether a tile is identical in two frames.
+	 *
+	 * @param Layout The memory layout of both frames.
+	 * @param Current The current frame.
+	 * @param Previous The previous frame.
+	 * @param Tile The tile's region (in pixels).
+	 * @return true if the tile did not change, false otherwise.
+	 */
+	static bool IsTileEqual(const FVlcMediaVideoLayout& Layout, const uint8* Current, const uint8* Previous, const FIntRect& Tile);
+
+	/**
+	 * Check whether two byte ranges are identical.
+	 *
+	 * @param A The first range.
+	 * @param B The second range.
+	 * @param Length The number of bytes to compare.
+	 * @return true if the ranges are identical, false otherwise.
+	 */
+	static bool IsRangeEqual(const uint8* A, const uint8* B, uint32 Length);
+};
@@ -0,0 +1,44 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+
+
+/* FVlcMediaLoopDetector structors
+ *****************************************************************************/
+
+FVlcMediaLoopDetector::FVlcMediaLoopDetector()
+	: LastReportedTime(0)
+	, LastReportTime(0.0)
+{ }
+
+
+/* FVlcMediaLoopDetector interface
+ *****************************************************************************/
+
+bool FVlcMediaLoopDetector::Detect(int64 NewTime, int64 Length, double ReportTime, double& OutLatency)
+{
+	const int64 LastTime = LastReportedTime;
+	const double LastWallTime = LastReportTime;
+
+	LastReportedTime = NewTime;
+	LastReportTime = ReportTime;
+
+	// a wrap is a jump from near the end of the media back to near its start
+	if ((Length <= 0) || (LastWallTime == 0.0) || (LastTime - NewTime < Length / 2))
+	{
+		return false;
+	}
+
+	// wall time that passed, minus the media time that was played on both sides of the wrap
+	const double PlayedTime = (FMath::Max<int64>(Length - LastTime, 0) + NewTime) / 1000.0;
+	OutLatency = FMath::Max(ReportTime - LastWallTime - PlayedTime, 0.0);
+
+	return true;
+}
+
+
+void FVlcMediaLoopDetector::Reset()
+{
+	LastReportedTime = 0;
+	LastReportTime = 0.0;
+}
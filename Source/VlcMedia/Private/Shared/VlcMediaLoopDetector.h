@@ -0,0 +1,43 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#pragma once
+
+
+/**
+ * Detects when looping playback wraps around from the end of the media to its start.
+ *
+ * libvlc repeats looping media by itself and does not report the transition, so wraps
+ * are inferred from the playback times that it reports. The detector is not thread-safe;
+ * the player feeds it on the game thread with the times at which the reports arrived.
+ */
+class FVlcMediaLoopDetector
+{
+public:
+
+	/** Default constructor. */
+	FVlcMediaLoopDetector();
+
+public:
+
+	/**
+	 * Check whether a reported playback time means that playback wrapped around.
+	 *
+	 * @param NewTime The reported playback time (in milliseconds).
+	 * @param Length The duration of the media (in milliseconds).
+	 * @param ReportTime The platform time at which the playback time was reported (in seconds).
+	 * @param OutLatency Will contain the time that playback stalled in the transition (in seconds, only if playback wrapped around).
+	 * @return true if playback wrapped around, false otherwise.
+	 */
+	bool Detect(int64 NewTime, int64 Length, double ReportTime, double& OutLatency);
+
+	/** Forget the last reported time (i.e. after opening other media). */
+	void Reset();
+
+private:
+
+	/** The last reported playback time (in milliseconds). */
+	int64 LastReportedTime;
+
+	/** The platform time at which the last playback time was reported (in seconds, zero if none was reported). */
+	double LastReportTime;
+};
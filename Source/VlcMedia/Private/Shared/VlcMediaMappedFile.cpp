@@ -0,0 +1,108 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+	#include <windows.h>
+	#include "HideWindowsPlatformTypes.h"
+#elif PLATFORM_LINUX || PLATFORM_MAC
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+
+/* FVlcMediaMappedFile structors
+ *****************************************************************************/
+
+FVlcMediaMappedFile::FVlcMediaMappedFile(const FString& Filename)
+	: Data(nullptr)
+	, Size(0)
+{
+#if PLATFORM_WINDOWS
+	HANDLE File = ::CreateFileW(*Filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (File == INVALID_HANDLE_VALUE)
+	{
+		return;
+	}
+
+	LARGE_INTEGER FileSize;
+
+	// files that do not fit into the address space are not mapped
+	if (!::GetFileSizeEx(File, &FileSize) || (FileSize.QuadPart <= 0) || ((LONGLONG)(SIZE_T)FileSize.QuadPart != FileSize.QuadPart))
+	{
+		::CloseHandle(File);
+
+		return;
+	}
+
+	HANDLE Mapping = ::CreateFileMappingW(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	// the view keeps the mapping and the file open
+	::CloseHandle(File);
+
+	if (Mapping == nullptr)
+	{
+		return;
+	}
+
+	Data = (const uint8*)::MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+	::CloseHandle(Mapping);
+
+	if (Data != nullptr)
+	{
+		Size = (SIZE_T)FileSize.QuadPart;
+	}
+#elif PLATFORM_LINUX || PLATFORM_MAC
+	const int File = ::open(TCHAR_TO_UTF8(*Filename), O_RDONLY);
+
+	if (File == -1)
+	{
+		return;
+	}
+
+	struct stat FileStat;
+
+	// files that do not fit into the address space are not mapped
+	if ((::fstat(File, &FileStat) != 0) || (FileStat.st_size <= 0) || ((off_t)(SIZE_T)FileStat.st_size != FileStat.st_size))
+	{
+		::close(File);
+
+		return;
+	}
+
+	void* Mapping = ::mmap(nullptr, (size_t)FileStat.st_size, PROT_READ, MAP_PRIVATE, File, 0);
+
+	// the mapping keeps the file open
+	::close(File);
+
+	if (Mapping == MAP_FAILED)
+	{
+		return;
+	}
+
+	// demuxers mostly read front to back, so let the kernel read ahead aggressively
+	::madvise(Mapping, (size_t)FileStat.st_size, MADV_SEQUENTIAL);
+
+	Data = (const uint8*)Mapping;
+	Size = (SIZE_T)FileStat.st_size;
+#endif
+}
+
+
+FVlcMediaMappedFile::~FVlcMediaMappedFile()
+{
+	if (Data == nullptr)
+	{
+		return;
+	}
+
+#if PLATFORM_WINDOWS
+	::UnmapViewOfFile(Data);
+#elif PLATFORM_LINUX || PLATFORM_MAC
+	::munmap((void*)Data, Size);
+#endif
+}
@@ -0,0 +1,83 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#pragma once
+
+
+/**
+ * Implements a read-only memory mapping of a local file.
+ *
+ * Media that is played from a mapping is paged in by the operating system as it is read,
+ * so only the working set stays resident, and players that map the same file share the
+ * same physical pages through the file cache.
+ *
+ * The mapping is immutable once created and can be read from any thread.
+ */
+class FVlcMediaMappedFile
+{
+public:
+
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param Filename The path of the file to map.
+	 * @see IsValid
+	 */
+	explicit FVlcMediaMappedFile(const FString& Filename);
+
+	/** Destructor. */
+	~FVlcMediaMappedFile();
+
+public:
+
+	/**
+	 * Get the mapped file contents.
+	 *
+	 * @return The first byte of the file, or nullptr if the file could not be mapped.
+	 * @see GetSize
+	 */
+	const uint8* GetData() const
+	{
+		return Data;
+	}
+
+	/**
+	 * Get the size of the mapped file.
+	 *
+	 * @return File size (in bytes).
+	 * @see GetData
+	 */
+	SIZE_T GetSize() const
+	{
+		return Size;
+	}
+
+	/**
+	 * Check whether the file was mapped successfully.
+	 *
+	 * @return true if the file is mapped, false otherwise.
+	 */
+	bool IsValid() const
+	{
+		return (Data != nullptr);
+	}
+
+private:
+
+	/** The mapped file contents. */
+	const uint8* Data;
+
+	/** The size of the mapped file. */
+	SIZE_T Size;
+
+private:
+
+	/** Hidden copy constructor. */
+	FVlcMediaMappedFile(const FVlcMediaMappedFile&);
+
+	/** Hidden copy assignment operator. */
+	FVlcMediaMappedFile& operator=(const FVlcMediaMappedFile&);
+};
+
+
+/** Type definition for shared pointers to memory-mapped files. */
+typedef TSharedPtr<FVlcMediaMappedFile, ESPMode::ThreadSafe> FVlcMediaMappedFilePtr;
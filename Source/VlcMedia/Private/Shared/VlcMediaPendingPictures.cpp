@@ -0,0 +1,65 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+
+
+/* FVlcMediaPendingPictures structors
+ *****************************************************************************/
+
+FVlcMediaPendingPictures::FVlcMediaPendingPictures(int32 InCapacity)
+	: Capacity(InCapacity)
+{
+	Samples.Reserve(InCapacity + 1);
+}
+
+
+/* FVlcMediaPendingPictures interface
+ *****************************************************************************/
+
+void FVlcMediaPendingPictures::Add(FVlcMediaSample* Sample)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	Samples.Add(TRefCountPtr<FVlcMediaSample>(Sample));
+
+	// libvlc cannot hold more pictures than it allocated, so the oldest one was dropped
+	if (Samples.Num() > Capacity)
+	{
+		Samples.RemoveAt(0, 1, false);
+	}
+}
+
+
+int32 FVlcMediaPendingPictures::Num() const
+{
+	FScopeLock Lock(&CriticalSection);
+
+	return Samples.Num();
+}
+
+
+bool FVlcMediaPendingPictures::Remove(void* Picture, TRefCountPtr<FVlcMediaSample>& OutSample)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	for (int32 SampleIndex = 0; SampleIndex < Samples.Num(); ++SampleIndex)
+	{
+		if (Samples[SampleIndex].GetReference() == Picture)
+		{
+			OutSample = Samples[SampleIndex];
+			Samples.RemoveAt(0, SampleIndex + 1, false);
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+void FVlcMediaPendingPictures::Reset()
+{
+	FScopeLock Lock(&CriticalSection);
+
+	Samples.Reset();
+}
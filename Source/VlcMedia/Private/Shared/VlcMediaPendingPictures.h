@@ -0,0 +1,70 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#pragma once
+
+
+/**
+ * Keeps decoded pictures alive between libvlc's unlock and display callbacks.
+ *
+ * libvlc unlocks a picture as soon as it is decoded, and displays it later when it is due.
+ * The sample that holds the picture must not go back to its pool in between, or the next
+ * lock would hand the same buffer to the decoder while it is still waiting to be displayed.
+ * Pictures are displayed in the order in which they were unlocked, so pictures that were
+ * unlocked before a displayed one were dropped by libvlc, and they are released with it.
+ */
+class FVlcMediaPendingPictures
+{
+public:
+
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InCapacity The number of pictures that libvlc may hold at the same time.
+	 */
+	FVlcMediaPendingPictures(int32 InCapacity);
+
+public:
+
+	/**
+	 * Hold a picture that was unlocked by the decoder.
+	 *
+	 * @param Sample The sample that holds the picture.
+	 * @see Remove
+	 */
+	void Add(FVlcMediaSample* Sample);
+
+	/**
+	 * Get the number of pictures that are waiting to be displayed.
+	 *
+	 * @return Number of pictures.
+	 */
+	int32 Num() const;
+
+	/**
+	 * Take a picture that is being displayed, and release the pictures that were dropped before it.
+	 *
+	 * @param Picture The picture that libvlc displays.
+	 * @param OutSample Will hold the pending reference to the picture's sample.
+	 * @return true if the picture was pending, false if it was released already.
+	 * @see Add
+	 */
+	bool Remove(void* Picture, TRefCountPtr<FVlcMediaSample>& OutSample);
+
+	/**
+	 * Release all pending pictures (i.e. when the video output is closed).
+	 *
+	 * @see Add
+	 */
+	void Reset();
+
+private:
+
+	/** The number of pictures that libvlc may hold at the same time. */
+	int32 Capacity;
+
+	/** Critical section for synchronizing access to the pictures. */
+	mutable FCriticalSection CriticalSection;
+
+	/** The pictures that were unlocked but not displayed yet (in unlock order). */
+	TArray<TRefCountPtr<FVlcMediaSample>> Samples;
+};
@@ -0,0 +1,115 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+
+
+namespace VlcMediaPlayerClock
+{
+	/**
+	 * How far the clock may run ahead of the last reported time (in seconds).
+	 *
+	 * libvlc reports the time several times per second while playing. If reports stop
+	 * arriving, i.e. while the input is stalled, the clock stops instead of drifting away.
+	 */
+	const double MaxExtrapolation = 1.0;
+}
+
+
+/* FVlcMediaPlayerClock structors
+ *****************************************************************************/
+
+FVlcMediaPlayerClock::FVlcMediaPlayerClock()
+{
+	Anchor.Rate = 1.0f;
+	Anchor.Running = false;
+	Anchor.Time = FTimespan::Zero();
+	Anchor.WallTime = FPlatformTime::Seconds();
+
+	SharedAnchor.Write(Anchor);
+}
+
+
+/* FVlcMediaPlayerClock interface
+ *****************************************************************************/
+
+FTimespan FVlcMediaPlayerClock::GetTime() const
+{
+	return Interpolate(SharedAnchor.Read(), FPlatformTime::Seconds());
+}
+
+
+void FVlcMediaPlayerClock::Reset(FTimespan Time)
+{
+	FScopeLock Lock(&WriterCriticalSection);
+
+	Anchor.Time = Time;
+	Anchor.WallTime = FPlatformTime::Seconds();
+
+	Publish(Anchor);
+}
+
+
+void FVlcMediaPlayerClock::SetRate(float Rate)
+{
+	FScopeLock Lock(&WriterCriticalSection);
+
+	const double Now = FPlatformTime::Seconds();
+
+	Anchor.Time = Interpolate(Anchor, Now);
+	Anchor.WallTime = Now;
+	Anchor.Rate = Rate;
+
+	Publish(Anchor);
+}
+
+
+void FVlcMediaPlayerClock::SetRunning(bool Running)
+{
+	FScopeLock Lock(&WriterCriticalSection);
+
+	if (Running == Anchor.Running)
+	{
+		return;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+
+	Anchor.Time = Interpolate(Anchor, Now);
+	Anchor.WallTime = Now;
+	Anchor.Running = Running;
+
+	Publish(Anchor);
+}
+
+
+void FVlcMediaPlayerClock::Update(FTimespan Time)
+{
+	FScopeLock Lock(&WriterCriticalSection);
+
+	Anchor.Time = Time;
+	Anchor.WallTime = FPlatformTime::Seconds();
+
+	Publish(Anchor);
+}
+
+
+/* FVlcMediaPlayerClock implementation
+ *****************************************************************************/
+
+FTimespan FVlcMediaPlayerClock::Interpolate(const FAnchor& InAnchor, double Now)
+{
+	if (!InAnchor.Running)
+	{
+		return InAnchor.Time;
+	}
+
+	const double Elapsed = FMath::Clamp(Now - InAnchor.WallTime, 0.0, VlcMediaPlayerClock::MaxExtrapolation);
+
+	return InAnchor.Time + FTimespan::FromSeconds(Elapsed * InAnchor.Rate);
+}
+
+
+void FVlcMediaPlayerClock::Publish(const FAnchor& NewAnchor)
+{
+	SharedAnchor.Write(NewAnchor);
+}
@@ -0,0 +1,108 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#pragma once
+
+#include "VlcMediaSeqLock.h"
+
+
+/**
+ * Implements a high resolution playback clock.
+ *
+ * libvlc only reports the stream time a few times per second. The clock anchors to each
+ * report and interpolates in between using the platform's high resolution timer and the
+ * playback rate, so that samples can be stamped with precise presentation times.
+ * Reading the clock is lock-free and may happen on any thread.
+ */
+class FVlcMediaPlayerClock
+{
+public:
+
+	/** Default constructor. */
+	FVlcMediaPlayerClock();
+
+public:
+
+	/**
+	 * Get the current playback time.
+	 *
+	 * @return Playback time.
+	 */
+	FTimespan GetTime() const;
+
+	/**
+	 * Reset the clock to the given time (i.e. after opening, seeking or stopping).
+	 *
+	 * @param Time The time to reset to.
+	 */
+	void Reset(FTimespan Time);
+
+	/**
+	 * Set the playback rate.
+	 *
+	 * @param Rate The rate to set.
+	 */
+	void SetRate(float Rate);
+
+	/**
+	 * Start or stop the clock.
+	 *
+	 * @param Running Whether the clock is running.
+	 */
+	void SetRunning(bool Running);
+
+	/**
+	 * Anchor the clock to a stream time reported by libvlc.
+	 *
+	 * @param Time The reported stream time.
+	 */
+	void Update(FTimespan Time);
+
+private:
+
+	/** State of the clock at the last anchor point. */
+	struct FAnchor
+	{
+		/** The playback rate. */
+		float Rate;
+
+		/** Whether the clock is running. */
+		bool Running;
+
+		/** The stream time at the anchor point. */
+		FTimespan Time;
+
+		/** The platform time at the anchor point (in seconds). */
+		double WallTime;
+	};
+
+	/**
+	 * Calculate the interpolated time for an anchor.
+	 *
+	 * @param InAnchor The anchor.
+	 * @param Now The current platform time (in seconds).
+	 * @return Interpolated time.
+	 */
+	static FTimespan Interpolate(const FAnchor& InAnchor, double Now);
+
+	/**
+	 * Publish a new anchor (must be called with the writer lock held).
+	 *
+	 * @param NewAnchor The anchor to publish.
+	 */
+	void Publish(const FAnchor& NewAnchor);
+
+private:
+
+	/** The current anchor (writer's copy). */
+	FAnchor Anchor;
+
+	/** The current anchor (readers' copy). */
+	TVlcMediaSeqLock<FAnchor> SharedAnchor;
+
+	/** Critical section for serializing writers. */
+	FCriticalSection WriterCriticalSection;
+};
+
+
+/** Type definition for shared references to player clocks. */
+typedef TSharedRef<FVlcMediaPlayerClock, ESPMode::ThreadSafe> FVlcMediaPlayerClockRef;
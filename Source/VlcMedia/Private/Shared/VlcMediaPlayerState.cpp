@@ -0,0 +1,165 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+
+
+/* FVlcMediaPlayerState structors
+ *****************************************************************************/
+
+FVlcMediaPlayerState::FVlcMediaPlayerState()
+{
+	Reset();
+}
+
+
+/* FVlcMediaPlayerState interface
+ *****************************************************************************/
+
+int32 FVlcMediaPlayerState::GetSelectedTrack(ELibvlcTrackType Type) const
+{
+	const int32 TypeIndex = (int32)Type;
+
+	if ((TypeIndex < 0) || (TypeIndex >= ARRAY_COUNT(Snapshot.SelectedTracks)))
+	{
+		return -1;
+	}
+
+	return SharedSnapshot.Read().SelectedTracks[TypeIndex];
+}
+
+
+void FVlcMediaPlayerState::HandleEvent(const FLibvlcEvent& Event)
+{
+	FScopeLock Lock(&WriterCriticalSection);
+
+	switch (Event.Type)
+	{
+	case ELibvlcEventType::MediaPlayerEncounteredError:
+		Snapshot.State = ELibvlcState::Error;
+		break;
+
+	case ELibvlcEventType::MediaPlayerEndReached:
+		Snapshot.State = ELibvlcState::Ended;
+		break;
+
+	case ELibvlcEventType::MediaPlayerESSelected:
+		{
+			const int32 TypeIndex = (int32)Event.Descriptor.MediaPlayerESChanged.Type;
+
+			if ((TypeIndex < 0) || (TypeIndex >= ARRAY_COUNT(Snapshot.SelectedTracks)))
+			{
+				return;
+			}
+
+			Snapshot.SelectedTracks[TypeIndex] = Event.Descriptor.MediaPlayerESChanged.Id;
+		}
+		break;
+
+	case ELibvlcEventType::MediaPlayerLengthChanged:
+		Snapshot.Length = Event.Descriptor.MediaPlayerLengthChanged.NewLength;
+		break;
+
+	case ELibvlcEventType::MediaPlayerNothingSpecial:
+		Snapshot.State = ELibvlcState::NothingSpecial;
+		break;
+
+	case ELibvlcEventType::MediaPlayerOpening:
+		Snapshot.State = ELibvlcState::Opening;
+		break;
+
+	case ELibvlcEventType::MediaPlayerPaused:
+		Snapshot.State = ELibvlcState::Paused;
+		break;
+
+	case ELibvlcEventType::MediaPlayerPlaying:
+		Snapshot.State = ELibvlcState::Playing;
+		break;
+
+	case ELibvlcEventType::MediaPlayerSeekableChanged:
+		Snapshot.Seekable = (Event.Descriptor.MediaPlayerSeekableChanged.new_seekable != 0);
+		break;
+
+	case ELibvlcEventType::MediaPlayerStopped:
+		Snapshot.State = ELibvlcState::Stopped;
+		break;
+
+	default:
+		return;
+	}
+
+	Publish();
+}
+
+
+void FVlcMediaPlayerState::Reset()
+{
+	FScopeLock Lock(&WriterCriticalSection);
+
+	Snapshot.Length = 0;
+	Snapshot.Rate = 1.0f;
+	Snapshot.Seekable = false;
+	Snapshot.State = ELibvlcState::NothingSpecial;
+
+	for (int32& SelectedTrack : Snapshot.SelectedTracks)
+	{
+		SelectedTrack = -1;
+	}
+
+	Publish();
+}
+
+
+void FVlcMediaPlayerState::SetLength(int64 Length)
+{
+	FScopeLock Lock(&WriterCriticalSection);
+
+	Snapshot.Length = Length;
+
+	Publish();
+}
+
+
+void FVlcMediaPlayerState::SetRate(float Rate)
+{
+	FScopeLock Lock(&WriterCriticalSection);
+
+	Snapshot.Rate = Rate;
+
+	Publish();
+}
+
+
+void FVlcMediaPlayerState::SetSelectedTrack(ELibvlcTrackType Type, int32 Id)
+{
+	const int32 TypeIndex = (int32)Type;
+
+	if ((TypeIndex < 0) || (TypeIndex >= ARRAY_COUNT(Snapshot.SelectedTracks)))
+	{
+		return;
+	}
+
+	FScopeLock Lock(&WriterCriticalSection);
+
+	Snapshot.SelectedTracks[TypeIndex] = Id;
+
+	Publish();
+}
+
+
+void FVlcMediaPlayerState::SetSeekable(bool Seekable)
+{
+	FScopeLock Lock(&WriterCriticalSection);
+
+	Snapshot.Seekable = Seekable;
+
+	Publish();
+}
+
+
+/* FVlcMediaPlayerState implementation
+ *****************************************************************************/
+
+void FVlcMediaPlayerState::Publish()
+{
+	SharedSnapshot.Write(Snapshot);
+}
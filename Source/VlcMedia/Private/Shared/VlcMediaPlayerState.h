@@ -0,0 +1,124 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#pragma once
+
+#include "VlcMediaSeqLock.h"
+
+
+/**
+ * Snapshot of a media player's state.
+ */
+struct FVlcMediaPlayerSnapshot
+{
+	/** The length of the media (in milliseconds). */
+	int64 Length;
+
+	/** The playback rate. */
+	float Rate;
+
+	/** Whether the media is seekable. */
+	bool Seekable;
+
+	/** Identifiers of the selected tracks (indexed by ELibvlcTrackType, -1 for none). */
+	int32 SelectedTracks[3];
+
+	/** The player state. */
+	ELibvlcState State;
+};
+
+
+/**
+ * Caches the state of a libvlc media player.
+ *
+ * Querying libvlc takes its internal locks, so the state is instead updated from
+ * libvlc's events as they arrive and published as a snapshot. Reading the state is
+ * lock-free and may happen on any thread.
+ */
+class FVlcMediaPlayerState
+{
+public:
+
+	/** Default constructor. */
+	FVlcMediaPlayerState();
+
+public:
+
+	/**
+	 * Get the identifier of the selected track of the given type.
+	 *
+	 * @param Type The track type.
+	 * @return Track identifier, or -1 if no track is selected.
+	 */
+	int32 GetSelectedTrack(ELibvlcTrackType Type) const;
+
+	/**
+	 * Get a consistent copy of the whole state.
+	 *
+	 * @return The snapshot.
+	 */
+	FVlcMediaPlayerSnapshot GetSnapshot() const
+	{
+		return SharedSnapshot.Read();
+	}
+
+	/**
+	 * Update the state from a libvlc event.
+	 *
+	 * @param Event The event.
+	 */
+	void HandleEvent(const FLibvlcEvent& Event);
+
+	/** Reset to the state of a player without media. */
+	void Reset();
+
+	/**
+	 * Set the length of the media.
+	 *
+	 * @param Length The length to set (in milliseconds).
+	 */
+	void SetLength(int64 Length);
+
+	/**
+	 * Set the playback rate.
+	 *
+	 * @param Rate The rate to set.
+	 */
+	void SetRate(float Rate);
+
+	/**
+	 * Set the selected track of the given type.
+	 *
+	 * @param Type The track type.
+	 * @param Id The track identifier, or -1 for none.
+	 */
+	void SetSelectedTrack(ELibvlcTrackType Type, int32 Id);
+
+	/**
+	 * Set whether the media is seekable.
+	 *
+	 * @param Seekable Whether the media is seekable.
+	 */
+	void SetSeekable(bool Seekable);
+
+private:
+
+	/**
+	 * Publish the state (must be called with the writer lock held).
+	 */
+	void Publish();
+
+private:
+
+	/** The current state (writer's copy). */
+	FVlcMediaPlayerSnapshot Snapshot;
+
+	/** The current state (readers' copy). */
+	TVlcMediaSeqLock<FVlcMediaPlayerSnapshot> SharedSnapshot;
+
+	/** Critical section for serializing writers. */
+	FCriticalSection WriterCriticalSection;
+};
+
+
+/** Type definition for shared references to player states. */
+typedef TSharedRef<FVlcMediaPlayerState, ESPMode::ThreadSafe> FVlcMediaPlayerStateRef;
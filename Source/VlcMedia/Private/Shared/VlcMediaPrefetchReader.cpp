@@ -0,0 +1,322 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+
+
+/* FVlcMediaPrefetchReader structors
+ *****************************************************************************/
+
+FVlcMediaPrefetchReader::FVlcMediaPrefetchReader(uint64 InSize, const FVlcMediaPrefetchOptions& InOptions)
+	: FetchedEvent(FPlatformProcess::GetSynchEventFromPool(false))
+	, LastPosition(0)
+	, Options(InOptions)
+	, ReadBlockIndex(0)
+	, SequentialBytes(InOptions.BlockSize)
+	, Size(InSize)
+	, Stopping(false)
+	, Thread(nullptr)
+	, WorkEvent(FPlatformProcess::GetSynchEventFromPool(false))
+{
+	check(Options.BlockSize > 0);
+
+	// one block is being read while the next one is fetched
+	Options.NumBlocks = FMath::Max(Options.NumBlocks, 2u);
+	NumMediaBlocks = (int64)((Size + Options.BlockSize - 1) / Options.BlockSize);
+
+	Slots.SetNum(Options.NumBlocks);
+
+	for (FSlot& Slot : Slots)
+	{
+		Slot.BlockIndex = INDEX_NONE;
+		Slot.Data.AddUninitialized(Options.BlockSize);
+		Slot.State = ESlotState::Empty;
+	}
+}
+
+
+FVlcMediaPrefetchReader::~FVlcMediaPrefetchReader()
+{
+	// derived classes must shut down before their ReadBlock implementation goes away
+	check(Thread == nullptr);
+
+	FPlatformProcess::ReturnSynchEventToPool(FetchedEvent);
+	FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+}
+
+
+/* FVlcMediaPrefetchReader interface
+ *****************************************************************************/
+
+FVlcMediaPrefetchStats FVlcMediaPrefetchReader::GetStats() const
+{
+	FVlcMediaPrefetchStats Result;
+	{
+		FScopeLock Lock(&CriticalSection);
+		Result = Stats;
+	}
+
+	if (Result.FetchTime > 0.0)
+	{
+		Result.Throughput = Result.NumBytesFetched / Result.FetchTime;
+	}
+
+	return Result;
+}
+
+
+SSIZE_T FVlcMediaPrefetchReader::Read(SIZE_T& Position, void* OutBuffer, SIZE_T Length)
+{
+	if ((uint64)Position >= Size)
+	{
+		return 0;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	const int64 BlockIndex = (int64)(Position / Options.BlockSize);
+	bool Missed = false;
+
+	FScopeLock Lock(&CriticalSection);
+
+	// reads that do not continue the previous one shrink the read-ahead window until enough data was read sequentially again
+	if (Position != LastPosition)
+	{
+		++Stats.NumRandomAccesses;
+		SequentialBytes = 0;
+	}
+
+	if (ReadBlockIndex != BlockIndex)
+	{
+		ReadBlockIndex = BlockIndex;
+		WorkEvent->Trigger();
+	}
+
+	while (true)
+	{
+		if (Stopping)
+		{
+			return -1;
+		}
+
+		const int32 SlotIndex = FindSlot(BlockIndex);
+
+		if (SlotIndex != INDEX_NONE)
+		{
+			FSlot& Slot = Slots[SlotIndex];
+
+			if (Slot.State == ESlotState::Ready)
+			{
+				const SIZE_T BlockOffset = Position - (SIZE_T)(BlockIndex * Options.BlockSize);
+				const SIZE_T BlockBytes = (SIZE_T)FMath::Min<uint64>(Options.BlockSize, Size - BlockIndex * Options.BlockSize);
+				const SIZE_T BytesToRead = FMath::Min(Length, BlockBytes - BlockOffset);
+
+				FMemory::Memcpy(OutBuffer, Slot.Data.GetData() + BlockOffset, BytesToRead);
+
+				Position += BytesToRead;
+				LastPosition = Position;
+				SequentialBytes += BytesToRead;
+
+				if (Missed)
+				{
+					++Stats.NumCacheMisses;
+					Stats.StallTime += FPlatformTime::Seconds() - StartTime;
+				}
+				else
+				{
+					++Stats.NumCacheHits;
+				}
+
+				// reading past the end of a block moves the window
+				WorkEvent->Trigger();
+
+				return (SSIZE_T)BytesToRead;
+			}
+
+			if (Slot.State == ESlotState::Failed)
+			{
+				// the next read of this block tries again
+				Slot.State = ESlotState::Empty;
+				Slot.BlockIndex = INDEX_NONE;
+
+				return -1;
+			}
+		}
+
+		Missed = true;
+
+		// the worker needs the lock to pick up the block
+		CriticalSection.Unlock();
+		WorkEvent->Trigger();
+		FetchedEvent->Wait(100);
+		CriticalSection.Lock();
+	}
+}
+
+
+void FVlcMediaPrefetchReader::Start()
+{
+	check(Thread == nullptr);
+
+	Thread = FRunnableThread::Create(this, TEXT("VlcMediaPrefetchReader"), 0, TPri_Normal);
+}
+
+
+void FVlcMediaPrefetchReader::Shutdown()
+{
+	Stopping = true;
+
+	if (Thread != nullptr)
+	{
+		WorkEvent->Trigger();
+		Thread->WaitForCompletion();
+
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	FetchedEvent->Trigger();
+}
+
+
+/* FRunnable interface
+ *****************************************************************************/
+
+uint32 FVlcMediaPrefetchReader::Run()
+{
+	while (!Stopping)
+	{
+		int64 BlockIndex = INDEX_NONE;
+		int32 SlotIndex = INDEX_NONE;
+		{
+			FScopeLock Lock(&CriticalSection);
+			SlotIndex = PickSlot(BlockIndex);
+		}
+
+		if (SlotIndex == INDEX_NONE)
+		{
+			WorkEvent->Wait(100);
+
+			continue;
+		}
+
+		// the slot is neither read nor reused while it is being fetched, so it can be filled without the lock
+		FSlot& Slot = Slots[SlotIndex];
+
+		const uint64 Offset = (uint64)BlockIndex * Options.BlockSize;
+		const uint32 BytesToFetch = (uint32)FMath::Min<uint64>(Options.BlockSize, Size - Offset);
+		const double StartTime = FPlatformTime::Seconds();
+		const bool Fetched = ReadBlock(Offset, Slot.Data.GetData(), BytesToFetch);
+		const double FetchTime = FPlatformTime::Seconds() - StartTime;
+		{
+			FScopeLock Lock(&CriticalSection);
+
+			Slot.State = Fetched ? ESlotState::Ready : ESlotState::Failed;
+
+			if (Fetched)
+			{
+				Stats.FetchTime += FetchTime;
+				Stats.NumBytesFetched += BytesToFetch;
+			}
+		}
+
+		FetchedEvent->Trigger();
+	}
+
+	return 0;
+}
+
+
+void FVlcMediaPrefetchReader::Stop()
+{
+	Stopping = true;
+	WorkEvent->Trigger();
+	FetchedEvent->Trigger();
+}
+
+
+/* FVlcMediaPrefetchReader implementation
+ *****************************************************************************/
+
+int32 FVlcMediaPrefetchReader::FindSlot(int64 BlockIndex) const
+{
+	for (int32 SlotIndex = 0; SlotIndex < Slots.Num(); ++SlotIndex)
+	{
+		if ((Slots[SlotIndex].BlockIndex == BlockIndex) && (Slots[SlotIndex].State != ESlotState::Empty))
+		{
+			return SlotIndex;
+		}
+	}
+
+	return INDEX_NONE;
+}
+
+
+int32 FVlcMediaPrefetchReader::PickSlot(int64& OutBlockIndex)
+{
+	const int64 CacheEnd = ReadBlockIndex + Options.NumBlocks;
+	const int64 WindowEnd = FMath::Min((SequentialBytes >= Options.BlockSize) ? CacheEnd : ReadBlockIndex + 2, NumMediaBlocks);
+
+	for (int64 BlockIndex = ReadBlockIndex; BlockIndex < WindowEnd; ++BlockIndex)
+	{
+		if (FindSlot(BlockIndex) != INDEX_NONE)
+		{
+			continue;
+		}
+
+		// reuse an empty slot, or one that holds a block outside of the cache range
+		int32 FreeSlotIndex = INDEX_NONE;
+
+		for (int32 SlotIndex = 0; SlotIndex < Slots.Num(); ++SlotIndex)
+		{
+			const FSlot& Slot = Slots[SlotIndex];
+
+			if (Slot.State == ESlotState::Empty)
+			{
+				FreeSlotIndex = SlotIndex;
+
+				break;
+			}
+
+			if ((Slot.State != ESlotState::Fetching) && ((Slot.BlockIndex < ReadBlockIndex) || (Slot.BlockIndex >= CacheEnd)))
+			{
+				FreeSlotIndex = SlotIndex;
+			}
+		}
+
+		if (FreeSlotIndex == INDEX_NONE)
+		{
+			return INDEX_NONE;
+		}
+
+		FSlot& FreeSlot = Slots[FreeSlotIndex];
+		{
+			FreeSlot.BlockIndex = BlockIndex;
+			FreeSlot.State = ESlotState::Fetching;
+		}
+
+		OutBlockIndex = BlockIndex;
+
+		return FreeSlotIndex;
+	}
+
+	return INDEX_NONE;
+}
+
+
+/* FVlcMediaFileHandleReader interface
+ *****************************************************************************/
+
+bool FVlcMediaFileHandleReader::ReadBlock(uint64 Offset, uint8* OutBuffer, uint32 BlockSize)
+{
+	return (FileHandle->Seek((int64)Offset) && FileHandle->Read(OutBuffer, BlockSize));
+}
+
+
+/* FVlcMediaMappedFileReader interface
+ *****************************************************************************/
+
+bool FVlcMediaMappedFileReader::ReadBlock(uint64 Offset, uint8* OutBuffer, uint32 BlockSize)
+{
+	FMemory::Memcpy(OutBuffer, MappedFile->GetData() + Offset, BlockSize);
+
+	return true;
+}
@@ -0,0 +1,284 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#pragma once
+
+
+/**
+ * Reads media from a slow backing store through a block cache that is filled ahead of time.
+ *
+ * libvlc calls the media read callback on its input thread, so every slow read stalls the
+ * demuxer. This reader splits the media into aligned blocks and fetches them on a worker
+ * thread, ahead of the position that libvlc reads from. While reads are sequential, the
+ * whole cache is used as the read-ahead window. Reads that jump elsewhere, such as the
+ * index lookups of some demuxers, switch to fetching only the block that is needed and
+ * the one after it, until reads are sequential again.
+ *
+ * Derived classes implement the backing store.
+ */
+class FVlcMediaPrefetchReader
+	: public FRunnable
+{
+public:
+
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InSize The size of the media (in bytes).
+	 * @param InOptions The cache options (the block size must not be zero).
+	 */
+	FVlcMediaPrefetchReader(uint64 InSize, const FVlcMediaPrefetchOptions& InOptions);
+
+	/** Virtual destructor. */
+	virtual ~FVlcMediaPrefetchReader();
+
+public:
+
+	/**
+	 * Get the size of the media.
+	 *
+	 * @return Size (in bytes).
+	 */
+	uint64 GetSize() const
+	{
+		return Size;
+	}
+
+	/**
+	 * Get the read statistics.
+	 *
+	 * @return Statistics.
+	 */
+	FVlcMediaPrefetchStats GetStats() const;
+
+	/**
+	 * Copy media data, waiting for it to be fetched if necessary (called on libvlc's input thread).
+	 *
+	 * @param Position The position to read from (will be advanced by the number of bytes read).
+	 * @param OutBuffer Will contain the data.
+	 * @param Length The maximum number of bytes to read.
+	 * @return The number of bytes read, zero at the end of the media, or -1 on failure or shutdown.
+	 */
+	SSIZE_T Read(SIZE_T& Position, void* OutBuffer, SIZE_T Length);
+
+	/**
+	 * Start the worker thread.
+	 *
+	 * @see Shutdown
+	 */
+	void Start();
+
+	/**
+	 * Stop the worker thread and fail all pending reads.
+	 *
+	 * It is safe to call this more than once, and it must be called before a derived
+	 * class is destroyed.
+	 *
+	 * @see Start
+	 */
+	void Shutdown();
+
+public:
+
+	// FRunnable interface
+
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+protected:
+
+	/**
+	 * Read a block from the backing store (called on the worker thread).
+	 *
+	 * @param Offset The offset of the block.
+	 * @param OutBuffer Will contain the data.
+	 * @param BlockSize The number of bytes to read (less than the block size for the last block).
+	 * @return true on success, false otherwise.
+	 */
+	virtual bool ReadBlock(uint64 Offset, uint8* OutBuffer, uint32 BlockSize) = 0;
+
+private:
+
+	/** Enumerates states of cached blocks. */
+	enum class ESlotState : uint8
+	{
+		/** The slot holds no data. */
+		Empty,
+
+		/** The block is being fetched. */
+		Fetching,
+
+		/** The block was fetched. */
+		Ready,
+
+		/** Fetching the block failed. */
+		Failed
+	};
+
+	/** A cached block. */
+	struct FSlot
+	{
+		/** The index of the block in the media. */
+		int64 BlockIndex;
+
+		/** The block data. */
+		TArray<uint8> Data;
+
+		/** The slot's state. */
+		ESlotState State;
+	};
+
+	/**
+	 * Find the slot that holds a block.
+	 *
+	 * @param BlockIndex The index of the block.
+	 * @return Index of the slot, or INDEX_NONE if the block is not cached.
+	 */
+	int32 FindSlot(int64 BlockIndex) const;
+
+	/**
+	 * Choose the next block to fetch and claim a slot for it (called on the worker thread with the lock held).
+	 *
+	 * @param OutBlockIndex Will contain the index of the block to fetch.
+	 * @return Index of the claimed slot, or INDEX_NONE if there is nothing to do.
+	 */
+	int32 PickSlot(int64& OutBlockIndex);
+
+private:
+
+	/** Critical section for synchronizing access to the slots, positions and statistics. */
+	mutable FCriticalSection CriticalSection;
+
+	/** Signaled when a block finished fetching. */
+	FEvent* FetchedEvent;
+
+	/** The position at which the previous read ended. */
+	SIZE_T LastPosition;
+
+	/** The number of blocks in the media. */
+	int64 NumMediaBlocks;
+
+	/** The cache options. */
+	FVlcMediaPrefetchOptions Options;
+
+	/** The index of the block that libvlc reads from. */
+	int64 ReadBlockIndex;
+
+	/** Number of bytes that were read sequentially since the last random access. */
+	uint64 SequentialBytes;
+
+	/** The size of the media. */
+	uint64 Size;
+
+	/** The cached blocks. */
+	TArray<FSlot> Slots;
+
+	/** Read statistics. */
+	FVlcMediaPrefetchStats Stats;
+
+	/** Whether the worker thread should stop. */
+	volatile bool Stopping;
+
+	/** The worker thread. */
+	FRunnableThread* Thread;
+
+	/** Signaled when the worker thread has something to do. */
+	FEvent* WorkEvent;
+
+private:
+
+	/** Hidden copy constructor. */
+	FVlcMediaPrefetchReader(const FVlcMediaPrefetchReader&);
+
+	/** Hidden copy assignment operator. */
+	FVlcMediaPrefetchReader& operator=(const FVlcMediaPrefetchReader&);
+};
+
+
+/**
+ * Reads a file through the engine's file system and the read-ahead cache.
+ *
+ * This also reaches files that are stored in pak files, which cannot be mapped. Only the
+ * worker thread uses the file handle, so the input thread never waits on file I/O for
+ * blocks that were fetched ahead, and only the cache's blocks are held in memory.
+ */
+class FVlcMediaFileHandleReader
+	: public FVlcMediaPrefetchReader
+{
+public:
+
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InFileHandle The handle of the file to read (will be deleted by the reader).
+	 * @param InSize The size of the file (in bytes).
+	 * @param InOptions The cache options.
+	 */
+	FVlcMediaFileHandleReader(IFileHandle* InFileHandle, uint64 InSize, const FVlcMediaPrefetchOptions& InOptions)
+		: FVlcMediaPrefetchReader(InSize, InOptions)
+		, FileHandle(InFileHandle)
+	{ }
+
+	/** Virtual destructor. */
+	virtual ~FVlcMediaFileHandleReader()
+	{
+		Shutdown();
+
+		delete FileHandle;
+	}
+
+protected:
+
+	// FVlcMediaPrefetchReader interface
+
+	virtual bool ReadBlock(uint64 Offset, uint8* OutBuffer, uint32 BlockSize) override;
+
+private:
+
+	/** The file handle (only accessed on the worker thread). */
+	IFileHandle* FileHandle;
+};
+
+
+/**
+ * Reads a memory-mapped file through the read-ahead cache.
+ *
+ * The worker thread takes the page faults, so files on slow drives or network shares
+ * are paged in before libvlc gets to them.
+ */
+class FVlcMediaMappedFileReader
+	: public FVlcMediaPrefetchReader
+{
+public:
+
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InMappedFile The mapped file to read (must be valid).
+	 * @param InOptions The cache options.
+	 */
+	FVlcMediaMappedFileReader(const TSharedRef<FVlcMediaMappedFile, ESPMode::ThreadSafe>& InMappedFile, const FVlcMediaPrefetchOptions& InOptions)
+		: FVlcMediaPrefetchReader(InMappedFile->GetSize(), InOptions)
+		, MappedFile(InMappedFile)
+	{ }
+
+	/** Virtual destructor. */
+	virtual ~FVlcMediaMappedFileReader()
+	{
+		Shutdown();
+	}
+
+protected:
+
+	// FVlcMediaPrefetchReader interface
+
+	virtual bool ReadBlock(uint64 Offset, uint8* OutBuffer, uint32 BlockSize) override;
+
+private:
+
+	/** The mapped file. */
+	TSharedRef<FVlcMediaMappedFile, ESPMode::ThreadSafe> MappedFile;
+};
+
+
+/** Type definition for shared pointers to prefetch readers. */
+typedef TSharedPtr<FVlcMediaPrefetchReader, ESPMode::ThreadSafe> FVlcMediaPrefetchReaderPtr;
@@ -0,0 +1,200 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+
+
+namespace VlcMediaPresentationQueue
+{
+	/**
+	 * How far a sample's presentation time may be from the playback time (in seconds).
+	 *
+	 * Samples beyond this distance belong to the other side of a discontinuity, i.e. a seek.
+	 */
+	const double MaxDistance = 1.0;
+}
+
+
+/* FVlcMediaPresentationQueue structors
+ *****************************************************************************/
+
+FVlcMediaPresentationQueue::FVlcMediaPresentationQueue(int32 InCapacity)
+	: Capacity(FMath::Max(1, InCapacity))
+	, FullFrameNext(false)
+	, HasPresented(false)
+	, LastPresentedDuration(FTimespan::Zero())
+	, LastPresentedTime(FTimespan::Zero())
+	, LastTickTime(FTimespan::Zero())
+{ }
+
+
+/* FVlcMediaPresentationQueue interface
+ *****************************************************************************/
+
+bool FVlcMediaPresentationQueue::Dequeue(FTimespan Time, TRefCountPtr<FVlcMediaSample>& OutSample)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	const FTimespan MaxDistance = FTimespan::FromSeconds(VlcMediaPresentationQueue::MaxDistance);
+	const bool TimeAdvanced = (Time > LastTickTime);
+
+	LastTickTime = Time;
+
+	// samples far in the future were queued before the clock jumped backwards
+	while ((Entries.Num() > 0) && (Entries.Last().Sample->GetTime() > Time + MaxDistance))
+	{
+		Entries.Pop(false);
+		FullFrameNext = true;
+		++Stats.NumDropped;
+	}
+
+	int32 NumDue = 0;
+
+	while ((NumDue < Entries.Num()) && (Entries[NumDue].Sample->GetTime() <= Time))
+	{
+		++NumDue;
+	}
+
+	if (NumDue == 0)
+	{
+		for (FEntry& Entry : Entries)
+		{
+			if (!Entry.HeldBack)
+			{
+				Entry.HeldBack = true;
+				++Stats.NumEarly;
+			}
+		}
+
+		// only count repeats while the clock is running, so that pausing doesn't skew the statistics
+		if (HasPresented && TimeAdvanced && (LastPresentedDuration > FTimespan::Zero()) && (LastPresentedTime + LastPresentedDuration <= Time))
+		{
+			++Stats.NumRepeated;
+		}
+
+		return false;
+	}
+
+	// only the newest due sample can be shown in this tick
+	for (int32 EntryIndex = 0; EntryIndex < NumDue - 1; ++EntryIndex)
+	{
+		MergeDirtyRects(*Entries[EntryIndex].Sample, *Entries[EntryIndex + 1].Sample);
+		++Stats.NumDropped;
+	}
+
+	OutSample = Entries[NumDue - 1].Sample;
+	Entries.RemoveAt(0, NumDue, false);
+
+	const FTimespan Duration = OutSample->GetDuration();
+
+	if ((Duration > FTimespan::Zero()) && (Time - OutSample->GetTime() > Duration))
+	{
+		++Stats.NumLate;
+	}
+
+	HasPresented = true;
+	LastPresentedDuration = Duration;
+	LastPresentedTime = OutSample->GetTime();
+	++Stats.NumPresented;
+
+	return true;
+}
+
+
+void FVlcMediaPresentationQueue::Enqueue(const TRefCountPtr<FVlcMediaSample>& Sample)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	const FTimespan SampleTime = Sample->GetTime();
+
+	if (HasPresented && (SampleTime <= LastPresentedTime))
+	{
+		if (LastPresentedTime - SampleTime <= FTimespan::FromSeconds(VlcMediaPresentationQueue::MaxDistance))
+		{
+			// a newer sample was presented already
+			FullFrameNext = true;
+			++Stats.NumDropped;
+
+			return;
+		}
+
+		// the clock jumped backwards
+		HasPresented = false;
+	}
+
+	if (FullFrameNext)
+	{
+		Sample->SetDirtyRects(TArray<FIntRect>());
+		FullFrameNext = false;
+	}
+
+	int32 InsertIndex = Entries.Num();
+
+	while ((InsertIndex > 0) && (Entries[InsertIndex - 1].Sample->GetTime() > SampleTime))
+	{
+		--InsertIndex;
+	}
+
+	FEntry Entry;
+	{
+		Entry.HeldBack = false;
+		Entry.Sample = Sample;
+	}
+
+	Entries.Insert(Entry, InsertIndex);
+
+	// make room by dropping the oldest sample
+	if (Entries.Num() > Capacity)
+	{
+		MergeDirtyRects(*Entries[0].Sample, *Entries[1].Sample);
+		Entries.RemoveAt(0, 1, false);
+		++Stats.NumDropped;
+	}
+}
+
+
+void FVlcMediaPresentationQueue::Flush()
+{
+	FScopeLock Lock(&CriticalSection);
+
+	Stats.NumDropped += Entries.Num();
+	Entries.Reset();
+
+	FullFrameNext = true;
+	HasPresented = false;
+}
+
+
+FVlcMediaFramePacingStats FVlcMediaPresentationQueue::GetStats() const
+{
+	FScopeLock Lock(&CriticalSection);
+
+	return Stats;
+}
+
+
+/* FVlcMediaPresentationQueue implementation
+ *****************************************************************************/
+
+void FVlcMediaPresentationQueue::MergeDirtyRects(const FVlcMediaSample& Dropped, FVlcMediaSample& Next)
+{
+	const TArray<FIntRect>& NextRects = Next.GetDirtyRects();
+
+	// an empty array means that the entire frame changed
+	if (NextRects.Num() == 0)
+	{
+		return;
+	}
+
+	const TArray<FIntRect>& DroppedRects = Dropped.GetDirtyRects();
+
+	if (DroppedRects.Num() == 0)
+	{
+		Next.SetDirtyRects(TArray<FIntRect>());
+	}
+	else
+	{
+		TArray<FIntRect> MergedRects = NextRects;
+		MergedRects.Append(DroppedRects);
+		Next.SetDirtyRects(MergedRects);
+	}
+}
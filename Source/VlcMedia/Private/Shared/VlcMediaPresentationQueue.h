@@ -0,0 +1,112 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#pragma once
+
+
+/**
+ * Implements a jitter buffer that releases video samples in step with the game tick.
+ *
+ * libvlc displays pictures on its own thread, whose timing is unrelated to the engine's
+ * frame rate. Samples are held in presentation time order until the tick at which they
+ * are due, and at most one sample is released per tick. Samples that were overtaken by a
+ * newer due sample are dropped before they reach any sink.
+ *
+ * Samples are added on libvlc's video output thread and removed by the thread that ticks the track.
+ */
+class FVlcMediaPresentationQueue
+{
+public:
+
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InCapacity The maximum number of samples to hold.
+	 */
+	FVlcMediaPresentationQueue(int32 InCapacity);
+
+public:
+
+	/**
+	 * Get the sample that is due at the given time.
+	 *
+	 * @param Time The current playback time.
+	 * @param OutSample Will contain the sample to present.
+	 * @return true if a sample is due, false if the previous sample remains current.
+	 * @see Enqueue
+	 */
+	bool Dequeue(FTimespan Time, TRefCountPtr<FVlcMediaSample>& OutSample);
+
+	/**
+	 * Add a sample to the queue.
+	 *
+	 * @param Sample The sample to add.
+	 * @see Dequeue, Flush
+	 */
+	void Enqueue(const TRefCountPtr<FVlcMediaSample>& Sample);
+
+	/**
+	 * Discard all queued samples.
+	 *
+	 * @see Enqueue
+	 */
+	void Flush();
+
+	/**
+	 * Get the pacing statistics.
+	 *
+	 * @return Statistics.
+	 */
+	FVlcMediaFramePacingStats GetStats() const;
+
+protected:
+
+	/**
+	 * Merge the changed regions of a dropped sample into the sample that follows it.
+	 *
+	 * Dirty rectangles are relative to the previously delivered sample, so the regions
+	 * that changed in a sample that is never delivered must be carried forward.
+	 *
+	 * @param Dropped The sample that is being dropped.
+	 * @param Next The next sample in presentation order.
+	 */
+	static void MergeDirtyRects(const FVlcMediaSample& Dropped, FVlcMediaSample& Next);
+
+private:
+
+	/** A queued sample. */
+	struct FEntry
+	{
+		/** The sample. */
+		TRefCountPtr<FVlcMediaSample> Sample;
+
+		/** Whether the sample was already held back at a previous tick. */
+		bool HeldBack;
+	};
+
+	/** The maximum number of samples to hold. */
+	int32 Capacity;
+
+	/** Critical section for synchronizing access to the queue and statistics. */
+	mutable FCriticalSection CriticalSection;
+
+	/** The queued samples (sorted by presentation time). */
+	TArray<FEntry> Entries;
+
+	/** Whether the next queued sample must be delivered as a complete frame. */
+	bool FullFrameNext;
+
+	/** Whether a sample was presented since the last flush. */
+	bool HasPresented;
+
+	/** Duration of the most recently presented sample. */
+	FTimespan LastPresentedDuration;
+
+	/** Presentation time of the most recently presented sample. */
+	FTimespan LastPresentedTime;
+
+	/** Playback time at the most recent tick. */
+	FTimespan LastTickTime;
+
+	/** Pacing statistics. */
+	FVlcMediaFramePacingStats Stats;
+};
@@ -0,0 +1,138 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+
+
+/* FVlcMediaRingBuffer structors
+ *****************************************************************************/
+
+FVlcMediaRingBuffer::FVlcMediaRingBuffer(uint32 InCapacity)
+	: Capacity(FMath::RoundUpToPowerOfTwo(FMath::Max(InCapacity, 2u)))
+	, PendingWritePosition(0)
+	, ReadPosition(0)
+	, WritePosition(0)
+	, FlushPosition(0)
+{
+	Buffer = (uint8*)FMemory::Malloc(Capacity, PLATFORM_CACHE_LINE_SIZE);
+}
+
+
+FVlcMediaRingBuffer::~FVlcMediaRingBuffer()
+{
+	FMemory::Free(Buffer);
+}
+
+
+/* FVlcMediaRingBuffer producer interface
+ *****************************************************************************/
+
+void FVlcMediaRingBuffer::Commit()
+{
+	// the data must be visible before the new position
+	FPlatformMisc::MemoryBarrier();
+	WritePosition = (int32)PendingWritePosition;
+}
+
+
+void FVlcMediaRingBuffer::Flush()
+{
+	FPlatformMisc::MemoryBarrier();
+	FlushPosition = WritePosition;
+}
+
+
+uint32 FVlcMediaRingBuffer::GetSpace() const
+{
+	const uint32 Used = PendingWritePosition - (uint32)ReadPosition;
+	FPlatformMisc::MemoryBarrier();
+
+	return Capacity - FMath::Min(Used, Capacity);
+}
+
+
+void FVlcMediaRingBuffer::Write(const void* Data, uint32 Size)
+{
+	check(Size <= GetSpace());
+
+	const uint32 Offset = PendingWritePosition & (Capacity - 1);
+	const uint32 FirstPart = FMath::Min(Size, Capacity - Offset);
+
+	FMemory::Memcpy(Buffer + Offset, Data, FirstPart);
+	FMemory::Memcpy(Buffer, (const uint8*)Data + FirstPart, Size - FirstPart);
+
+	PendingWritePosition += Size;
+}
+
+
+/* FVlcMediaRingBuffer consumer interface
+ *****************************************************************************/
+
+uint32 FVlcMediaRingBuffer::Num()
+{
+	const uint32 Available = (uint32)WritePosition - (uint32)ReadPosition;
+	FPlatformMisc::MemoryBarrier();
+
+	return Available;
+}
+
+
+bool FVlcMediaRingBuffer::Peek(void* OutData, uint32 Size)
+{
+	if (Num() < Size)
+	{
+		return false;
+	}
+
+	CopyFrom((uint32)ReadPosition, OutData, Size);
+
+	return true;
+}
+
+
+bool FVlcMediaRingBuffer::Read(void* OutData, uint32 Size)
+{
+	if (!Peek(OutData, Size))
+	{
+		return false;
+	}
+
+	// the data must be copied before the space is handed back to the producer
+	FPlatformMisc::MemoryBarrier();
+	ReadPosition = (int32)((uint32)ReadPosition + Size);
+
+	return true;
+}
+
+
+void FVlcMediaRingBuffer::SkipAll()
+{
+	const int32 Committed = WritePosition;
+
+	FPlatformMisc::MemoryBarrier();
+	ReadPosition = Committed;
+}
+
+
+void FVlcMediaRingBuffer::SkipFlushed()
+{
+	const int32 Flushed = FlushPosition;
+
+	if ((int32)((uint32)Flushed - (uint32)ReadPosition) > 0)
+	{
+		FPlatformMisc::MemoryBarrier();
+		ReadPosition = Flushed;
+	}
+}
+
+
+/* FVlcMediaRingBuffer implementation
+ *****************************************************************************/
+
+void FVlcMediaRingBuffer::CopyFrom(uint32 Position, void* OutData, uint32 Size) const
+{
+	const uint32 Offset = Position & (Capacity - 1);
+	const uint32 FirstPart = FMath::Min(Size, Capacity - Offset);
+
+	FMemory::Memcpy(OutData, Buffer + Offset, FirstPart);
+	FMemory::Memcpy((uint8*)OutData + FirstPart, Buffer, Size - FirstPart);
+}
@@ -0,0 +1,170 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#pragma once
+
+
+/**
+ * Implements a lock-free single producer, single consumer byte ring buffer.
+ *
+ * The buffer is allocated once up front, so neither side ever allocates memory or
+ * waits for the other. The producer appends any number of writes and then publishes
+ * them with a single commit, so the consumer always sees complete records.
+ *
+ * Only one thread may produce and only one thread may consume at a time.
+ */
+class FVlcMediaRingBuffer
+{
+public:
+
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InCapacity The size of the buffer (rounded up to a power of two).
+	 */
+	explicit FVlcMediaRingBuffer(uint32 InCapacity);
+
+	/** Destructor. */
+	~FVlcMediaRingBuffer();
+
+public:
+
+	/**
+	 * Publish all data that was written since the last commit (producer only).
+	 *
+	 * @see Write
+	 */
+	void Commit();
+
+	/**
+	 * Discard all committed data that was not read yet (producer only).
+	 *
+	 * The data is skipped the next time the consumer calls SkipFlushed.
+	 *
+	 * @see SkipFlushed
+	 */
+	void Flush();
+
+	/**
+	 * Get the number of bytes that can be written (producer only).
+	 *
+	 * @return Free space (in bytes).
+	 * @see Write
+	 */
+	uint32 GetSpace() const;
+
+	/**
+	 * Append data to the buffer without publishing it (producer only).
+	 *
+	 * @param Data The data to write.
+	 * @param Size The number of bytes to write (must not exceed the free space).
+	 * @see Commit, GetSpace
+	 */
+	void Write(const void* Data, uint32 Size);
+
+public:
+
+	/**
+	 * Get the number of committed bytes that were not read yet (consumer only).
+	 *
+	 * @return Number of bytes.
+	 * @see Peek, Read
+	 */
+	uint32 Num();
+
+	/**
+	 * Copy data from the buffer without removing it (consumer only).
+	 *
+	 * @param OutData Will contain the data.
+	 * @param Size The number of bytes to copy.
+	 * @return true on success, false if not enough data is available.
+	 * @see Num, Read
+	 */
+	bool Peek(void* OutData, uint32 Size);
+
+	/**
+	 * Remove data from the buffer (consumer only).
+	 *
+	 * @param OutData Will contain the data.
+	 * @param Size The number of bytes to remove.
+	 * @return true on success, false if not enough data is available.
+	 * @see Num, Peek
+	 */
+	bool Read(void* OutData, uint32 Size);
+
+	/**
+	 * Skip all data that was committed so far (consumer only).
+	 *
+	 * This discards data on behalf of a thread other than the producer. Data is always
+	 * committed in whole records, so the consumer stays aligned to them.
+	 *
+	 * @see Flush
+	 */
+	void SkipAll();
+
+	/**
+	 * Skip data that the producer flushed (consumer only).
+	 *
+	 * Flushes always end at a commit, so calling this only between the records that the
+	 * producer commits keeps the consumer aligned to them.
+	 *
+	 * @see Flush
+	 */
+	void SkipFlushed();
+
+public:
+
+	/**
+	 * Get the size of the buffer.
+	 *
+	 * @return Capacity (in bytes).
+	 */
+	uint32 GetCapacity() const
+	{
+		return Capacity;
+	}
+
+protected:
+
+	/**
+	 * Copy data out of the buffer, wrapping around at its end.
+	 *
+	 * @param Position The position to copy from.
+	 * @param OutData Will contain the data.
+	 * @param Size The number of bytes to copy.
+	 */
+	void CopyFrom(uint32 Position, void* OutData, uint32 Size) const;
+
+private:
+
+	/** The buffer memory. */
+	uint8* Buffer;
+
+	/** The size of the buffer (a power of two). */
+	uint32 Capacity;
+
+	/** Position up to which the producer has written (producer only). */
+	uint32 PendingWritePosition;
+
+	/** Padding to keep the consumer position on its own cache line. */
+	uint8 Padding0[PLATFORM_CACHE_LINE_SIZE];
+
+	/** Position of the next byte to read. */
+	volatile int32 ReadPosition;
+
+	/** Padding to keep the producer positions on their own cache line. */
+	uint8 Padding1[PLATFORM_CACHE_LINE_SIZE];
+
+	/** Position up to which data was committed. */
+	volatile int32 WritePosition;
+
+	/** Position up to which data was flushed. */
+	volatile int32 FlushPosition;
+
+private:
+
+	/** Hidden copy constructor. */
+	FVlcMediaRingBuffer(const FVlcMediaRingBuffer&);
+
+	/** Hidden copy assignment operator. */
+	FVlcMediaRingBuffer& operator=(const FVlcMediaRingBuffer&);
+};
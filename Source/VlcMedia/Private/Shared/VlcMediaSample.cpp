@@ -0,0 +1,118 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+
+
+/* FVlcMediaSample structors
+ *****************************************************************************/
+
+FVlcMediaSample::FVlcMediaSample()
+	: Buffer(nullptr)
+	, Capacity(0)
+	, Duration(FTimespan::Zero())
+	, HeapBuffer(false)
+	, Size(0)
+	, Time(FTimespan::Zero())
+{ }
+
+
+FVlcMediaSample::~FVlcMediaSample()
+{
+	check(RefCount.GetValue() == 0);
+
+	if (HeapBuffer)
+	{
+		FMemory::Free(Buffer);
+	}
+}
+
+
+/* FVlcMediaSample interface
+ *****************************************************************************/
+
+void FVlcMediaSample::Attach(const TSharedRef<FVlcMediaSamplePool, ESPMode::ThreadSafe>& InPool, uint8* InBuffer, uint32 InCapacity, bool InHeapBuffer)
+{
+	check(RefCount.GetValue() == 0);
+
+	Buffer = InBuffer;
+	Capacity = InCapacity;
+	DirtyRects.Reset();
+	Duration = FTimespan::Zero();
+	HeapBuffer = InHeapBuffer;
+	Pool = InPool;
+	Size = InCapacity;
+	Time = FTimespan::Zero();
+}
+
+
+/* IVlcMediaSample interface
+ *****************************************************************************/
+
+uint32 FVlcMediaSample::AddRef() const
+{
+	return (uint32)RefCount.Increment();
+}
+
+
+const uint8* FVlcMediaSample::GetData() const
+{
+	return Buffer;
+}
+
+
+const TArray<FIntRect>& FVlcMediaSample::GetDirtyRects() const
+{
+	return DirtyRects;
+}
+
+
+FTimespan FVlcMediaSample::GetDuration() const
+{
+	return Duration;
+}
+
+
+const FVlcMediaVideoLayout& FVlcMediaSample::GetLayout() const
+{
+	return Layout;
+}
+
+
+uint32 FVlcMediaSample::GetSize() const
+{
+	return Size;
+}
+
+
+FTimespan FVlcMediaSample::GetTime() const
+{
+	return Time;
+}
+
+
+uint32 FVlcMediaSample::Release() const
+{
+	const int32 NewRefCount = RefCount.Decrement();
+	check(NewRefCount >= 0);
+
+	if (NewRefCount == 0)
+	{
+		FVlcMediaSample* MutableThis = const_cast<FVlcMediaSample*>(this);
+
+		// the pool may be destroyed when its last sample is returned, which
+		// also destroys this sample, so nothing may be accessed afterwards
+		TSharedPtr<FVlcMediaSamplePool, ESPMode::ThreadSafe> OwnerPool = MutableThis->Pool;
+		MutableThis->Pool.Reset();
+
+		if (OwnerPool.IsValid())
+		{
+			OwnerPool->Recycle(MutableThis);
+		}
+		else
+		{
+			delete MutableThis;
+		}
+	}
+
+	return (uint32)NewRefCount;
+}
@@ -0,0 +1,167 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#pragma once
+
+
+class FVlcMediaSamplePool;
+
+
+/**
+ * Implements a reference counted media sample.
+ *
+ * Samples are either backed by a buffer in a sample pool, or by a heap allocation
+ * if the pool was exhausted. Pooled samples keep their pool alive while they are in use.
+ */
+class FVlcMediaSample
+	: public IVlcMediaSample
+{
+public:
+
+	/** Default constructor. */
+	FVlcMediaSample();
+
+	/** Destructor. */
+	virtual ~FVlcMediaSample();
+
+public:
+
+	/**
+	 * Get the writable sample buffer.
+	 *
+	 * @return The buffer.
+	 * @see GetCapacity
+	 */
+	uint8* GetBuffer()
+	{
+		return Buffer;
+	}
+
+	/**
+	 * Get the size of the sample buffer.
+	 *
+	 * @return Number of bytes.
+	 * @see GetBuffer
+	 */
+	uint32 GetCapacity() const
+	{
+		return Capacity;
+	}
+
+	/**
+	 * Set the regions that changed since the previous sample.
+	 *
+	 * @param InDirtyRects The changed regions (empty if the entire frame changed).
+	 */
+	void SetDirtyRects(const TArray<FIntRect>& InDirtyRects)
+	{
+		DirtyRects = InDirtyRects;
+	}
+
+	/**
+	 * Set the sample's duration.
+	 *
+	 * @param InDuration The duration to set.
+	 */
+	void SetDuration(FTimespan InDuration)
+	{
+		Duration = InDuration;
+	}
+
+	/**
+	 * Set the memory layout of the sample data.
+	 *
+	 * @param InLayout The layout to set.
+	 */
+	void SetLayout(const FVlcMediaVideoLayout& InLayout)
+	{
+		Layout = InLayout;
+	}
+
+	/**
+	 * Set the number of valid bytes in the sample buffer.
+	 *
+	 * @param InSize The size to set (must not exceed the capacity).
+	 */
+	void SetSize(uint32 InSize)
+	{
+		check(InSize <= Capacity);
+		Size = InSize;
+	}
+
+	/**
+	 * Set the sample's play time.
+	 *
+	 * @param InTime The time to set.
+	 */
+	void SetTime(FTimespan InTime)
+	{
+		Time = InTime;
+	}
+
+public:
+
+	/**
+	 * Attach the sample to its pool.
+	 *
+	 * @param InPool The pool that the sample belongs to.
+	 * @param InBuffer The sample buffer.
+	 * @param InCapacity The size of the buffer.
+	 * @param InHeapBuffer Whether the buffer was allocated from the heap and is owned by this sample.
+	 */
+	void Attach(const TSharedRef<FVlcMediaSamplePool, ESPMode::ThreadSafe>& InPool, uint8* InBuffer, uint32 InCapacity, bool InHeapBuffer);
+
+	/**
+	 * Check whether the buffer was allocated from the heap.
+	 *
+	 * @return true if the buffer is owned by this sample, false if it belongs to the pool's slab.
+	 */
+	bool IsHeapBuffer() const
+	{
+		return HeapBuffer;
+	}
+
+public:
+
+	// IVlcMediaSample interface
+
+	virtual uint32 AddRef() const override;
+	virtual const uint8* GetData() const override;
+	virtual const TArray<FIntRect>& GetDirtyRects() const override;
+	virtual FTimespan GetDuration() const override;
+	virtual const FVlcMediaVideoLayout& GetLayout() const override;
+	virtual uint32 GetSize() const override;
+	virtual FTimespan GetTime() const override;
+	virtual uint32 Release() const override;
+
+private:
+
+	/** The sample buffer. */
+	uint8* Buffer;
+
+	/** The size of the sample buffer. */
+	uint32 Capacity;
+
+	/** The regions that changed since the previous sample. */
+	TArray<FIntRect> DirtyRects;
+
+	/** The sample's duration. */
+	FTimespan Duration;
+
+	/** Whether the buffer was allocated from the heap. */
+	bool HeapBuffer;
+
+	/** The memory layout of the sample data. */
+	FVlcMediaVideoLayout Layout;
+
+	/** The pool that the sample belongs to (only set while the sample is in use). */
+	TSharedPtr<FVlcMediaSamplePool, ESPMode::ThreadSafe> Pool;
+
+	/** The number of references to this sample. */
+	mutable FThreadSafeCounter RefCount;
+
+	/** The number of valid bytes in the buffer. */
+	uint32 Size;
+
+	/** The sample's play time. */
+	FTimespan Time;
+};
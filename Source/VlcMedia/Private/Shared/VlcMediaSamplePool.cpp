@@ -0,0 +1,109 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+
+
+/* FVlcMediaSamplePool structors
+ *****************************************************************************/
+
+FVlcMediaSamplePool::FVlcMediaSamplePool(uint32 InBufferSize, int32 InNumBuffers)
+	: BufferSize(InBufferSize)
+	, Slab(nullptr)
+{
+	check(InNumBuffers > 0);
+
+	Stats.BufferSize = BufferSize;
+	Stats.Capacity = InNumBuffers;
+
+	// the sample objects never move, because the array is only ever sized once
+	Samples.AddDefaulted(InNumBuffers);
+	FreeSamples.Reserve(InNumBuffers);
+
+	if (BufferSize > 0)
+	{
+		Slab = (uint8*)FMemory::Malloc(Align(BufferSize, BufferAlignment) * InNumBuffers, BufferAlignment);
+	}
+
+	// hand out the first buffer first
+	for (int32 SampleIndex = InNumBuffers - 1; SampleIndex >= 0; --SampleIndex)
+	{
+		FreeSamples.Add(&Samples[SampleIndex]);
+	}
+}
+
+
+FVlcMediaSamplePool::~FVlcMediaSamplePool()
+{
+	// samples in use keep the pool alive, so all of them must have been returned
+	check(FreeSamples.Num() == Samples.Num());
+
+	Samples.Empty();
+	FMemory::Free(Slab);
+}
+
+
+/* FVlcMediaSamplePool interface
+ *****************************************************************************/
+
+TRefCountPtr<FVlcMediaSample> FVlcMediaSamplePool::Acquire()
+{
+	FVlcMediaSample* Sample = nullptr;
+	{
+		FScopeLock Lock(&CriticalSection);
+
+		if (FreeSamples.Num() > 0)
+		{
+			Sample = FreeSamples.Pop(false);
+			++Stats.NumHits;
+		}
+		else
+		{
+			++Stats.NumMisses;
+		}
+
+		Stats.HighWaterMark = FMath::Max(Stats.HighWaterMark, ++Stats.NumUsed);
+	}
+
+	if (Sample != nullptr)
+	{
+		const int32 SampleIndex = (int32)(Sample - Samples.GetData());
+		Sample->Attach(AsShared(), Slab + SampleIndex * Align(BufferSize, BufferAlignment), BufferSize, false);
+	}
+	else
+	{
+		Sample = new FVlcMediaSample;
+		Sample->Attach(AsShared(), (uint8*)FMemory::Malloc(FMath::Max(BufferSize, 1u), BufferAlignment), BufferSize, true);
+	}
+
+	return TRefCountPtr<FVlcMediaSample>(Sample);
+}
+
+
+FVlcMediaSamplePoolStats FVlcMediaSamplePool::GetStats() const
+{
+	FScopeLock Lock(&CriticalSection);
+
+	return Stats;
+}
+
+
+/* FVlcMediaSamplePool implementation
+ *****************************************************************************/
+
+void FVlcMediaSamplePool::Recycle(FVlcMediaSample* Sample)
+{
+	if (Sample->IsHeapBuffer())
+	{
+		delete Sample;
+		Sample = nullptr;
+	}
+
+	FScopeLock Lock(&CriticalSection);
+
+	if (Sample != nullptr)
+	{
+		FreeSamples.Add(Sample);
+	}
+
+	--Stats.NumUsed;
+}
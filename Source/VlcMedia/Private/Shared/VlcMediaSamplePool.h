@@ -0,0 +1,89 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#pragma once
+
+
+/**
+ * Implements a pool of fixed-size media sample buffers.
+ *
+ * All buffers are carved from a single aligned slab that is allocated up front. When all
+ * buffers are in use, samples fall back to heap allocations, which are counted as misses.
+ * The pool must be created as a thread-safe shared pointer, because samples that are
+ * still in use keep it alive after its creator released it.
+ */
+class FVlcMediaSamplePool
+	: public TSharedFromThis<FVlcMediaSamplePool, ESPMode::ThreadSafe>
+{
+public:
+
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InBufferSize The size of each buffer (in bytes).
+	 * @param InNumBuffers The number of buffers in the pool.
+	 */
+	FVlcMediaSamplePool(uint32 InBufferSize, int32 InNumBuffers);
+
+	/** Destructor. */
+	~FVlcMediaSamplePool();
+
+public:
+
+	/**
+	 * Acquire a sample.
+	 *
+	 * @return The sample, which is returned to the pool once it is no longer referenced.
+	 */
+	TRefCountPtr<FVlcMediaSample> Acquire();
+
+	/**
+	 * Get the size of the pooled buffers.
+	 *
+	 * @return Buffer size (in bytes).
+	 */
+	uint32 GetBufferSize() const
+	{
+		return BufferSize;
+	}
+
+	/**
+	 * Get the pool's usage statistics.
+	 *
+	 * @return Statistics.
+	 */
+	FVlcMediaSamplePoolStats GetStats() const;
+
+protected:
+
+	/**
+	 * Return a sample to the pool (called when the last reference was released).
+	 *
+	 * @param Sample The sample to return.
+	 */
+	void Recycle(FVlcMediaSample* Sample);
+
+private:
+
+	/** Alignment of the pooled buffers. */
+	static const uint32 BufferAlignment = 64;
+
+	/** The size of each buffer. */
+	uint32 BufferSize;
+
+	/** Critical section for synchronizing access to the free list and statistics. */
+	mutable FCriticalSection CriticalSection;
+
+	/** Samples that are not in use. */
+	TArray<FVlcMediaSample*> FreeSamples;
+
+	/** The pool's sample objects (one for each buffer). */
+	TArray<FVlcMediaSample> Samples;
+
+	/** The memory for all buffers. */
+	uint8* Slab;
+
+	/** Usage statistics. */
+	FVlcMediaSamplePoolStats Stats;
+
+	friend class FVlcMediaSample;
+};
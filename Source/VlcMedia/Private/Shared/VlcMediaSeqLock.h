@@ -0,0 +1,86 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#pragma once
+
+
+/**
+ * Implements a sequence lock for sharing small values with many readers.
+ *
+ * Readers never block and never write to shared memory; they retry if a write
+ * happened while they were copying the value. Only one thread may write at a
+ * time, so writers must be synchronized externally.
+ *
+ * @param ValueType The type of the shared value (must be trivially copyable).
+ */
+template<typename ValueType>
+class TVlcMediaSeqLock
+{
+public:
+
+	/** Default constructor. */
+	TVlcMediaSeqLock()
+		: Sequence(0)
+		, Value()
+	{ }
+
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InValue The initial value.
+	 */
+	explicit TVlcMediaSeqLock(const ValueType& InValue)
+		: Sequence(0)
+		, Value(InValue)
+	{ }
+
+public:
+
+	/**
+	 * Get a consistent copy of the value.
+	 *
+	 * @return The value.
+	 * @see Write
+	 */
+	ValueType Read() const
+	{
+		for (;;)
+		{
+			const int32 Begin = Sequence;
+			FPlatformMisc::MemoryBarrier();
+
+			if ((Begin & 1) == 0)
+			{
+				const ValueType Result = Value;
+				FPlatformMisc::MemoryBarrier();
+
+				if (Sequence == Begin)
+				{
+					return Result;
+				}
+			}
+
+			FPlatformProcess::Sleep(0.0f);
+		}
+	}
+
+	/**
+	 * Replace the value.
+	 *
+	 * @param NewValue The value to set.
+	 * @see Read
+	 */
+	void Write(const ValueType& NewValue)
+	{
+		FPlatformAtomics::InterlockedIncrement(&Sequence);
+		Value = NewValue;
+		FPlatformAtomics::InterlockedIncrement(&Sequence);
+	}
+
+private:
+
+	/** Write sequence number (odd while a write is in progress). */
+	volatile int32 Sequence;
+
+	/** The shared value. */
+	ValueType Value;
+};
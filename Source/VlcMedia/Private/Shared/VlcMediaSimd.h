@@ -0,0 +1,28 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#pragma once
+
+
+/* SIMD support for x86 and x64 processors
+ *****************************************************************************/
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+	#define VLCMEDIA_X86 1
+#else
+	#define VLCMEDIA_X86 0
+#endif
+
+#if VLCMEDIA_X86
+	#include <emmintrin.h>
+	#include <tmmintrin.h>
+	#include <immintrin.h>
+
+	// allows compiling functions for instruction sets that are selected at run-time
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+		#define VLCMEDIA_TARGET(Features)
+	#else
+		#include <cpuid.h>
+		#define VLCMEDIA_TARGET(Features) __attribute__((target(Features)))
+	#endif
+#endif
@@ -0,0 +1,224 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+
+
+/* FVlcMediaSinkDispatcher structors
+ *****************************************************************************/
+
+FVlcMediaSinkDispatcher::FVlcMediaSinkDispatcher(const void* InSinkKey, const FVlcMediaSinkOptions& InOptions)
+	: Options(InOptions)
+	, Queue(InOptions.QueueCapacity)
+	, SinkKey(InSinkKey)
+	, SinkExpired(false)
+	, SpaceEvent(FPlatformProcess::GetSynchEventFromPool(false))
+	, Stopping(false)
+	, Thread(nullptr)
+	, TotalLatency(0.0)
+	, WorkEvent(FPlatformProcess::GetSynchEventFromPool(false))
+{
+	Options.QueueCapacity = Queue.GetCapacity();
+}
+
+
+FVlcMediaSinkDispatcher::~FVlcMediaSinkDispatcher()
+{
+	// derived classes must shut down before their Deliver implementation goes away
+	check(Thread == nullptr);
+
+	FPlatformProcess::ReturnSynchEventToPool(SpaceEvent);
+	FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+}
+
+
+/* FVlcMediaSinkDispatcher interface
+ *****************************************************************************/
+
+void FVlcMediaSinkDispatcher::Enqueue(const IVlcMediaSampleRef& Sample)
+{
+	const FQueueItem Item(Sample, FPlatformTime::Seconds());
+	uint64 NumDropped = 0;
+	bool Queued = false;
+
+	while (!Stopping)
+	{
+		if (Queue.Enqueue(Item))
+		{
+			Queued = true;
+
+			break;
+		}
+
+		if (Options.OverflowPolicy == EVlcMediaSinkOverflowPolicy::DropNewest)
+		{
+			++NumDropped;
+
+			break;
+		}
+
+		if (Options.OverflowPolicy == EVlcMediaSinkOverflowPolicy::DropOldest)
+		{
+			FQueueItem OldestItem;
+
+			if (Queue.Dequeue(OldestItem))
+			{
+				++NumDropped;
+			}
+		}
+		else
+		{
+			// the timeout guards against missing a wake-up from the worker
+			SpaceEvent->Wait(10);
+		}
+	}
+
+	{
+		FScopeLock Lock(&StatsCriticalSection);
+
+		Stats.NumDropped += NumDropped;
+		Stats.NumQueued += Queued ? 1 : 0;
+	}
+
+	if (Queued)
+	{
+		WorkEvent->Trigger();
+	}
+}
+
+
+FVlcMediaSinkStats FVlcMediaSinkDispatcher::GetStats() const
+{
+	FVlcMediaSinkStats Result;
+	{
+		FScopeLock Lock(&StatsCriticalSection);
+		Result = Stats;
+	}
+
+	Result.QueueLength = Queue.Num();
+
+	return Result;
+}
+
+
+void FVlcMediaSinkDispatcher::Start()
+{
+	check(Thread == nullptr);
+
+	Thread = FRunnableThread::Create(this, TEXT("VlcMediaSinkDispatcher"), 0, TPri_AboveNormal);
+}
+
+
+void FVlcMediaSinkDispatcher::Shutdown()
+{
+	Stopping = true;
+
+	if (Thread != nullptr)
+	{
+		WorkEvent->Trigger();
+		Thread->WaitForCompletion();
+
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	SpaceEvent->Trigger();
+
+	// release the queued samples, so that they can return to their pools
+	FQueueItem Item;
+
+	while (Queue.Dequeue(Item))
+	{
+		Item.Sample = nullptr;
+	}
+}
+
+
+/* FRunnable interface
+ *****************************************************************************/
+
+uint32 FVlcMediaSinkDispatcher::Run()
+{
+	while (!Stopping)
+	{
+		FQueueItem Item;
+
+		if (!Queue.Dequeue(Item))
+		{
+			WorkEvent->Wait(100);
+
+			continue;
+		}
+
+		SpaceEvent->Trigger();
+
+		if (SinkExpired)
+		{
+			continue;
+		}
+
+		if (!Deliver(Item.Sample))
+		{
+			SinkExpired = true;
+
+			continue;
+		}
+
+		const double Latency = FPlatformTime::Seconds() - Item.QueueTime;
+		{
+			FScopeLock Lock(&StatsCriticalSection);
+
+			++Stats.NumDelivered;
+			TotalLatency += Latency;
+
+			Stats.AverageLatency = TotalLatency / Stats.NumDelivered;
+			Stats.LastLatency = Latency;
+			Stats.MaxLatency = FMath::Max(Stats.MaxLatency, Latency);
+		}
+	}
+
+	return 0;
+}
+
+
+void FVlcMediaSinkDispatcher::Stop()
+{
+	Stopping = true;
+	WorkEvent->Trigger();
+	SpaceEvent->Trigger();
+}
+
+
+/* FVlcMediaFrameworkSinkDispatcher interface
+ *****************************************************************************/
+
+bool FVlcMediaFrameworkSinkDispatcher::Deliver(const IVlcMediaSampleRef& Sample)
+{
+	IMediaSinkPtr PinnedSink = Sink.Pin();
+
+	if (!PinnedSink.IsValid())
+	{
+		return false;
+	}
+
+	PinnedSink->ProcessMediaSample(Sample->GetData(), Sample->GetSize(), Sample->GetDuration(), Sample->GetTime());
+
+	return true;
+}
+
+
+/* FVlcMediaSampleSinkDispatcher interface
+ *****************************************************************************/
+
+bool FVlcMediaSampleSinkDispatcher::Deliver(const IVlcMediaSampleRef& Sample)
+{
+	IVlcMediaSampleSinkPtr PinnedSink = Sink.Pin();
+
+	if (!PinnedSink.IsValid())
+	{
+		return false;
+	}
+
+	PinnedSink->ProcessMediaSample(Sample);
+
+	return true;
+}
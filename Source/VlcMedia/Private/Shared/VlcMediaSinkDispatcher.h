@@ -0,0 +1,248 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#pragma once
+
+#include "VlcMediaBoundedQueue.h"
+
+
+/**
+ * Delivers media samples to a single sink on a dedicated worker thread.
+ *
+ * Samples are queued by the decoder thread and handed to the sink by the worker,
+ * so that a slow sink does not stall decoding or other sinks. The queue is bounded,
+ * and the options decide what happens when it is full.
+ */
+class FVlcMediaSinkDispatcher
+	: public FRunnable
+{
+public:
+
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InSinkKey Pointer that identifies the sink.
+	 * @param InOptions The delivery options.
+	 */
+	FVlcMediaSinkDispatcher(const void* InSinkKey, const FVlcMediaSinkOptions& InOptions);
+
+	/** Virtual destructor. */
+	virtual ~FVlcMediaSinkDispatcher();
+
+public:
+
+	/**
+	 * Queue a sample for delivery (called from the decoder thread).
+	 *
+	 * Depending on the overflow policy, this may block until the sink made room in its queue.
+	 *
+	 * @param Sample The sample to queue.
+	 */
+	void Enqueue(const IVlcMediaSampleRef& Sample);
+
+	/**
+	 * Get the delivery options.
+	 *
+	 * @return Options.
+	 */
+	const FVlcMediaSinkOptions& GetOptions() const
+	{
+		return Options;
+	}
+
+	/**
+	 * Get the pointer that identifies the sink.
+	 *
+	 * @return Sink key.
+	 */
+	const void* GetSinkKey() const
+	{
+		return SinkKey;
+	}
+
+	/**
+	 * Get the delivery statistics.
+	 *
+	 * @return Statistics.
+	 */
+	FVlcMediaSinkStats GetStats() const;
+
+	/**
+	 * Check whether the sink has been destroyed.
+	 *
+	 * @return true if the sink no longer exists, false otherwise.
+	 */
+	bool IsSinkExpired() const
+	{
+		return SinkExpired;
+	}
+
+	/**
+	 * Start the worker thread.
+	 *
+	 * @see Shutdown
+	 */
+	void Start();
+
+	/**
+	 * Stop the worker thread and discard all queued samples.
+	 *
+	 * This also releases a decoder thread that is blocked in Enqueue. It is safe to call
+	 * this more than once, and it must be called before a derived class is destroyed.
+	 *
+	 * @see Start
+	 */
+	void Shutdown();
+
+public:
+
+	// FRunnable interface
+
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+protected:
+
+	/**
+	 * Deliver a sample to the sink (called from the worker thread).
+	 *
+	 * @param Sample The sample to deliver.
+	 * @return true if the sample was delivered, false if the sink no longer exists.
+	 */
+	virtual bool Deliver(const IVlcMediaSampleRef& Sample) = 0;
+
+private:
+
+	/** A queued sample. */
+	struct FQueueItem
+	{
+		/** The sample. */
+		IVlcMediaSampleRef Sample;
+
+		/** The time at which the sample was queued (in seconds). */
+		double QueueTime;
+
+		/** Default constructor. */
+		FQueueItem()
+			: QueueTime(0.0)
+		{ }
+
+		/** Creates and initializes a new instance. */
+		FQueueItem(const IVlcMediaSampleRef& InSample, double InQueueTime)
+			: Sample(InSample)
+			, QueueTime(InQueueTime)
+		{ }
+	};
+
+	/** The delivery options. */
+	FVlcMediaSinkOptions Options;
+
+	/** Samples waiting for delivery. */
+	TVlcMediaBoundedQueue<FQueueItem> Queue;
+
+	/** Pointer that identifies the sink. */
+	const void* SinkKey;
+
+	/** Whether the sink has been destroyed. */
+	volatile bool SinkExpired;
+
+	/** Signaled when the worker removed a sample from the queue. */
+	FEvent* SpaceEvent;
+
+	/** Delivery statistics (except for the queue length). */
+	FVlcMediaSinkStats Stats;
+
+	/** Critical section for synchronizing access to the statistics. */
+	mutable FCriticalSection StatsCriticalSection;
+
+	/** Whether the worker thread should stop. */
+	volatile bool Stopping;
+
+	/** The worker thread. */
+	FRunnableThread* Thread;
+
+	/** Sum of all delivery latencies (in seconds). */
+	double TotalLatency;
+
+	/** Signaled when a sample was added to the queue. */
+	FEvent* WorkEvent;
+};
+
+
+/**
+ * Delivers raw sample data to a media framework sink.
+ */
+class FVlcMediaFrameworkSinkDispatcher
+	: public FVlcMediaSinkDispatcher
+{
+public:
+
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InSink The sink to deliver to.
+	 * @param InOptions The delivery options.
+	 */
+	FVlcMediaFrameworkSinkDispatcher(const IMediaSinkRef& InSink, const FVlcMediaSinkOptions& InOptions)
+		: FVlcMediaSinkDispatcher(&InSink.Get(), InOptions)
+		, Sink(InSink)
+	{ }
+
+	/** Virtual destructor. */
+	virtual ~FVlcMediaFrameworkSinkDispatcher()
+	{
+		Shutdown();
+	}
+
+protected:
+
+	// FVlcMediaSinkDispatcher interface
+
+	virtual bool Deliver(const IVlcMediaSampleRef& Sample) override;
+
+private:
+
+	/** The sink. */
+	IMediaSinkWeakPtr Sink;
+};
+
+
+/**
+ * Delivers reference counted samples to a sample sink.
+ */
+class FVlcMediaSampleSinkDispatcher
+	: public FVlcMediaSinkDispatcher
+{
+public:
+
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InSink The sink to deliver to.
+	 * @param InOptions The delivery options.
+	 */
+	FVlcMediaSampleSinkDispatcher(const IVlcMediaSampleSinkRef& InSink, const FVlcMediaSinkOptions& InOptions)
+		: FVlcMediaSinkDispatcher(&InSink.Get(), InOptions)
+		, Sink(InSink)
+	{ }
+
+	/** Virtual destructor. */
+	virtual ~FVlcMediaSampleSinkDispatcher()
+	{
+		Shutdown();
+	}
+
+protected:
+
+	// FVlcMediaSinkDispatcher interface
+
+	virtual bool Deliver(const IVlcMediaSampleRef& Sample) override;
+
+private:
+
+	/** The sink. */
+	IVlcMediaSampleSinkWeakPtr Sink;
+};
+
+
+/** Type definition for shared pointers to sink dispatchers. */
+typedef TSharedPtr<FVlcMediaSinkDispatcher, ESPMode::ThreadSafe> FVlcMediaSinkDispatcherPtr;
@@ -0,0 +1,222 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+
+
+/* FVlcMediaSource static functions
+ *****************************************************************************/
+
+FLibvlcMedia* FVlcMediaSource::CreateMedia(FLibvlcInstance* VlcInstance, const TSharedRef<FVlcMediaSource, ESPMode::ThreadSafe>& Source)
+{
+	FLibvlcMedia* Media = FVlc::MediaNewCallbacks(
+		VlcInstance,
+		&FVlcMediaSource::HandleMediaOpen,
+		&FVlcMediaSource::HandleMediaRead,
+		&FVlcMediaSource::HandleMediaSeek,
+		&FVlcMediaSource::HandleMediaClose,
+		&Source.Get());
+
+	if (Media == nullptr)
+	{
+		return nullptr;
+	}
+
+	// the source must outlive the media, which may be released on a worker thread long after its player let go of it
+	FLibvlcEventManager* EventManager = FVlc::MediaEventManager(Media);
+
+	if ((EventManager == nullptr) || (FVlc::EventAttach(EventManager, ELibvlcEventType::MediaFreed, &FVlcMediaSource::HandleMediaFreed, &Source.Get()) != 0))
+	{
+		FVlc::MediaRelease(Media);
+
+		return nullptr;
+	}
+
+	Source->SelfReference = Source;
+
+	return Media;
+}
+
+
+/* FVlcMediaSource callbacks
+ *****************************************************************************/
+
+void FVlcMediaSource::HandleMediaFreed(FLibvlcEvent* Event, void* UserData)
+{
+	// this may destroy the source
+	((FVlcMediaSource*)UserData)->SelfReference.Reset();
+}
+
+
+int FVlcMediaSource::HandleMediaOpen(void* Opaque, void** OutData, uint64* OutSize)
+{
+	FVlcMediaSource* Source = (FVlcMediaSource*)Opaque;
+
+	// the other callbacks receive this as their opaque pointer
+	*OutData = Source;
+	*OutSize = Source->GetSize();
+
+	Source->Position = 0;
+
+	return 0;
+}
+
+
+SSIZE_T FVlcMediaSource::HandleMediaRead(void* Opaque, void* Buffer, SIZE_T Length)
+{
+	FVlcMediaSource* Source = (FVlcMediaSource*)Opaque;
+
+	return Source->Read(Source->Position, Buffer, Length);
+}
+
+
+int FVlcMediaSource::HandleMediaSeek(void* Opaque, uint64 Offset)
+{
+	FVlcMediaSource* Source = (FVlcMediaSource*)Opaque;
+
+	if (!Source->CanSeek(Offset))
+	{
+		return -1;
+	}
+
+	Source->Position = (SIZE_T)Offset;
+
+	return 0;
+}
+
+
+void FVlcMediaSource::HandleMediaClose(void* Opaque)
+{
+	// the source is released with the media, because libvlc may open it again
+	((FVlcMediaSource*)Opaque)->Position = 0;
+}
+
+
+/* FVlcMediaBufferSource interface
+ *****************************************************************************/
+
+uint64 FVlcMediaBufferSource::GetSize() const
+{
+	return (uint64)Buffer->Num();
+}
+
+
+SSIZE_T FVlcMediaBufferSource::Read(SIZE_T& InOutPosition, void* OutBuffer, SIZE_T Length)
+{
+	const SIZE_T BufferSize = (SIZE_T)Buffer->Num();
+
+	if (InOutPosition >= BufferSize)
+	{
+		return 0;
+	}
+
+	const SIZE_T BytesToRead = FMath::Min(Length, BufferSize - InOutPosition);
+
+	FMemory::Memcpy(OutBuffer, Buffer->GetData() + InOutPosition, BytesToRead);
+	InOutPosition += BytesToRead;
+
+	return (SSIZE_T)BytesToRead;
+}
+
+
+/* FVlcMediaMappedFileSource interface
+ *****************************************************************************/
+
+uint64 FVlcMediaMappedFileSource::GetSize() const
+{
+	return (uint64)MappedFile->GetSize();
+}
+
+
+SSIZE_T FVlcMediaMappedFileSource::Read(SIZE_T& InOutPosition, void* OutBuffer, SIZE_T Length)
+{
+	const SIZE_T FileSize = MappedFile->GetSize();
+
+	if (InOutPosition >= FileSize)
+	{
+		return 0;
+	}
+
+	const SIZE_T BytesToRead = FMath::Min(Length, FileSize - InOutPosition);
+
+	FMemory::Memcpy(OutBuffer, MappedFile->GetData() + InOutPosition, BytesToRead);
+	InOutPosition += BytesToRead;
+
+	return (SSIZE_T)BytesToRead;
+}
+
+
+/* FVlcMediaPrefetchSource interface
+ *****************************************************************************/
+
+FVlcMediaPrefetchStats FVlcMediaPrefetchSource::GetPrefetchStats() const
+{
+	return Reader->GetStats();
+}
+
+
+void FVlcMediaPrefetchSource::Interrupt()
+{
+	// fails pending reads without waiting for the worker thread, which is joined when the reader is destroyed
+	Reader->Stop();
+}
+
+
+uint64 FVlcMediaPrefetchSource::GetSize() const
+{
+	return Reader->GetSize();
+}
+
+
+SSIZE_T FVlcMediaPrefetchSource::Read(SIZE_T& InOutPosition, void* OutBuffer, SIZE_T Length)
+{
+	return Reader->Read(InOutPosition, OutBuffer, Length);
+}
+
+
+/* FVlcMediaStreamSource structors
+ *****************************************************************************/
+
+FVlcMediaStreamSource::FVlcMediaStreamSource(const TSharedRef<FVlcMediaStream, ESPMode::ThreadSafe>& InStream)
+	: Interrupted(0)
+	, Stream(InStream)
+	, WaitEvent(FPlatformProcess::GetSynchEventFromPool(false))
+{
+	Stream->AddWaitEvent(WaitEvent);
+}
+
+
+FVlcMediaStreamSource::~FVlcMediaStreamSource()
+{
+	Stream->RemoveWaitEvent(WaitEvent);
+	FPlatformProcess::ReturnSynchEventToPool(WaitEvent);
+}
+
+
+/* FVlcMediaStreamSource interface
+ *****************************************************************************/
+
+void FVlcMediaStreamSource::Interrupt()
+{
+	// other readers of the same stream keep reading
+	FPlatformAtomics::InterlockedExchange(&Interrupted, 1);
+	WaitEvent->Trigger();
+}
+
+
+bool FVlcMediaStreamSource::CanSeek(uint64 Offset) const
+{
+	// seeking past the appended data is fine, reads wait for it
+	return Stream->CanSeek(Offset);
+}
+
+
+uint64 FVlcMediaStreamSource::GetSize() const
+{
+	return Stream->GetMediaSize();
+}
+
+
+SSIZE_T FVlcMediaStreamSource::Read(SIZE_T& InOutPosition, void* OutBuffer, SIZE_T Length)
+{
+	return Stream->Read(InOutPosition, OutBuffer, Length, WaitEvent, Interrupted);
+}
@@ -0,0 +1,266 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#pragma once
+
+
+/**
+ * Abstract base class for the I/O context of a libvlc media that is read through callbacks.
+ *
+ * Each media gets its own source, which owns the read position and references the backing store, and
+ * which libvlc passes to the callbacks as their opaque pointer. A media keeps its source
+ * alive until libvlc frees it, so a media player can drop its reference while the media is
+ * still being stopped. Sources that share a backing store (i.e. the same buffer, file or stream)
+ * keep their read positions and interrupt state to themselves, so interrupting one of them
+ * does not affect the others.
+ *
+ * The read callbacks are only called on the input thread of the media.
+ */
+class FVlcMediaSource
+{
+public:
+
+	/** Virtual destructor. */
+	virtual ~FVlcMediaSource() { }
+
+public:
+
+	/**
+	 * Create a libvlc media that reads from a source.
+	 *
+	 * @param VlcInstance The LibVLC instance to create the media with.
+	 * @param Source The source to read from.
+	 * @return The media, or nullptr on failure.
+	 */
+	static FLibvlcMedia* CreateMedia(FLibvlcInstance* VlcInstance, const TSharedRef<FVlcMediaSource, ESPMode::ThreadSafe>& Source);
+
+public:
+
+	/**
+	 * Get statistics of the read-ahead cache.
+	 *
+	 * @return Statistics (all zero if the source does not use the cache).
+	 */
+	virtual FVlcMediaPrefetchStats GetPrefetchStats() const
+	{
+		return FVlcMediaPrefetchStats();
+	}
+
+	/**
+	 * Make pending and future reads fail, so that the media can be stopped without waiting for data.
+	 *
+	 * This does not block, and it is called on the game thread.
+	 */
+	virtual void Interrupt() { }
+
+protected:
+
+	/** Default constructor. */
+	FVlcMediaSource()
+		: Position(0)
+	{ }
+
+	/**
+	 * Check whether the read position can be moved to the given offset.
+	 *
+	 * @param Offset The offset to seek to.
+	 * @return true if the offset is valid, false otherwise.
+	 */
+	virtual bool CanSeek(uint64 Offset) const
+	{
+		return (Offset < GetSize());
+	}
+
+	/**
+	 * Get the size of the media to report to libvlc.
+	 *
+	 * @return Size (in bytes), or MAX_uint64 if unknown.
+	 */
+	virtual uint64 GetSize() const = 0;
+
+	/**
+	 * Copy media data.
+	 *
+	 * @param InOutPosition The position to read from (will be advanced by the number of bytes read).
+	 * @param OutBuffer Will contain the data.
+	 * @param Length The maximum number of bytes to read.
+	 * @return The number of bytes read, zero at the end of the media, or -1 on failure.
+	 */
+	virtual SSIZE_T Read(SIZE_T& InOutPosition, void* OutBuffer, SIZE_T Length) = 0;
+
+private:
+
+	/** Handles the event that libvlc freed the media. */
+	static void HandleMediaFreed(FLibvlcEvent* Event, void* UserData);
+
+	/** Handles open callbacks from VLC. */
+	static int HandleMediaOpen(void* Opaque, void** OutData, uint64* OutSize);
+
+	/** Handles read callbacks from VLC. */
+	static SSIZE_T HandleMediaRead(void* Opaque, void* Buffer, SIZE_T Length);
+
+	/** Handles seek callbacks from VLC. */
+	static int HandleMediaSeek(void* Opaque, uint64 Offset);
+
+	/** Handles close callbacks from VLC. */
+	static void HandleMediaClose(void* Opaque);
+
+private:
+
+	/** The current read position (only accessed on libvlc's input thread). */
+	SIZE_T Position;
+
+	/** Keeps the source alive until libvlc frees its media. */
+	TSharedPtr<FVlcMediaSource, ESPMode::ThreadSafe> SelfReference;
+};
+
+
+/**
+ * Reads media from an in-memory buffer.
+ */
+class FVlcMediaBufferSource
+	: public FVlcMediaSource
+{
+public:
+
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InBuffer The buffer holding the media data.
+	 */
+	FVlcMediaBufferSource(const TSharedRef<TArray<uint8>, ESPMode::ThreadSafe>& InBuffer)
+		: Buffer(InBuffer)
+	{ }
+
+protected:
+
+	// FVlcMediaSource interface
+
+	virtual uint64 GetSize() const override;
+	virtual SSIZE_T Read(SIZE_T& InOutPosition, void* OutBuffer, SIZE_T Length) override;
+
+private:
+
+	/** The buffer holding the media data. */
+	TSharedRef<TArray<uint8>, ESPMode::ThreadSafe> Buffer;
+};
+
+
+/**
+ * Reads media directly from a memory-mapped file.
+ */
+class FVlcMediaMappedFileSource
+	: public FVlcMediaSource
+{
+public:
+
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InMappedFile The mapped file (must be valid).
+	 */
+	FVlcMediaMappedFileSource(const TSharedRef<FVlcMediaMappedFile, ESPMode::ThreadSafe>& InMappedFile)
+		: MappedFile(InMappedFile)
+	{ }
+
+protected:
+
+	// FVlcMediaSource interface
+
+	virtual uint64 GetSize() const override;
+	virtual SSIZE_T Read(SIZE_T& InOutPosition, void* OutBuffer, SIZE_T Length) override;
+
+private:
+
+	/** The mapped file. */
+	TSharedRef<FVlcMediaMappedFile, ESPMode::ThreadSafe> MappedFile;
+};
+
+
+/**
+ * Reads media through the read-ahead cache.
+ */
+class FVlcMediaPrefetchSource
+	: public FVlcMediaSource
+{
+public:
+
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InReader The reader to read from (must be started).
+	 */
+	FVlcMediaPrefetchSource(const TSharedRef<FVlcMediaPrefetchReader, ESPMode::ThreadSafe>& InReader)
+		: Reader(InReader)
+	{ }
+
+public:
+
+	// FVlcMediaSource interface
+
+	virtual FVlcMediaPrefetchStats GetPrefetchStats() const override;
+	virtual void Interrupt() override;
+
+protected:
+
+	// FVlcMediaSource interface
+
+	virtual uint64 GetSize() const override;
+	virtual SSIZE_T Read(SIZE_T& InOutPosition, void* OutBuffer, SIZE_T Length) override;
+
+private:
+
+	/** The reader. */
+	TSharedRef<FVlcMediaPrefetchReader, ESPMode::ThreadSafe> Reader;
+};
+
+
+/**
+ * Reads media from a stream that is appended while it is being played.
+ */
+class FVlcMediaStreamSource
+	: public FVlcMediaSource
+{
+public:
+
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InStream The stream to read from.
+	 */
+	FVlcMediaStreamSource(const TSharedRef<FVlcMediaStream, ESPMode::ThreadSafe>& InStream);
+
+	/** Virtual destructor. */
+	virtual ~FVlcMediaStreamSource();
+
+public:
+
+	// FVlcMediaSource interface
+
+	virtual void Interrupt() override;
+
+protected:
+
+	// FVlcMediaSource interface
+
+	virtual bool CanSeek(uint64 Offset) const override;
+	virtual uint64 GetSize() const override;
+	virtual SSIZE_T Read(SIZE_T& InOutPosition, void* OutBuffer, SIZE_T Length) override;
+
+private:
+
+	/** Whether reads of this source are interrupted (as bool). */
+	volatile int32 Interrupted;
+
+	/** The stream. */
+	TSharedRef<FVlcMediaStream, ESPMode::ThreadSafe> Stream;
+
+	/** Triggered when data was appended to the stream, the stream finished, or reads were interrupted. */
+	FEvent* WaitEvent;
+};
+
+
+/** Type definition for shared pointers to media sources. */
+typedef TSharedPtr<FVlcMediaSource, ESPMode::ThreadSafe> FVlcMediaSourcePtr;
+
+/** Type definition for shared references to media sources. */
+typedef TSharedRef<FVlcMediaSource, ESPMode::ThreadSafe> FVlcMediaSourceRef;
@@ -0,0 +1,171 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+
+
+/* FVlcMediaStream structors
+ *****************************************************************************/
+
+FVlcMediaStream::FVlcMediaStream(uint64 InExpectedSize, FTimespan InReadTimeout)
+	: ExpectedSize(InExpectedSize)
+	, Finished(false)
+	, ReadTimeout(InReadTimeout)
+{
+	// reserve the expected size, so that appending does not keep reallocating
+	if ((ExpectedSize > 0) && (ExpectedSize <= MAX_int32))
+	{
+		Data.Reserve((int32)ExpectedSize);
+	}
+}
+
+
+FVlcMediaStream::~FVlcMediaStream()
+{
+	// readers keep the stream alive
+	check(WaitEvents.Num() == 0);
+}
+
+
+/* IVlcMediaStream interface
+ *****************************************************************************/
+
+bool FVlcMediaStream::Append(const void* InData, uint32 Size)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	if (Finished || ((uint64)Data.Num() + Size > MAX_int32))
+	{
+		return false;
+	}
+
+	Data.Append((const uint8*)InData, Size);
+
+	// every reader may be waiting for this data
+	for (FEvent* WaitEvent : WaitEvents)
+	{
+		WaitEvent->Trigger();
+	}
+
+	return true;
+}
+
+
+void FVlcMediaStream::Finish()
+{
+	FScopeLock Lock(&CriticalSection);
+
+	Finished = true;
+
+	for (FEvent* WaitEvent : WaitEvents)
+	{
+		WaitEvent->Trigger();
+	}
+}
+
+
+uint64 FVlcMediaStream::GetNumAppended() const
+{
+	FScopeLock Lock(&CriticalSection);
+
+	return (uint64)Data.Num();
+}
+
+
+bool FVlcMediaStream::IsFinished() const
+{
+	FScopeLock Lock(&CriticalSection);
+
+	return Finished;
+}
+
+
+/* FVlcMediaStream interface
+ *****************************************************************************/
+
+void FVlcMediaStream::AddWaitEvent(FEvent* WaitEvent)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	WaitEvents.Add(WaitEvent);
+}
+
+
+bool FVlcMediaStream::CanSeek(uint64 Offset) const
+{
+	FScopeLock Lock(&CriticalSection);
+
+	if (Finished)
+	{
+		return (Offset < (uint64)Data.Num());
+	}
+
+	return ((ExpectedSize == 0) || (Offset < ExpectedSize));
+}
+
+
+uint64 FVlcMediaStream::GetMediaSize() const
+{
+	FScopeLock Lock(&CriticalSection);
+
+	if (Finished)
+	{
+		return (uint64)Data.Num();
+	}
+
+	return (ExpectedSize > 0) ? ExpectedSize : MAX_uint64;
+}
+
+
+SSIZE_T FVlcMediaStream::Read(SIZE_T& Position, void* OutBuffer, SIZE_T Length, FEvent* WaitEvent, const volatile int32& Interrupted)
+{
+	const double Deadline = FPlatformTime::Seconds() + ReadTimeout.GetTotalSeconds();
+
+	while (true)
+	{
+		{
+			FScopeLock Lock(&CriticalSection);
+
+			if (Interrupted != 0)
+			{
+				return -1;
+			}
+
+			const SIZE_T NumBytes = (SIZE_T)Data.Num();
+
+			if (Position < NumBytes)
+			{
+				const SIZE_T BytesToRead = FMath::Min(Length, NumBytes - Position);
+
+				FMemory::Memcpy(OutBuffer, Data.GetData() + Position, BytesToRead);
+				Position += BytesToRead;
+
+				return (SSIZE_T)BytesToRead;
+			}
+
+			if (Finished)
+			{
+				return 0;
+			}
+		}
+
+		const double RemainingTime = Deadline - FPlatformTime::Seconds();
+
+		if (RemainingTime <= 0.0)
+		{
+			UE_LOG(LogVlcMedia, Warning, TEXT("Timed out waiting for stream data at offset %llu."), (uint64)Position);
+
+			return -1;
+		}
+
+		// the event stays signaled if data arrived since the lock was released
+		WaitEvent->Wait((uint32)(RemainingTime * 1000.0) + 1);
+	}
+}
+
+
+void FVlcMediaStream::RemoveWaitEvent(FEvent* WaitEvent)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	WaitEvents.Remove(WaitEvent);
+}
@@ -0,0 +1,119 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#pragma once
+
+#include "IVlcMediaStream.h"
+
+
+/**
+ * Implements media data that is appended while it is being played.
+ *
+ * The data is kept in a single buffer that is reserved for the expected size up front.
+ * The producer appends under a lock, and the input threads of any number of readers copy
+ * out of the buffer under the same lock, or wait on their own events for more data.
+ */
+class FVlcMediaStream
+	: public IVlcMediaStream
+{
+public:
+
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InExpectedSize The expected size of the media (in bytes), or zero if unknown.
+	 * @param InReadTimeout How long reads wait for data before they fail.
+	 */
+	FVlcMediaStream(uint64 InExpectedSize, FTimespan InReadTimeout);
+
+	/** Virtual destructor. */
+	virtual ~FVlcMediaStream();
+
+public:
+
+	// IVlcMediaStream interface
+
+	virtual bool Append(const void* InData, uint32 Size) override;
+	virtual void Finish() override;
+	virtual uint64 GetNumAppended() const override;
+	virtual bool IsFinished() const override;
+
+public:
+
+	/**
+	 * Register an event that is triggered whenever data is appended or the stream finishes.
+	 *
+	 * @param WaitEvent The event of a reader.
+	 * @see Read, RemoveWaitEvent
+	 */
+	void AddWaitEvent(FEvent* WaitEvent);
+
+	/**
+	 * Check whether the read position can be moved to the given offset.
+	 *
+	 * Offsets past the appended data are allowed until the stream is finished.
+	 *
+	 * @param Offset The offset to seek to.
+	 * @return true if the offset is valid, false otherwise.
+	 */
+	bool CanSeek(uint64 Offset) const;
+
+	/**
+	 * Get the size of the media to report to libvlc.
+	 *
+	 * @return The final or expected size (in bytes), or MAX_uint64 if unknown.
+	 */
+	uint64 GetMediaSize() const;
+
+	/**
+	 * Copy media data, waiting for it to be appended if necessary (called on libvlc's input thread).
+	 *
+	 * @param Position The position to read from (will be advanced by the number of bytes read).
+	 * @param OutBuffer Will contain the data.
+	 * @param Length The maximum number of bytes to read.
+	 * @param WaitEvent The reader's event (must be registered with AddWaitEvent).
+	 * @param Interrupted The reader's flag that makes the read fail right away (the reader triggers its event after setting it).
+	 * @return The number of bytes read, zero at the end of the media, or -1 if the read timed out or was interrupted.
+	 * @see AddWaitEvent
+	 */
+	SSIZE_T Read(SIZE_T& Position, void* OutBuffer, SIZE_T Length, FEvent* WaitEvent, const volatile int32& Interrupted);
+
+	/**
+	 * Unregister a reader's event.
+	 *
+	 * @param WaitEvent The event to unregister.
+	 * @see AddWaitEvent
+	 */
+	void RemoveWaitEvent(FEvent* WaitEvent);
+
+private:
+
+	/** Critical section for synchronizing access to the data and flags. */
+	mutable FCriticalSection CriticalSection;
+
+	/** The media data that was appended so far. */
+	TArray<uint8> Data;
+
+	/** The expected size of the media (zero if unknown). */
+	uint64 ExpectedSize;
+
+	/** Whether all media data was appended. */
+	bool Finished;
+
+	/** How long reads wait for data before they fail. */
+	FTimespan ReadTimeout;
+
+	/** The events of the readers, which are triggered when data was appended or the stream finished. */
+	TArray<FEvent*> WaitEvents;
+
+private:
+
+	/** Hidden copy constructor. */
+	FVlcMediaStream(const FVlcMediaStream&);
+
+	/** Hidden copy assignment operator. */
+	FVlcMediaStream& operator=(const FVlcMediaStream&);
+};
+
+
+/** Type definition for shared pointers to media streams. */
+typedef TSharedPtr<FVlcMediaStream, ESPMode::ThreadSafe> FVlcMediaStreamPtr;
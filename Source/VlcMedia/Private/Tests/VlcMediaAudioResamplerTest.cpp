@@ -0,0 +1,208 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+#include "AutomationTest.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace VlcMediaAudioResamplerTest
+{
+	/**
+	 * Create a sine tone with the same signal on all channels.
+	 *
+	 * @param NumChannels The number of channels.
+	 * @param NumFrames The number of frames.
+	 * @param SampleRate The sample rate.
+	 * @return Interleaved samples.
+	 */
+	TArray<float> CreateTone(uint32 NumChannels, uint32 NumFrames, uint32 SampleRate)
+	{
+		TArray<float> Samples;
+		Samples.AddUninitialized(NumChannels * NumFrames);
+
+		for (uint32 FrameIndex = 0; FrameIndex < NumFrames; ++FrameIndex)
+		{
+			const float Sample = 0.5f * FMath::Sin(2.0f * PI * 440.0f * FrameIndex / SampleRate);
+
+			for (uint32 ChannelIndex = 0; ChannelIndex < NumChannels; ++ChannelIndex)
+			{
+				Samples[FrameIndex * NumChannels + ChannelIndex] = Sample;
+			}
+		}
+
+		return Samples;
+	}
+
+	/**
+	 * Convert audio in blocks of the given size.
+	 *
+	 * @param Resampler The resampler to use.
+	 * @param Input The interleaved input frames.
+	 * @param NumChannels The number of input channels.
+	 * @param BlockFrames The number of input frames per block.
+	 * @param OutputChannels The number of output channels.
+	 * @param OutWithinBounds Will be false if any block produced more frames than announced.
+	 * @return The interleaved output frames.
+	 */
+	TArray<int16> Convert(FVlcMediaAudioResampler& Resampler, const TArray<float>& Input, uint32 NumChannels, uint32 BlockFrames, uint32 OutputChannels, bool& OutWithinBounds)
+	{
+		const uint32 NumFrames = Input.Num() / NumChannels;
+
+		TArray<int16> Output;
+		TArray<int16> Block;
+
+		OutWithinBounds = true;
+
+		for (uint32 FirstFrame = 0; FirstFrame < NumFrames; FirstFrame += BlockFrames)
+		{
+			const uint32 NumBlockFrames = FMath::Min(BlockFrames, NumFrames - FirstFrame);
+			const uint32 MaxOutputFrames = Resampler.GetMaxOutputFrames(NumBlockFrames);
+
+			Block.Reset();
+			Block.AddUninitialized(MaxOutputFrames * OutputChannels);
+
+			const uint32 NumOutputFrames = Resampler.Process(Input.GetData() + FirstFrame * NumChannels, NumBlockFrames, Block.GetData());
+
+			OutWithinBounds &= (NumOutputFrames <= MaxOutputFrames);
+			Output.Append(Block.GetData(), FMath::Min(NumOutputFrames, MaxOutputFrames) * OutputChannels);
+		}
+
+		return Output;
+	}
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVlcMediaAudioResamplerTest, "System.Plugins.VlcMedia.AudioResampler", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+
+bool FVlcMediaAudioResamplerTest::RunTest(const FString& Parameters)
+{
+	FVlcMediaAudioResampler Resampler;
+	bool WithinBounds = false;
+
+	// unsupported formats
+	TestFalse(TEXT("Formats without channels are rejected"), Resampler.Configure(0, 48000, 2, 48000));
+	TestFalse(TEXT("Formats with too many channels are rejected"), Resampler.Configure(2, 48000, FVlcMediaAudioResampler::MaxChannels + 1, 48000));
+	TestFalse(TEXT("Formats without a sample rate are rejected"), Resampler.Configure(2, 0, 2, 48000));
+
+	// matching formats are converted to integers and clamped
+	{
+		TestTrue(TEXT("Matching formats are supported"), Resampler.Configure(2, 48000, 2, 48000));
+		TestTrue(TEXT("The configured formats are reported"), Resampler.IsConfiguredFor(2, 48000, 2, 48000));
+
+		// more samples than one SIMD batch, so that both code paths are covered
+		const float Input[] = { 0.0f, 0.25f, -0.25f, 1.0f, -1.0f, 1.5f, -1.5f, 0.0f, 0.25f, -0.25f, 1.0f, -1.0f };
+		const int16 Expected[] = { 0, 8192, -8192, 32767, -32767, 32767, -32767, 0, 8192, -8192, 32767, -32767 };
+		int16 Output[ARRAY_COUNT(Input)];
+
+		TestEqual(TEXT("Matching formats keep the number of frames"), (int32)Resampler.Process(Input, ARRAY_COUNT(Input) / 2, Output), (int32)ARRAY_COUNT(Input) / 2);
+		TestTrue(TEXT("Matching formats are converted sample by sample"), FMemory::Memcmp(Output, Expected, sizeof(Expected)) == 0);
+	}
+
+	// 5.1 is mixed to stereo with the center and surround channels at -3 dB, and without LFE
+	{
+		TestTrue(TEXT("5.1 to stereo is supported"), Resampler.Configure(6, 48000, 2, 48000));
+
+		const float Input[] = {
+			1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f,
+		};
+
+		const float Scale = 1.0f / (1.0f + 2.0f * 0.70710678f);
+		const int16 Front = (int16)FMath::RoundToInt(Scale * 32767.0f);
+		const int16 Side = (int16)FMath::RoundToInt(0.70710678f * Scale * 32767.0f);
+		const int16 Expected[] = { Front, 0, Side, Side, 0, Side, 0, 0 };
+		int16 Output[8];
+
+		TestEqual(TEXT("Mixing keeps the number of frames"), (int32)Resampler.Process(Input, 4, Output), 4);
+
+		bool Matches = true;
+
+		for (int32 Index = 0; Index < (int32)ARRAY_COUNT(Expected); ++Index)
+		{
+			Matches &= (FMath::Abs(Output[Index] - Expected[Index]) <= 1);
+		}
+
+		TestTrue(TEXT("5.1 is mixed with the expected gains"), Matches);
+	}
+
+	// mono is copied to all outputs
+	{
+		TestTrue(TEXT("Mono to stereo is supported"), Resampler.Configure(1, 48000, 2, 48000));
+
+		const float Input[] = { 0.25f, -0.25f };
+		int16 Output[4];
+
+		Resampler.Process(Input, 2, Output);
+		TestTrue(TEXT("Mono is copied to both channels"), (Output[0] == 8192) && (Output[1] == 8192) && (Output[2] == -8192) && (Output[3] == -8192));
+	}
+
+	// sample rate conversion
+	{
+		TestTrue(TEXT("44.1 kHz to 48 kHz is supported"), Resampler.Configure(2, 44100, 2, 48000));
+
+		const TArray<float> Tone = VlcMediaAudioResamplerTest::CreateTone(2, 44100, 44100);
+		const TArray<int16> Whole = VlcMediaAudioResamplerTest::Convert(Resampler, Tone, 2, 44100, 2, WithinBounds);
+
+		TestTrue(TEXT("Resampling produces at most the announced number of frames"), WithinBounds);
+		TestTrue(TEXT("One second of audio is resampled to one second of audio"), FMath::Abs(Whole.Num() / 2 - 48000) <= 4);
+
+		// the history carries the interpolation across blocks, so the block size must not matter
+		Resampler.Reset();
+
+		const TArray<int16> Blocks = VlcMediaAudioResamplerTest::Convert(Resampler, Tone, 2, 441, 2, WithinBounds);
+
+		TestTrue(TEXT("Resampling small blocks produces at most the announced number of frames"), WithinBounds);
+
+		if (TestEqual(TEXT("The block size does not change the number of frames"), Blocks.Num(), Whole.Num()))
+		{
+			int32 MaxDifference = 0;
+
+			for (int32 Index = 0; Index < Whole.Num(); ++Index)
+			{
+				MaxDifference = FMath::Max(MaxDifference, FMath::Abs(Whole[Index] - Blocks[Index]));
+			}
+
+			TestTrue(TEXT("The block size does not change the samples"), MaxDifference <= 1);
+		}
+
+		// a constant signal stays constant once the initial history has been replaced
+		Resampler.Reset();
+
+		TArray<float> Constant;
+		Constant.Init(0.25f, 2 * 1000);
+
+		const TArray<int16> Output = VlcMediaAudioResamplerTest::Convert(Resampler, Constant, 2, 100, 2, WithinBounds);
+		bool Flat = (Output.Num() > 16);
+
+		for (int32 Index = 8; Index < Output.Num(); ++Index)
+		{
+			Flat &= (Output[Index] == 8192);
+		}
+
+		TestTrue(TEXT("Constant signals are interpolated exactly"), Flat);
+
+		// resetting discards the history, so silence after a reset is silent
+		Resampler.Reset();
+
+		TArray<float> Silence;
+		Silence.AddZeroed(2 * 100);
+
+		const TArray<int16> AfterReset = VlcMediaAudioResamplerTest::Convert(Resampler, Silence, 2, 100, 2, WithinBounds);
+		bool Silent = true;
+
+		for (const int16 Sample : AfterReset)
+		{
+			Silent &= (Sample == 0);
+		}
+
+		TestTrue(TEXT("Resetting discards the history"), Silent);
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,428 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+#include "AutomationTest.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace VlcMediaBenchmarks
+{
+	/** Size of the blocks that are passed to the resampler (in frames, as delivered by libvlc's audio output). */
+	const uint32 ResamplerBlockFrames = 1024;
+
+	/** Number of seconds of audio to resample per configuration. */
+	const uint32 ResamplerSeconds = 60;
+
+	/** Number of scheduler ticks to measure per player count. */
+	const int32 SchedulerTicks = 120;
+
+	/** Maximum time to wait for players to start playing (in seconds). */
+	const double StartTimeout = 30.0;
+
+	/**
+	 * Create a libvlc instance for benchmarks, so that they do not interfere with the module's players.
+	 *
+	 * @return The instance, or nullptr if libvlc is not available.
+	 */
+	FLibvlcInstance* CreateInstance()
+	{
+		if (FVlc::New == nullptr)
+		{
+			return nullptr;
+		}
+
+		const FString PluginPath = FString(TEXT("--plugin-path=")) + FVlc::GetPluginDir();
+		const FTCHARToUTF8 PluginPathArg(*PluginPath);
+
+		const char* Args[] =
+		{
+			PluginPathArg.Get(),
+			"--aout", "amem",
+			"--intf", "dummy",
+			"--no-stats",
+			"--no-video-title-show",
+			"--no-xlib",
+			"--vout", "dummy",
+		};
+
+		return FVlc::New(sizeof(Args) / sizeof(*Args), Args);
+	}
+
+	/**
+	 * Write a 16 or 32 bit little-endian value into a buffer.
+	 *
+	 * @param Buffer The buffer to write to.
+	 * @param Offset The offset to write at.
+	 * @param Value The value to write.
+	 * @param Size The size of the value (in bytes).
+	 */
+	void WriteLittleEndian(TArray<uint8>& Buffer, int32 Offset, uint32 Value, int32 Size)
+	{
+		for (int32 Index = 0; Index < Size; ++Index)
+		{
+			Buffer[Offset + Index] = (uint8)(Value >> (Index * 8));
+		}
+	}
+
+	/**
+	 * Create a WAV file that contains a sine tone.
+	 *
+	 * @param NumChannels The number of channels.
+	 * @param SampleRate The sample rate.
+	 * @param NumSeconds The length of the tone.
+	 * @return The file contents.
+	 */
+	TSharedRef<TArray<uint8>, ESPMode::ThreadSafe> CreateWave(uint32 NumChannels, uint32 SampleRate, uint32 NumSeconds)
+	{
+		const uint32 NumFrames = SampleRate * NumSeconds;
+		const uint32 DataSize = NumFrames * NumChannels * sizeof(int16);
+
+		TSharedRef<TArray<uint8>, ESPMode::ThreadSafe> Wave = MakeShareable(new TArray<uint8>());
+		Wave->AddZeroed(44 + DataSize);
+
+		FMemory::Memcpy(Wave->GetData(), "RIFF", 4);
+		WriteLittleEndian(*Wave, 4, 36 + DataSize, 4);
+		FMemory::Memcpy(Wave->GetData() + 8, "WAVEfmt ", 8);
+		WriteLittleEndian(*Wave, 16, 16, 4);
+		WriteLittleEndian(*Wave, 20, 1, 2);
+		WriteLittleEndian(*Wave, 22, NumChannels, 2);
+		WriteLittleEndian(*Wave, 24, SampleRate, 4);
+		WriteLittleEndian(*Wave, 28, SampleRate * NumChannels * sizeof(int16), 4);
+		WriteLittleEndian(*Wave, 32, NumChannels * sizeof(int16), 2);
+		WriteLittleEndian(*Wave, 34, 16, 2);
+		FMemory::Memcpy(Wave->GetData() + 36, "data", 4);
+		WriteLittleEndian(*Wave, 40, DataSize, 4);
+
+		for (uint32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			const int16 Sample = (int16)(FMath::Sin(2.0f * PI * 440.0f * Frame / SampleRate) * 16384.0f);
+
+			for (uint32 Channel = 0; Channel < NumChannels; ++Channel)
+			{
+				WriteLittleEndian(*Wave, 44 + (Frame * NumChannels + Channel) * sizeof(int16), (uint16)Sample, 2);
+			}
+		}
+
+		return Wave;
+	}
+
+	/** Handles audio play callbacks from libvlc by dropping the samples. */
+	void HandleAudioPlay(void* /*Opaque*/, const void* /*Samples*/, uint32 /*Count*/, int64 /*Pts*/)
+	{ }
+
+	/**
+	 * Get the physical memory that the process uses.
+	 *
+	 * @return Memory (in bytes).
+	 */
+	int64 GetUsedPhysical()
+	{
+		return (int64)FPlatformMemory::GetStats().UsedPhysical;
+	}
+}
+
+
+/* Audio resampler
+ *****************************************************************************/
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVlcMediaAudioResamplerBenchmark, "System.Plugins.VlcMedia.Benchmarks.AudioResampler", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+
+bool FVlcMediaAudioResamplerBenchmark::RunTest(const FString& Parameters)
+{
+	struct FConfiguration
+	{
+		uint32 InputChannels;
+		uint32 OutputChannels;
+	};
+
+	// stereo is resampled as is, 5.1 is resampled as is and down-mixed to stereo
+	const FConfiguration Configurations[] = { { 2, 2 }, { 6, 6 }, { 6, 2 } };
+	const uint32 InputRate = 44100;
+	const uint32 OutputRate = 48000;
+
+	for (const FConfiguration& Configuration : Configurations)
+	{
+		FVlcMediaAudioResampler Resampler;
+
+		if (!TestTrue(TEXT("The resampler accepts the format"), Resampler.Configure(Configuration.InputChannels, InputRate, Configuration.OutputChannels, OutputRate)))
+		{
+			continue;
+		}
+
+		TArray<float> Input;
+		Input.AddUninitialized(VlcMediaBenchmarks::ResamplerBlockFrames * Configuration.InputChannels);
+
+		for (int32 Index = 0; Index < Input.Num(); ++Index)
+		{
+			Input[Index] = FMath::Sin(Index * 0.01f) * 0.5f;
+		}
+
+		TArray<int16> Output;
+		Output.AddUninitialized(Resampler.GetMaxOutputFrames(VlcMediaBenchmarks::ResamplerBlockFrames) * Configuration.OutputChannels);
+
+		const uint32 NumBlocks = VlcMediaBenchmarks::ResamplerSeconds * InputRate / VlcMediaBenchmarks::ResamplerBlockFrames;
+		uint64 NumOutputFrames = 0;
+
+		const double StartTime = FPlatformTime::Seconds();
+
+		for (uint32 Block = 0; Block < NumBlocks; ++Block)
+		{
+			NumOutputFrames += Resampler.Process(Input.GetData(), VlcMediaBenchmarks::ResamplerBlockFrames, Output.GetData());
+		}
+
+		const double Duration = FPlatformTime::Seconds() - StartTime;
+		const double AudioDuration = (double)NumBlocks * VlcMediaBenchmarks::ResamplerBlockFrames / InputRate;
+
+		// the output must cover the input, give or take the interpolation history
+		const uint64 ExpectedFrames = (uint64)(AudioDuration * OutputRate);
+		TestTrue(TEXT("The resampler produces the expected number of frames"), FMath::Abs((int64)NumOutputFrames - (int64)ExpectedFrames) <= 4);
+
+		AddLogItem(FString::Printf(TEXT("44.1k -> 48k, %u -> %u channels: %.2f ms for %.0f s of audio (%.0fx real time, %.1f ns per output frame)"),
+			Configuration.InputChannels, Configuration.OutputChannels,
+			Duration * 1000.0, AudioDuration, AudioDuration / FMath::Max(Duration, 1e-9),
+			Duration * 1e9 / FMath::Max<uint64>(NumOutputFrames, 1)));
+	}
+
+	return true;
+}
+
+
+/* Scheduler
+ *****************************************************************************/
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVlcMediaSchedulerBenchmark, "System.Plugins.VlcMedia.Benchmarks.Scheduler", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+
+bool FVlcMediaSchedulerBenchmark::RunTest(const FString& Parameters)
+{
+	FLibvlcInstance* VlcInstance = VlcMediaBenchmarks::CreateInstance();
+
+	if (VlcInstance == nullptr)
+	{
+		AddError(TEXT("libvlc is not available"));
+
+		return false;
+	}
+
+	// all players share the same in-memory media, so that only the scheduling and decoding costs are measured
+	const TSharedRef<TArray<uint8>, ESPMode::ThreadSafe> Wave = VlcMediaBenchmarks::CreateWave(2, 44100, 30);
+	const int32 PlayerCounts[] = { 1, 10, 100, 500 };
+
+	for (const int32 NumPlayers : PlayerCounts)
+	{
+		FVlcMediaPlayerPoolRef PlayerPool = MakeShareable(new FVlcMediaPlayerPool(VlcInstance, 0));
+		FVlcMediaSchedulerRef Scheduler = MakeShareable(new FVlcMediaScheduler(PlayerPool));
+		{
+			TArray<TSharedRef<FVlcMediaPlayer>> Players;
+
+			for (int32 Index = 0; Index < NumPlayers; ++Index)
+			{
+				TSharedRef<FVlcMediaPlayer> Player = MakeShareable(new FVlcMediaPlayer(VlcInstance, Scheduler, PlayerPool));
+				Players.Add(Player);
+			}
+
+			// closed players are not updated at all
+			double StartTime = FPlatformTime::Seconds();
+
+			for (int32 Tick = 0; Tick < VlcMediaBenchmarks::SchedulerTicks; ++Tick)
+			{
+				Scheduler->Tick();
+			}
+
+			const double IdleDuration = FPlatformTime::Seconds() - StartTime;
+
+			for (const TSharedRef<FVlcMediaPlayer>& Player : Players)
+			{
+				Player->Open(Wave, TEXT("benchmark.wav"));
+			}
+
+			// wait for all players to start playing
+			int32 NumPlaying = 0;
+			StartTime = FPlatformTime::Seconds();
+
+			while ((NumPlaying < NumPlayers) && (FPlatformTime::Seconds() - StartTime < VlcMediaBenchmarks::StartTimeout))
+			{
+				Scheduler->Tick();
+				FPlatformProcess::Sleep(0.01f);
+
+				NumPlaying = 0;
+
+				for (const TSharedRef<FVlcMediaPlayer>& Player : Players)
+				{
+					if (Player->HasTracksToTick())
+					{
+						++NumPlaying;
+					}
+				}
+			}
+
+			if (!TestEqual(FString::Printf(TEXT("All %i players are playing"), NumPlayers), NumPlaying, NumPlayers))
+			{
+				continue;
+			}
+
+			// ticks are spaced like frames, so that the tracks have audio to process
+			double ActiveDuration = 0.0;
+			double MaxTickDuration = 0.0;
+
+			for (int32 Tick = 0; Tick < VlcMediaBenchmarks::SchedulerTicks; ++Tick)
+			{
+				FPlatformProcess::Sleep(1.0f / 60.0f);
+
+				const double TickStartTime = FPlatformTime::Seconds();
+				Scheduler->Tick();
+				const double TickDuration = FPlatformTime::Seconds() - TickStartTime;
+
+				ActiveDuration += TickDuration;
+				MaxTickDuration = FMath::Max(MaxTickDuration, TickDuration);
+			}
+
+			AddLogItem(FString::Printf(TEXT("%i players: %.3f ms per tick while closed, %.3f ms per tick while playing (%.1f us per player, %.3f ms worst tick)"),
+				NumPlayers,
+				IdleDuration * 1000.0 / VlcMediaBenchmarks::SchedulerTicks,
+				ActiveDuration * 1000.0 / VlcMediaBenchmarks::SchedulerTicks,
+				ActiveDuration * 1e6 / (VlcMediaBenchmarks::SchedulerTicks * NumPlayers),
+				MaxTickDuration * 1000.0));
+		}
+
+		// the players hand their libvlc players to the pool when they are destroyed
+		Scheduler->Shutdown();
+		PlayerPool->Shutdown();
+	}
+
+	FVlc::Release(VlcInstance);
+
+	return true;
+}
+
+
+/* Engine file system source
+ *****************************************************************************/
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVlcMediaFileSourceBenchmark, "System.Plugins.VlcMedia.Benchmarks.FileSource", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+
+bool FVlcMediaFileSourceBenchmark::RunTest(const FString& Parameters)
+{
+	FLibvlcInstance* VlcInstance = VlcMediaBenchmarks::CreateInstance();
+
+	if (VlcInstance == nullptr)
+	{
+		AddError(TEXT("libvlc is not available"));
+
+		return false;
+	}
+
+	// a long stereo file, so that loading it up front is noticeable (about 100 MB)
+	const FString FilePath = FPaths::Combine(*FPaths::AutomationTransientDir(), TEXT("VlcMediaFileSourceBenchmark.wav"));
+
+	if (!TestTrue(TEXT("The benchmark media is written"), FFileHelper::SaveArrayToFile(*VlcMediaBenchmarks::CreateWave(2, 44100, 600), *FilePath)))
+	{
+		FVlc::Release(VlcInstance);
+
+		return false;
+	}
+
+	for (int32 Pass = 0; Pass < 2; ++Pass)
+	{
+		const bool UseBuffer = (Pass == 0);
+		const int64 StartMemory = VlcMediaBenchmarks::GetUsedPhysical();
+		const double StartTime = FPlatformTime::Seconds();
+
+		int64 PeakMemory = StartMemory;
+		FVlcMediaSourcePtr Source;
+
+		// the buffer path is what games had to do before: load the whole file and open it from memory
+		if (UseBuffer)
+		{
+			TSharedRef<TArray<uint8>, ESPMode::ThreadSafe> Buffer = MakeShareable(new TArray<uint8>());
+
+			if (!TestTrue(TEXT("The media is loaded"), FFileHelper::LoadFileToArray(*Buffer, *FilePath)))
+			{
+				continue;
+			}
+
+			Source = MakeShareable(new FVlcMediaBufferSource(Buffer));
+		}
+		else
+		{
+			IFileHandle* FileHandle = FPlatformFileManager::Get().GetPlatformFile().OpenRead(*FilePath);
+
+			if (!TestNotNull(TEXT("The media is opened"), FileHandle))
+			{
+				continue;
+			}
+
+			TSharedRef<FVlcMediaPrefetchReader, ESPMode::ThreadSafe> Reader = MakeShareable(new FVlcMediaFileHandleReader(FileHandle, (uint64)FileHandle->Size(), FVlcMediaPrefetchOptions()));
+			Reader->Start();
+
+			Source = MakeShareable(new FVlcMediaPrefetchSource(Reader));
+		}
+
+		FLibvlcMedia* Media = FVlcMediaSource::CreateMedia(VlcInstance, Source.ToSharedRef());
+		FLibvlcMediaPlayer* Player = (Media != nullptr) ? FVlc::MediaPlayerNewFromMedia(Media) : nullptr;
+
+		if (Media != nullptr)
+		{
+			FVlc::MediaRelease(Media);
+		}
+
+		if (!TestNotNull(TEXT("The player is created"), Player))
+		{
+			continue;
+		}
+
+		// the media has no video, and its audio is dropped
+		FVlc::AudioSetCallbacks(Player, &VlcMediaBenchmarks::HandleAudioPlay, nullptr, nullptr, nullptr, nullptr, nullptr);
+		FVlc::AudioSetFormat(Player, "S16N", 44100, 2);
+		FVlc::MediaPlayerPlay(Player);
+
+		// the media is ready when it starts playing
+		ELibvlcState PlayerState = ELibvlcState::NothingSpecial;
+
+		while ((FPlatformTime::Seconds() - StartTime) < VlcMediaBenchmarks::StartTimeout)
+		{
+			PlayerState = FVlc::MediaPlayerGetState(Player);
+
+			if ((PlayerState == ELibvlcState::Playing) || (PlayerState == ELibvlcState::Error))
+			{
+				break;
+			}
+
+			PeakMemory = FMath::Max(PeakMemory, VlcMediaBenchmarks::GetUsedPhysical());
+			FPlatformProcess::Sleep(0.001f);
+		}
+
+		const double StartupLatency = FPlatformTime::Seconds() - StartTime;
+
+		// memory is sampled while playing as well, because the cache fills up after playback started
+		const double PlayStartTime = FPlatformTime::Seconds();
+
+		while ((FPlatformTime::Seconds() - PlayStartTime) < 2.0)
+		{
+			PeakMemory = FMath::Max(PeakMemory, VlcMediaBenchmarks::GetUsedPhysical());
+			FPlatformProcess::Sleep(0.01f);
+		}
+
+		FVlc::MediaPlayerStop(Player);
+		FVlc::MediaPlayerRelease(Player);
+		Source.Reset();
+
+		if (TestEqual(TEXT("The media plays"), (int32)PlayerState, (int32)ELibvlcState::Playing))
+		{
+			AddLogItem(FString::Printf(TEXT("%s: %.1f ms until playing, %.1f MB peak memory increase"),
+				UseBuffer ? TEXT("Loaded into memory") : TEXT("Streamed through the engine's file system"),
+				StartupLatency * 1000.0,
+				(PeakMemory - StartMemory) / (1024.0 * 1024.0)));
+		}
+	}
+
+	IFileManager::Get().Delete(*FilePath);
+	FVlc::Release(VlcInstance);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,175 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+#include "AutomationTest.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace VlcMediaBoundedQueueTest
+{
+	/** Number of elements that each thread passes through the queue in the concurrent test. */
+	const int32 NumConcurrentElements = 100000;
+
+	/**
+	 * Enqueues a range of numbers on its own thread.
+	 */
+	class FProducer
+		: public FRunnable
+	{
+	public:
+
+		/**
+		 * Creates and initializes a new instance.
+		 *
+		 * @param InQueue The queue to fill.
+		 * @param InFirst The first number to enqueue.
+		 */
+		FProducer(TVlcMediaBoundedQueue<int32>& InQueue, int32 InFirst)
+			: First(InFirst)
+			, Queue(InQueue)
+		{ }
+
+	public:
+
+		// FRunnable interface
+
+		virtual uint32 Run() override
+		{
+			for (int32 Number = First; Number < First + NumConcurrentElements; ++Number)
+			{
+				while (!Queue.Enqueue(Number))
+				{
+					FPlatformProcess::Sleep(0.0f);
+				}
+			}
+
+			return 0;
+		}
+
+	private:
+
+		/** The first number to enqueue. */
+		int32 First;
+
+		/** The queue to fill. */
+		TVlcMediaBoundedQueue<int32>& Queue;
+	};
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVlcMediaBoundedQueueTest, "System.Plugins.VlcMedia.BoundedQueue", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+
+bool FVlcMediaBoundedQueueTest::RunTest(const FString& Parameters)
+{
+	// capacity, ordering and wraparound
+	{
+		TVlcMediaBoundedQueue<int32> Queue(3);
+		TestEqual(TEXT("The capacity is rounded up to a power of two"), (int32)Queue.GetCapacity(), 4);
+
+		int32 Element = 0;
+		TestFalse(TEXT("Empty queues cannot be dequeued"), Queue.Dequeue(Element));
+
+		int32 NextIn = 0;
+		int32 NextOut = 0;
+
+		// the positions wrap around the cells many times
+		for (int32 Round = 0; Round < 100; ++Round)
+		{
+			while (Queue.Enqueue(NextIn))
+			{
+				++NextIn;
+			}
+
+			if (!TestEqual(TEXT("Full queues hold as many elements as their capacity"), Queue.Num(), 4))
+			{
+				break;
+			}
+
+			// leave some elements behind, so that the queue does not start at the same cell every round
+			const int32 NumToDequeue = 1 + (Round % 4);
+
+			for (int32 Index = 0; Index < NumToDequeue; ++Index)
+			{
+				if (!Queue.Dequeue(Element) || !TestEqual(TEXT("Elements are dequeued in order"), Element, NextOut))
+				{
+					break;
+				}
+
+				++NextOut;
+			}
+		}
+
+		while (Queue.Dequeue(Element))
+		{
+			TestEqual(TEXT("Remaining elements are dequeued in order"), Element, NextOut++);
+		}
+
+		TestEqual(TEXT("All elements were dequeued"), NextOut, NextIn);
+		TestEqual(TEXT("Drained queues are empty"), Queue.Num(), 0);
+	}
+
+	// dequeued cells release their elements
+	{
+		TVlcMediaBoundedQueue<TSharedPtr<int32>> Queue(2);
+		TSharedPtr<int32> Shared = MakeShareable(new int32(1));
+
+		Queue.Enqueue(Shared);
+
+		TSharedPtr<int32> Element;
+		Queue.Dequeue(Element);
+		Element.Reset();
+
+		TestTrue(TEXT("The queue does not keep references to dequeued elements"), Shared.IsUnique());
+	}
+
+	// concurrent producers and consumer
+	{
+		TVlcMediaBoundedQueue<int32> Queue(64);
+
+		VlcMediaBoundedQueueTest::FProducer FirstProducer(Queue, 0);
+		VlcMediaBoundedQueueTest::FProducer SecondProducer(Queue, VlcMediaBoundedQueueTest::NumConcurrentElements);
+
+		FRunnableThread* FirstThread = FRunnableThread::Create(&FirstProducer, TEXT("VlcMediaBoundedQueueTest1"));
+		FRunnableThread* SecondThread = FRunnableThread::Create(&SecondProducer, TEXT("VlcMediaBoundedQueueTest2"));
+
+		// each producer's numbers must arrive in the order they were enqueued, and none may be lost
+		int32 NextFirst = 0;
+		int32 NextSecond = VlcMediaBoundedQueueTest::NumConcurrentElements;
+		int32 NumReceived = 0;
+		bool Ordered = true;
+
+		const double StartTime = FPlatformTime::Seconds();
+
+		while ((NumReceived < 2 * VlcMediaBoundedQueueTest::NumConcurrentElements) && (FPlatformTime::Seconds() - StartTime < 30.0))
+		{
+			int32 Element = 0;
+
+			if (!Queue.Dequeue(Element))
+			{
+				FPlatformProcess::Sleep(0.0f);
+
+				continue;
+			}
+
+			int32& Next = (Element < VlcMediaBoundedQueueTest::NumConcurrentElements) ? NextFirst : NextSecond;
+			Ordered &= (Element == Next);
+			Next = Element + 1;
+			++NumReceived;
+		}
+
+		FirstThread->WaitForCompletion();
+		SecondThread->WaitForCompletion();
+
+		delete FirstThread;
+		delete SecondThread;
+
+		TestEqual(TEXT("All concurrently enqueued elements are received"), NumReceived, 2 * VlcMediaBoundedQueueTest::NumConcurrentElements);
+		TestTrue(TEXT("Elements of each producer are received in order"), Ordered);
+	}
+
+	return true;
+}
+
+#endif
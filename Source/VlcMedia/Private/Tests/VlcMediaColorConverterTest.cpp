@@ -0,0 +1,190 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+#include "AutomationTest.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace VlcMediaColorConverterTest
+{
+	/** Frame sizes to test (odd sizes exercise the scalar tails of the SIMD code paths). */
+	const FIntPoint Dimensions[] =
+	{
+		FIntPoint(1, 1),
+		FIntPoint(2, 2),
+		FIntPoint(3, 5),
+		FIntPoint(7, 3),
+		FIntPoint(15, 9),
+		FIntPoint(17, 7),
+		FIntPoint(33, 11),
+		FIntPoint(63, 4),
+		FIntPoint(97, 13),
+	};
+
+	/** Number of bytes past the end of each destination row that must not be written. */
+	const uint32 DestPadding = 16;
+
+	/** Value of the destination padding bytes. */
+	const uint8 DestPaddingValue = 0xcd;
+
+	/**
+	 * Get the layout of a YUV 4:2:0 frame with padded rows.
+	 *
+	 * @param Chroma The pixel format (must be I420 or NV12).
+	 * @param Size The dimensions of the frame.
+	 * @return The layout.
+	 */
+	FVlcMediaVideoLayout GetLayout(EVlcMediaVideoChroma Chroma, const FIntPoint& Size)
+	{
+		const uint32 ChromaWidth = (Size.X + 1) / 2;
+		const uint32 ChromaLines = (Size.Y + 1) / 2;
+
+		FVlcMediaVideoLayout Layout;
+		{
+			Layout.Chroma = Chroma;
+			Layout.Dimensions = Size;
+			Layout.NumPlanes = (Chroma == EVlcMediaVideoChroma::Nv12) ? 2 : 3;
+		}
+
+		for (int32 PlaneIndex = 0; PlaneIndex < Layout.NumPlanes; ++PlaneIndex)
+		{
+			FVlcMediaVideoPlane& Plane = Layout.Planes[PlaneIndex];
+			{
+				Plane.Offset = Layout.BufferSize;
+				Plane.Lines = (PlaneIndex == 0) ? Size.Y : ChromaLines;
+
+				if (PlaneIndex == 0)
+				{
+					Plane.Pitch = Align(Size.X, 32);
+				}
+				else
+				{
+					Plane.Pitch = Align((Chroma == EVlcMediaVideoChroma::Nv12) ? ChromaWidth * 2 : ChromaWidth, 32);
+				}
+			}
+
+			Layout.BufferSize += Plane.Pitch * Plane.Lines;
+		}
+
+		return Layout;
+	}
+
+	/**
+	 * Get the name of a SIMD level for log messages.
+	 *
+	 * @param Level The SIMD level.
+	 * @return The name.
+	 */
+	const TCHAR* GetSimdLevelName(EVlcMediaSimdLevel Level)
+	{
+		switch (Level)
+		{
+		case EVlcMediaSimdLevel::Sse2: return TEXT("SSE2");
+		case EVlcMediaSimdLevel::Ssse3: return TEXT("SSSE3");
+		case EVlcMediaSimdLevel::Avx2: return TEXT("AVX2");
+		default: return TEXT("scalar");
+		}
+	}
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVlcMediaColorConverterTest, "System.Plugins.VlcMedia.ColorConverter", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+
+bool FVlcMediaColorConverterTest::RunTest(const FString& Parameters)
+{
+	const EVlcMediaSimdLevel SupportedLevel = FVlcMediaColorConverter::GetSupportedSimdLevel();
+	const EVlcMediaSimdLevel Levels[] = { EVlcMediaSimdLevel::Sse2, EVlcMediaSimdLevel::Ssse3, EVlcMediaSimdLevel::Avx2 };
+	const EVlcMediaVideoChroma Chromas[] = { EVlcMediaVideoChroma::I420, EVlcMediaVideoChroma::Nv12 };
+	const EVlcMediaColorMatrix Matrices[] = { EVlcMediaColorMatrix::Bt601, EVlcMediaColorMatrix::Bt709 };
+	const EVlcMediaColorRange Ranges[] = { EVlcMediaColorRange::Limited, EVlcMediaColorRange::Full };
+
+	AddLogItem(FString::Printf(TEXT("Highest supported SIMD level: %s"), VlcMediaColorConverterTest::GetSimdLevelName(SupportedLevel)));
+
+	// a fixed seed keeps failures reproducible
+	FRandomStream Random(0x564c43);
+
+	TArray<uint8> Source;
+	TArray<uint8> Expected;
+	TArray<uint8> Actual;
+
+	for (const EVlcMediaVideoChroma Chroma : Chromas)
+	{
+		for (const FIntPoint& Size : VlcMediaColorConverterTest::Dimensions)
+		{
+			const FVlcMediaVideoLayout Layout = VlcMediaColorConverterTest::GetLayout(Chroma, Size);
+			const uint32 DestPitch = Size.X * 4 + VlcMediaColorConverterTest::DestPadding;
+
+			// random samples cover out of range values that need clamping
+			Source.SetNumUninitialized(Layout.BufferSize);
+
+			for (uint8& Value : Source)
+			{
+				Value = (uint8)Random.RandHelper(256);
+			}
+
+			for (const EVlcMediaColorMatrix Matrix : Matrices)
+			{
+				for (const EVlcMediaColorRange Range : Ranges)
+				{
+					FVlcMediaColorConverter Reference;
+					{
+						Reference.SetColorSpace(Matrix, Range);
+						Reference.SetSimdLevel(EVlcMediaSimdLevel::Scalar);
+					}
+
+					Expected.Init(VlcMediaColorConverterTest::DestPaddingValue, DestPitch * Size.Y);
+					TestTrue(TEXT("Scalar conversion succeeds"), Reference.Convert(Layout, Source.GetData(), Expected.GetData(), DestPitch));
+
+					for (const EVlcMediaSimdLevel Level : Levels)
+					{
+						if (Level > SupportedLevel)
+						{
+							continue;
+						}
+
+						FVlcMediaColorConverter Converter;
+						{
+							Converter.SetColorSpace(Matrix, Range);
+							Converter.SetSimdLevel(Level);
+						}
+
+						const FString Context = FString::Printf(TEXT("%s %s %ix%i (matrix %i, range %i)"),
+							VlcMediaColorConverterTest::GetSimdLevelName(Level),
+							(Chroma == EVlcMediaVideoChroma::Nv12) ? TEXT("NV12") : TEXT("I420"),
+							Size.X, Size.Y, (int32)Matrix, (int32)Range);
+
+						if (!TestEqual(FString::Printf(TEXT("%s uses the requested SIMD level"), *Context), (int32)Converter.GetSimdLevel(), (int32)Level))
+						{
+							continue;
+						}
+
+						Actual.Init(VlcMediaColorConverterTest::DestPaddingValue, DestPitch * Size.Y);
+
+						if (!TestTrue(FString::Printf(TEXT("%s conversion succeeds"), *Context), Converter.Convert(Layout, Source.GetData(), Actual.GetData(), DestPitch)))
+						{
+							continue;
+						}
+
+						// the padding is compared as well, so that writes past the end of a row are caught
+						for (int32 Index = 0; Index < Expected.Num(); ++Index)
+						{
+							if (Actual[Index] != Expected[Index])
+							{
+								AddError(FString::Printf(TEXT("%s differs from the scalar result at pixel (%i, %i), byte %i: %i instead of %i"),
+									*Context, (Index % DestPitch) / 4, Index / DestPitch, Index % 4, Actual[Index], Expected[Index]));
+
+								break;
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+#endif
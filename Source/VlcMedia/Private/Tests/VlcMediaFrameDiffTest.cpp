@@ -0,0 +1,146 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+#include "AutomationTest.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace VlcMediaFrameDiffTest
+{
+	/**
+	 * Get the layout of a frame with padded rows.
+	 *
+	 * @param Chroma The pixel format.
+	 * @param Size The dimensions of the frame.
+	 * @return The layout.
+	 */
+	FVlcMediaVideoLayout GetLayout(EVlcMediaVideoChroma Chroma, const FIntPoint& Size)
+	{
+		FVlcMediaVideoLayout Layout;
+		{
+			Layout.Chroma = Chroma;
+			Layout.Dimensions = Size;
+			Layout.NumPlanes = (Chroma == EVlcMediaVideoChroma::Rv32) ? 1 : ((Chroma == EVlcMediaVideoChroma::Nv12) ? 2 : 3);
+		}
+
+		for (int32 PlaneIndex = 0; PlaneIndex < Layout.NumPlanes; ++PlaneIndex)
+		{
+			FVlcMediaVideoPlane& Plane = Layout.Planes[PlaneIndex];
+			uint32 RowSize = Size.X;
+
+			if (Chroma == EVlcMediaVideoChroma::Rv32)
+			{
+				RowSize = Size.X * 4;
+			}
+			else if (PlaneIndex > 0)
+			{
+				RowSize = (Chroma == EVlcMediaVideoChroma::Nv12) ? ((Size.X + 1) / 2) * 2 : (Size.X + 1) / 2;
+			}
+
+			Plane.Offset = Layout.BufferSize;
+			Plane.Lines = ((Chroma == EVlcMediaVideoChroma::Rv32) || (PlaneIndex == 0)) ? Size.Y : (Size.Y + 1) / 2;
+			Plane.Pitch = Align(RowSize + 1, 32);
+
+			Layout.BufferSize += Plane.Pitch * Plane.Lines;
+		}
+
+		return Layout;
+	}
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVlcMediaFrameDiffTest, "System.Plugins.VlcMedia.FrameDiff", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+
+bool FVlcMediaFrameDiffTest::RunTest(const FString& Parameters)
+{
+	TArray<FIntRect> DirtyRects;
+	int32 NumTiles = 0;
+
+	// RGB frames with three by two tiles, where the last column and row are partial
+	{
+		const FVlcMediaVideoLayout Layout = VlcMediaFrameDiffTest::GetLayout(EVlcMediaVideoChroma::Rv32, FIntPoint(150, 100));
+		const FVlcMediaVideoPlane& Plane = Layout.Planes[0];
+
+		TArray<uint8> Previous;
+		Previous.AddZeroed(Layout.BufferSize);
+
+		TArray<uint8> Current = Previous;
+
+		TestEqual(TEXT("Identical frames have no changed tiles"), FVlcMediaFrameDiff::Compare(Layout, Current.GetData(), Previous.GetData(), false, DirtyRects, NumTiles), 0);
+		TestEqual(TEXT("Partial tiles are counted"), NumTiles, 6);
+		TestEqual(TEXT("Identical frames have no dirty rectangles"), DirtyRects.Num(), 0);
+
+		// the padding after each row is not part of the image
+		Current[Plane.Pitch - 1] = 0xff;
+		TestEqual(TEXT("Changes in the row padding are ignored"), FVlcMediaFrameDiff::Compare(Layout, Current.GetData(), Previous.GetData(), false, DirtyRects, NumTiles), 0);
+		Current = Previous;
+
+		// one pixel in the middle tile of the first row
+		Current[10 * Plane.Pitch + 100 * 4 + 2] = 0xff;
+		TestEqual(TEXT("A changed pixel changes its tile"), FVlcMediaFrameDiff::Compare(Layout, Current.GetData(), Previous.GetData(), false, DirtyRects, NumTiles), 1);
+
+		if (TestEqual(TEXT("A changed tile has one dirty rectangle"), DirtyRects.Num(), 1))
+		{
+			TestTrue(TEXT("The dirty rectangle covers the changed tile"), DirtyRects[0] == FIntRect(64, 0, 128, 64));
+		}
+
+		// the last pixel of the frame, in the partial tile
+		Current = Previous;
+		Current[99 * Plane.Pitch + 149 * 4] = 0xff;
+		TestEqual(TEXT("Changes in partial tiles are detected"), FVlcMediaFrameDiff::Compare(Layout, Current.GetData(), Previous.GetData(), false, DirtyRects, NumTiles), 1);
+
+		if (TestEqual(TEXT("A changed partial tile has one dirty rectangle"), DirtyRects.Num(), 1))
+		{
+			TestTrue(TEXT("The dirty rectangle is clipped to the frame"), DirtyRects[0] == FIntRect(128, 64, 150, 100));
+		}
+
+		// two adjacent tiles in the second row, and one in the first
+		Current = Previous;
+		Current[0] = 0xff;
+		Current[70 * Plane.Pitch + 10 * 4] = 0xff;
+		Current[70 * Plane.Pitch + 80 * 4] = 0xff;
+		TestEqual(TEXT("Every changed tile is counted"), FVlcMediaFrameDiff::Compare(Layout, Current.GetData(), Previous.GetData(), false, DirtyRects, NumTiles), 3);
+
+		if (TestEqual(TEXT("Adjacent changed tiles in a row are merged"), DirtyRects.Num(), 2))
+		{
+			TestTrue(TEXT("The first dirty rectangle covers the first row's tile"), DirtyRects[0] == FIntRect(0, 0, 64, 64));
+			TestTrue(TEXT("The second dirty rectangle covers both tiles of the second row"), DirtyRects[1] == FIntRect(0, 64, 128, 100));
+		}
+
+		TestEqual(TEXT("Comparing can stop at the first change"), FVlcMediaFrameDiff::Compare(Layout, Current.GetData(), Previous.GetData(), true, DirtyRects, NumTiles), 1);
+	}
+
+	// odd sized YUV frames, where the last chroma sample covers a single luma column and row
+	const EVlcMediaVideoChroma Chromas[] = { EVlcMediaVideoChroma::I420, EVlcMediaVideoChroma::Nv12 };
+
+	for (const EVlcMediaVideoChroma Chroma : Chromas)
+	{
+		const FVlcMediaVideoLayout Layout = VlcMediaFrameDiffTest::GetLayout(Chroma, FIntPoint(129, 65));
+		const FVlcMediaVideoPlane& LastPlane = Layout.Planes[Layout.NumPlanes - 1];
+
+		TArray<uint8> Previous;
+		Previous.AddZeroed(Layout.BufferSize);
+
+		TArray<uint8> Current = Previous;
+
+		// the V sample of the last chroma column and row
+		const uint32 LastSample = (Chroma == EVlcMediaVideoChroma::Nv12) ? 64 * 2 + 1 : 64;
+		Current[LastPlane.Offset + 32 * LastPlane.Pitch + LastSample] = 0xff;
+
+		const FString Context = (Chroma == EVlcMediaVideoChroma::Nv12) ? TEXT("NV12") : TEXT("I420");
+
+		TestEqual(FString::Printf(TEXT("%s: changes in the last chroma sample are detected"), *Context), FVlcMediaFrameDiff::Compare(Layout, Current.GetData(), Previous.GetData(), false, DirtyRects, NumTiles), 1);
+		TestEqual(FString::Printf(TEXT("%s: partial tiles are counted"), *Context), NumTiles, 6);
+
+		if (TestEqual(FString::Printf(TEXT("%s: a changed chroma sample has one dirty rectangle"), *Context), DirtyRects.Num(), 1))
+		{
+			TestTrue(FString::Printf(TEXT("%s: the dirty rectangle covers the last tile"), *Context), DirtyRects[0] == FIntRect(128, 64, 129, 65));
+		}
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,50 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+#include "AutomationTest.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVlcMediaLoopDetectorTest, "System.Plugins.VlcMedia.LoopDetector", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+
+bool FVlcMediaLoopDetectorTest::RunTest(const FString& Parameters)
+{
+	// ten seconds of media, with playback times reported every quarter second
+	const int64 Length = 10000;
+
+	FVlcMediaLoopDetector Detector;
+	double Latency = -1.0;
+
+	TestFalse(TEXT("The first report is not a wrap"), Detector.Detect(9800, Length, 100.0, Latency));
+	TestFalse(TEXT("Playback moving forward is not a wrap"), Detector.Detect(9900, Length, 100.1, Latency));
+
+	// 100 ms before and 150 ms after the wrap were played in 0.5 s
+	TestTrue(TEXT("Jumping from the end to the start is a wrap"), Detector.Detect(150, Length, 100.6, Latency));
+	TestTrue(TEXT("The transition latency excludes the media time that was played"), FMath::Abs(Latency - 0.25) < 0.001);
+
+	TestFalse(TEXT("Playback after a wrap is not a wrap"), Detector.Detect(400, Length, 100.85, Latency));
+
+	// reports that arrive faster than the media plays never have a negative latency
+	Detector.Detect(9990, Length, 110.0, Latency);
+	TestTrue(TEXT("Quick wraps are detected"), Detector.Detect(500, Length, 110.1, Latency));
+	TestTrue(TEXT("Quick wraps have no latency"), Latency == 0.0);
+
+	// short jumps backwards are seeks, not wraps
+	Detector.Detect(6000, Length, 120.0, Latency);
+	TestFalse(TEXT("Seeking back less than half the media is not a wrap"), Detector.Detect(2000, Length, 120.1, Latency));
+
+	// without a length, jumps cannot be told apart from seeks
+	Detector.Detect(9900, 0, 130.0, Latency);
+	TestFalse(TEXT("Media without a length never wraps"), Detector.Detect(100, 0, 130.1, Latency));
+
+	// resetting forgets the previous media
+	Detector.Detect(9900, Length, 140.0, Latency);
+	Detector.Reset();
+	TestFalse(TEXT("The first report after resetting is not a wrap"), Detector.Detect(100, Length, 140.1, Latency));
+
+	return true;
+}
+
+#endif
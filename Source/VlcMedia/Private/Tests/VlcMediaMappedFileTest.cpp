@@ -0,0 +1,79 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+#include "AutomationTest.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVlcMediaMappedFileTest, "System.Plugins.VlcMedia.MappedFile", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+
+bool FVlcMediaMappedFileTest::RunTest(const FString& Parameters)
+{
+	const FString FilePath = FPaths::ConvertRelativePathToFull(FPaths::Combine(*FPaths::AutomationTransientDir(), TEXT("VlcMediaMappedFileTest.bin")));
+	const FString EmptyFilePath = FPaths::ConvertRelativePathToFull(FPaths::Combine(*FPaths::AutomationTransientDir(), TEXT("VlcMediaMappedFileTest.empty")));
+
+	// a few pages plus a partial one
+	TArray<uint8> Contents;
+	Contents.AddUninitialized(3 * 65536 + 100);
+
+	for (int32 Index = 0; Index < Contents.Num(); ++Index)
+	{
+		Contents[Index] = (uint8)((Index * 7) ^ (Index >> 8));
+	}
+
+	if (!TestTrue(TEXT("The test file is written"), FFileHelper::SaveArrayToFile(Contents, *FilePath)) ||
+		!TestTrue(TEXT("The empty test file is written"), FFileHelper::SaveArrayToFile(TArray<uint8>(), *EmptyFilePath)))
+	{
+		return false;
+	}
+
+	{
+		TSharedRef<FVlcMediaMappedFile, ESPMode::ThreadSafe> MappedFile = MakeShareable(new FVlcMediaMappedFile(FilePath));
+
+		if (TestTrue(TEXT("Files are mapped"), MappedFile->IsValid()))
+		{
+			TestTrue(TEXT("Mapped files have the size of the file"), MappedFile->GetSize() == (SIZE_T)Contents.Num());
+			TestTrue(TEXT("Mapped files have the contents of the file"), FMemory::Memcmp(MappedFile->GetData(), Contents.GetData(), Contents.Num()) == 0);
+
+			// several players can map the same file
+			FVlcMediaMappedFile OtherMappedFile(FilePath);
+			TestTrue(TEXT("Mapped files can be mapped again"), OtherMappedFile.IsValid() && (FMemory::Memcmp(OtherMappedFile.GetData(), Contents.GetData(), Contents.Num()) == 0));
+
+			// the read-ahead cache reads mapped files on its worker thread
+			FVlcMediaPrefetchOptions Options;
+			Options.BlockSize = 65536;
+			Options.NumBlocks = 2;
+
+			FVlcMediaMappedFileReader Reader(MappedFile, Options);
+			Reader.Start();
+
+			TArray<uint8> ReadContents;
+			ReadContents.AddUninitialized(Contents.Num());
+
+			SIZE_T Position = 0;
+			SSIZE_T Result = 0;
+
+			do
+			{
+				Result = Reader.Read(Position, ReadContents.GetData() + Position, ReadContents.Num() - Position);
+			}
+			while (Result > 0);
+
+			TestEqual(TEXT("Reading mapped files ends at the end of the file"), (int32)Result, 0);
+			TestTrue(TEXT("Mapped files are read through the cache"), (Position == (SIZE_T)Contents.Num()) && (ReadContents == Contents));
+		}
+	}
+
+	// files that cannot be mapped
+	TestFalse(TEXT("Empty files are not mapped"), FVlcMediaMappedFile(EmptyFilePath).IsValid());
+	TestFalse(TEXT("Missing files are not mapped"), FVlcMediaMappedFile(FilePath + TEXT(".missing")).IsValid());
+
+	IFileManager::Get().Delete(*FilePath);
+	IFileManager::Get().Delete(*EmptyFilePath);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,107 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+#include "AutomationTest.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace VlcMediaPendingPicturesTest
+{
+	/**
+	 * Simulate libvlc's lock and unlock callbacks for a picture.
+	 *
+	 * @param Pool The pool to take the picture's sample from.
+	 * @param PendingPictures The pictures that wait to be displayed.
+	 * @return The picture, as passed to the display callback.
+	 */
+	FVlcMediaSample* DecodePicture(FVlcMediaSamplePool& Pool, FVlcMediaPendingPictures& PendingPictures)
+	{
+		FVlcMediaSample* Picture = nullptr;
+		{
+			TRefCountPtr<FVlcMediaSample> Sample = Pool.Acquire();
+
+			// libvlc's reference
+			Sample->AddRef();
+			Picture = Sample.GetReference();
+		}
+
+		PendingPictures.Add(Picture);
+		Picture->Release();
+
+		return Picture;
+	}
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVlcMediaPendingPicturesTest, "System.Plugins.VlcMedia.PendingPictures", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+
+bool FVlcMediaPendingPicturesTest::RunTest(const FString& Parameters)
+{
+	TSharedRef<FVlcMediaSamplePool, ESPMode::ThreadSafe> Pool = MakeShareable(new FVlcMediaSamplePool(64, 4));
+
+	// a decoded picture keeps its buffer until it is displayed
+	{
+		FVlcMediaPendingPictures PendingPictures(3);
+		FVlcMediaSample* Picture = VlcMediaPendingPicturesTest::DecodePicture(*Pool, PendingPictures);
+
+		TestEqual(TEXT("Unlocked pictures are pending"), PendingPictures.Num(), 1);
+		TestEqual(TEXT("Unlocked pictures are not recycled"), Pool->GetStats().NumUsed, 1);
+
+		TRefCountPtr<FVlcMediaSample> NextSample = Pool->Acquire();
+		TestTrue(TEXT("The decoder does not get the buffer of a picture that waits to be displayed"), NextSample.GetReference() != Picture);
+		NextSample.SafeRelease();
+
+		TRefCountPtr<FVlcMediaSample> DisplayedSample;
+		TestTrue(TEXT("Pending pictures can be displayed"), PendingPictures.Remove(Picture, DisplayedSample));
+		TestTrue(TEXT("The displayed sample is the decoded picture"), DisplayedSample.GetReference() == Picture);
+		TestEqual(TEXT("Displayed pictures are no longer pending"), PendingPictures.Num(), 0);
+
+		DisplayedSample.SafeRelease();
+		TestEqual(TEXT("Displayed pictures are recycled once released"), Pool->GetStats().NumUsed, 0);
+
+		TRefCountPtr<FVlcMediaSample> Unknown;
+		TestFalse(TEXT("Pictures can only be displayed once"), PendingPictures.Remove(Picture, Unknown));
+		TestFalse(TEXT("No sample is returned for pictures that are not pending"), Unknown.IsValid());
+	}
+
+	// pictures that were unlocked before a displayed one were dropped
+	{
+		FVlcMediaPendingPictures PendingPictures(3);
+		VlcMediaPendingPicturesTest::DecodePicture(*Pool, PendingPictures);
+		FVlcMediaSample* Second = VlcMediaPendingPicturesTest::DecodePicture(*Pool, PendingPictures);
+		FVlcMediaSample* Third = VlcMediaPendingPicturesTest::DecodePicture(*Pool, PendingPictures);
+
+		TRefCountPtr<FVlcMediaSample> DisplayedSample;
+		TestTrue(TEXT("Later pictures can be displayed"), PendingPictures.Remove(Second, DisplayedSample));
+		TestEqual(TEXT("Dropped pictures are released with the displayed one"), PendingPictures.Num(), 1);
+
+		DisplayedSample.SafeRelease();
+		TestEqual(TEXT("Only the pictures after the displayed one stay in use"), Pool->GetStats().NumUsed, 1);
+
+		TestTrue(TEXT("Pictures after the displayed one are still pending"), PendingPictures.Remove(Third, DisplayedSample));
+		DisplayedSample.SafeRelease();
+	}
+
+	// libvlc cannot hold more pictures than it allocated
+	{
+		FVlcMediaPendingPictures PendingPictures(2);
+		FVlcMediaSample* First = VlcMediaPendingPicturesTest::DecodePicture(*Pool, PendingPictures);
+		VlcMediaPendingPicturesTest::DecodePicture(*Pool, PendingPictures);
+		VlcMediaPendingPicturesTest::DecodePicture(*Pool, PendingPictures);
+
+		TRefCountPtr<FVlcMediaSample> DisplayedSample;
+		TestEqual(TEXT("The number of pending pictures is bounded"), PendingPictures.Num(), 2);
+		TestFalse(TEXT("The oldest picture is dropped when the bound is exceeded"), PendingPictures.Remove(First, DisplayedSample));
+
+		PendingPictures.Reset();
+		TestEqual(TEXT("Resetting releases all pictures"), PendingPictures.Num(), 0);
+	}
+
+	TestEqual(TEXT("All samples were returned to the pool"), Pool->GetStats().NumUsed, 0);
+
+	return true;
+}
+
+#endif
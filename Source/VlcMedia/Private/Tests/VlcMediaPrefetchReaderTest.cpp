@@ -0,0 +1,194 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+#include "AutomationTest.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace VlcMediaPrefetchReaderTest
+{
+	/** Size of the test media (in bytes, not a multiple of the block size). */
+	const uint64 MediaSize = 10000;
+
+	/** Maximum time to wait for the worker thread (in seconds). */
+	const double Timeout = 10.0;
+
+	/**
+	 * Get the expected value of a media byte.
+	 *
+	 * @param Offset The offset of the byte.
+	 * @return The byte.
+	 */
+	uint8 GetByte(uint64 Offset)
+	{
+		return (uint8)((Offset * 7) ^ (Offset >> 8));
+	}
+
+	/**
+	 * Generates media data on the worker thread, and fails one block on request.
+	 */
+	class FPatternReader
+		: public FVlcMediaPrefetchReader
+	{
+	public:
+
+		/**
+		 * Creates and initializes a new instance.
+		 *
+		 * @param InOptions The cache options.
+		 * @param InFailedOffset The offset of the block that cannot be read, or MAX_uint64 if all can be read.
+		 */
+		FPatternReader(const FVlcMediaPrefetchOptions& InOptions, uint64 InFailedOffset = MAX_uint64)
+			: FVlcMediaPrefetchReader(MediaSize, InOptions)
+			, FailedOffset(InFailedOffset)
+		{ }
+
+		/** Virtual destructor. */
+		virtual ~FPatternReader()
+		{
+			Shutdown();
+		}
+
+	protected:
+
+		// FVlcMediaPrefetchReader interface
+
+		virtual bool ReadBlock(uint64 Offset, uint8* OutBuffer, uint32 BlockSize) override
+		{
+			if (Offset == FailedOffset)
+			{
+				return false;
+			}
+
+			for (uint32 Index = 0; Index < BlockSize; ++Index)
+			{
+				OutBuffer[Index] = GetByte(Offset + Index);
+			}
+
+			return true;
+		}
+
+	private:
+
+		/** The offset of the block that cannot be read. */
+		uint64 FailedOffset;
+	};
+
+	/**
+	 * Check that a buffer holds the media data at the given offset.
+	 *
+	 * @param Data The data to check.
+	 * @param Offset The media offset of the data.
+	 * @param Size The number of bytes to check.
+	 * @return true if the data matches, false otherwise.
+	 */
+	bool Matches(const uint8* Data, uint64 Offset, SIZE_T Size)
+	{
+		for (SIZE_T Index = 0; Index < Size; ++Index)
+		{
+			if (Data[Index] != GetByte(Offset + Index))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVlcMediaPrefetchReaderTest, "System.Plugins.VlcMedia.PrefetchReader", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+
+bool FVlcMediaPrefetchReaderTest::RunTest(const FString& Parameters)
+{
+	FVlcMediaPrefetchOptions Options;
+	Options.BlockSize = 1024;
+	Options.NumBlocks = 4;
+
+	uint8 Buffer[1024];
+
+	// sequential reads
+	{
+		VlcMediaPrefetchReaderTest::FPatternReader Reader(Options);
+		Reader.Start();
+
+		SIZE_T Position = 0;
+		TestEqual(TEXT("The first read succeeds"), (int32)Reader.Read(Position, Buffer, 1), 1);
+
+		// the worker fills the whole cache ahead of sequential reads
+		const double StartTime = FPlatformTime::Seconds();
+
+		while ((Reader.GetStats().NumBytesFetched < 4 * Options.BlockSize) && (FPlatformTime::Seconds() - StartTime < VlcMediaPrefetchReaderTest::Timeout))
+		{
+			FPlatformProcess::Sleep(0.001f);
+		}
+
+		TestEqual(TEXT("Sequential reads fetch the whole cache ahead"), (int32)Reader.GetStats().NumBytesFetched, 4 * (int32)Options.BlockSize);
+
+		const uint64 NumMissesBefore = Reader.GetStats().NumCacheMisses;
+		bool Intact = true;
+		bool WithinBlocks = true;
+
+		while (true)
+		{
+			const SIZE_T ReadPosition = Position;
+			const SSIZE_T Result = Reader.Read(Position, Buffer, 300);
+
+			if (Result <= 0)
+			{
+				TestEqual(TEXT("Reads end at the end of the media"), (int32)Result, 0);
+
+				break;
+			}
+
+			Intact &= VlcMediaPrefetchReaderTest::Matches(Buffer, ReadPosition, Result);
+			WithinBlocks &= ((ReadPosition / Options.BlockSize) == ((ReadPosition + Result - 1) / Options.BlockSize));
+
+			// blocks that were fetched ahead are served without waiting
+			if (Position <= 4 * Options.BlockSize)
+			{
+				Intact &= (Reader.GetStats().NumCacheMisses == NumMissesBefore);
+			}
+		}
+
+		TestTrue(TEXT("Sequential reads return the media data, and blocks in the cache are hits"), Intact);
+		TestTrue(TEXT("Reads do not cross block boundaries"), WithinBlocks);
+		TestTrue(TEXT("Sequential reads reach the end of the media"), Position == VlcMediaPrefetchReaderTest::MediaSize);
+		TestEqual(TEXT("Sequential reads are not random accesses"), (int32)Reader.GetStats().NumRandomAccesses, 0);
+
+		// jumping elsewhere is a random access
+		Position = 5000;
+		TestEqual(TEXT("Random reads succeed"), (int32)Reader.Read(Position, Buffer, 100), 100);
+		TestTrue(TEXT("Random reads return the media data"), VlcMediaPrefetchReaderTest::Matches(Buffer, 5000, 100));
+		TestEqual(TEXT("Random reads are counted"), (int32)Reader.GetStats().NumRandomAccesses, 1);
+
+		// interrupting makes reads fail instead of waiting
+		Reader.Stop();
+		Position = 0;
+		TestEqual(TEXT("Reads fail after interrupting"), (int32)Reader.Read(Position, Buffer, 100), -1);
+	}
+
+	// blocks that cannot be fetched
+	{
+		VlcMediaPrefetchReaderTest::FPatternReader Reader(Options, 2 * Options.BlockSize);
+		Reader.Start();
+
+		SIZE_T Position = 2 * Options.BlockSize + 10;
+		TestEqual(TEXT("Reads of failed blocks fail"), (int32)Reader.Read(Position, Buffer, 100), -1);
+		TestTrue(TEXT("Failed reads do not move the position"), Position == 2 * Options.BlockSize + 10);
+		TestEqual(TEXT("Reads of failed blocks are tried again"), (int32)Reader.Read(Position, Buffer, 100), -1);
+
+		Position = 3 * Options.BlockSize;
+		TestEqual(TEXT("Other blocks can still be read"), (int32)Reader.Read(Position, Buffer, 100), 100);
+		TestTrue(TEXT("Other blocks return the media data"), VlcMediaPrefetchReaderTest::Matches(Buffer, 3 * Options.BlockSize, 100));
+
+		Reader.Shutdown();
+		TestEqual(TEXT("Reads fail after shutting down"), (int32)Reader.Read(Position, Buffer, 100), -1);
+	}
+
+	return true;
+}
+
+#endif
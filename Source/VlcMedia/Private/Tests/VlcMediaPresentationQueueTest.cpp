@@ -0,0 +1,158 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+#include "AutomationTest.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace VlcMediaPresentationQueueTest
+{
+	/** Duration of the test frames (in milliseconds). */
+	const double FrameDuration = 40.0;
+
+	/**
+	 * Create a video sample.
+	 *
+	 * @param Pool The pool to take the sample from.
+	 * @param Time The presentation time (in milliseconds).
+	 * @param DirtyRect The changed region (or an empty rectangle if the entire frame changed).
+	 * @return The sample.
+	 */
+	TRefCountPtr<FVlcMediaSample> MakeSample(FVlcMediaSamplePool& Pool, double Time, const FIntRect& DirtyRect = FIntRect())
+	{
+		TRefCountPtr<FVlcMediaSample> Sample = Pool.Acquire();
+		{
+			Sample->SetDuration(FTimespan::FromMilliseconds(FrameDuration));
+			Sample->SetTime(FTimespan::FromMilliseconds(Time));
+
+			TArray<FIntRect> DirtyRects;
+
+			if (DirtyRect.Area() > 0)
+			{
+				DirtyRects.Add(DirtyRect);
+			}
+
+			Sample->SetDirtyRects(DirtyRects);
+		}
+
+		return Sample;
+	}
+
+	/**
+	 * Get the presentation time of a sample.
+	 *
+	 * @param Sample The sample.
+	 * @return Time (in milliseconds), or -1 if the sample is not valid.
+	 */
+	int32 GetTime(const TRefCountPtr<FVlcMediaSample>& Sample)
+	{
+		return Sample.IsValid() ? (int32)Sample->GetTime().GetTotalMilliseconds() : -1;
+	}
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVlcMediaPresentationQueueTest, "System.Plugins.VlcMedia.PresentationQueue", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+
+bool FVlcMediaPresentationQueueTest::RunTest(const FString& Parameters)
+{
+	TSharedRef<FVlcMediaSamplePool, ESPMode::ThreadSafe> Pool = MakeShareable(new FVlcMediaSamplePool(16, 8));
+	TRefCountPtr<FVlcMediaSample> Sample;
+
+	// samples are held until they are due, and repeats are counted while the clock runs
+	{
+		FVlcMediaPresentationQueue Queue(4);
+		Queue.Enqueue(VlcMediaPresentationQueueTest::MakeSample(*Pool, 100.0));
+
+		TestFalse(TEXT("Early samples are held back"), Queue.Dequeue(FTimespan::FromMilliseconds(50.0), Sample));
+		TestFalse(TEXT("Early samples are held back at every tick"), Queue.Dequeue(FTimespan::FromMilliseconds(60.0), Sample));
+		TestEqual(TEXT("Early samples are counted once"), (int32)Queue.GetStats().NumEarly, 1);
+
+		TestTrue(TEXT("Samples are released when they are due"), Queue.Dequeue(FTimespan::FromMilliseconds(100.0), Sample));
+		TestEqual(TEXT("The due sample is released"), VlcMediaPresentationQueueTest::GetTime(Sample), 100);
+
+		TestFalse(TEXT("Nothing is released while the queue is empty"), Queue.Dequeue(FTimespan::FromMilliseconds(120.0), Sample));
+		TestEqual(TEXT("The current sample is not repeated before it ends"), (int32)Queue.GetStats().NumRepeated, 0);
+
+		TestFalse(TEXT("Nothing is released after the current sample ended"), Queue.Dequeue(FTimespan::FromMilliseconds(150.0), Sample));
+		TestEqual(TEXT("The current sample is repeated after it ended"), (int32)Queue.GetStats().NumRepeated, 1);
+
+		TestFalse(TEXT("Nothing is released while paused"), Queue.Dequeue(FTimespan::FromMilliseconds(150.0), Sample));
+		TestEqual(TEXT("Repeats are not counted while paused"), (int32)Queue.GetStats().NumRepeated, 1);
+		TestEqual(TEXT("Presented samples are counted"), (int32)Queue.GetStats().NumPresented, 1);
+	}
+
+	// only the newest due sample is released, and the regions that changed in the skipped samples are carried forward
+	{
+		FVlcMediaPresentationQueue Queue(4);
+		Queue.Enqueue(VlcMediaPresentationQueueTest::MakeSample(*Pool, 40.0, FIntRect(0, 0, 8, 8)));
+		Queue.Enqueue(VlcMediaPresentationQueueTest::MakeSample(*Pool, 120.0, FIntRect(16, 16, 24, 24)));
+		Queue.Enqueue(VlcMediaPresentationQueueTest::MakeSample(*Pool, 80.0, FIntRect(8, 8, 16, 16)));
+
+		TestTrue(TEXT("A sample is released if several are due"), Queue.Dequeue(FTimespan::FromMilliseconds(100.0), Sample));
+		TestEqual(TEXT("Samples are ordered by time, and the newest due one is released"), VlcMediaPresentationQueueTest::GetTime(Sample), 80);
+		TestEqual(TEXT("Overtaken samples are dropped"), (int32)Queue.GetStats().NumDropped, 1);
+		TestEqual(TEXT("The released sample includes the changes of the dropped one"), Sample->GetDirtyRects().Num(), 2);
+
+		TestTrue(TEXT("Late samples are released"), Queue.Dequeue(FTimespan::FromMilliseconds(200.0), Sample));
+		TestEqual(TEXT("The late sample is released"), VlcMediaPresentationQueueTest::GetTime(Sample), 120);
+		TestEqual(TEXT("Late samples are counted"), (int32)Queue.GetStats().NumLate, 1);
+
+		// samples that arrive after a newer one was presented are dropped, and the next one must be complete
+		Queue.Enqueue(VlcMediaPresentationQueueTest::MakeSample(*Pool, 110.0, FIntRect(0, 0, 8, 8)));
+		TestEqual(TEXT("Samples older than the presented one are dropped"), (int32)Queue.GetStats().NumDropped, 2);
+
+		Queue.Enqueue(VlcMediaPresentationQueueTest::MakeSample(*Pool, 240.0, FIntRect(0, 0, 8, 8)));
+		TestTrue(TEXT("Samples after a dropped one are released"), Queue.Dequeue(FTimespan::FromMilliseconds(240.0), Sample));
+		TestEqual(TEXT("Samples after a dropped one are complete frames"), Sample->GetDirtyRects().Num(), 0);
+	}
+
+	// a full queue drops its oldest sample, and a dropped complete frame makes the next one complete
+	{
+		FVlcMediaPresentationQueue Queue(2);
+		Queue.Enqueue(VlcMediaPresentationQueueTest::MakeSample(*Pool, 40.0));
+		Queue.Enqueue(VlcMediaPresentationQueueTest::MakeSample(*Pool, 80.0, FIntRect(0, 0, 8, 8)));
+		Queue.Enqueue(VlcMediaPresentationQueueTest::MakeSample(*Pool, 120.0, FIntRect(8, 8, 16, 16)));
+
+		TestEqual(TEXT("Full queues drop the oldest sample"), (int32)Queue.GetStats().NumDropped, 1);
+		TestTrue(TEXT("Samples remain after overflowing"), Queue.Dequeue(FTimespan::FromMilliseconds(80.0), Sample));
+		TestEqual(TEXT("The second sample is the oldest one left"), VlcMediaPresentationQueueTest::GetTime(Sample), 80);
+		TestEqual(TEXT("Dropping a complete frame makes the next sample complete"), Sample->GetDirtyRects().Num(), 0);
+	}
+
+	// flushing and seeking
+	{
+		FVlcMediaPresentationQueue Queue(4);
+		Queue.Enqueue(VlcMediaPresentationQueueTest::MakeSample(*Pool, 5000.0));
+		Queue.Enqueue(VlcMediaPresentationQueueTest::MakeSample(*Pool, 5040.0));
+
+		TestTrue(TEXT("Samples are released before seeking"), Queue.Dequeue(FTimespan::FromMilliseconds(5000.0), Sample));
+
+		// samples from before a seek backwards are too far ahead of the clock
+		TestFalse(TEXT("Samples from before a seek are not released"), Queue.Dequeue(FTimespan::FromMilliseconds(1000.0), Sample));
+		TestEqual(TEXT("Samples from before a seek are dropped"), (int32)Queue.GetStats().NumDropped, 1);
+
+		Queue.Enqueue(VlcMediaPresentationQueueTest::MakeSample(*Pool, 1000.0, FIntRect(0, 0, 8, 8)));
+		TestTrue(TEXT("Samples after a seek backwards are accepted"), Queue.Dequeue(FTimespan::FromMilliseconds(1000.0), Sample));
+		TestEqual(TEXT("The first sample after a seek is a complete frame"), Sample->GetDirtyRects().Num(), 0);
+
+		Queue.Enqueue(VlcMediaPresentationQueueTest::MakeSample(*Pool, 1040.0));
+		Queue.Enqueue(VlcMediaPresentationQueueTest::MakeSample(*Pool, 1080.0));
+		Queue.Flush();
+
+		TestEqual(TEXT("Flushing drops all queued samples"), (int32)Queue.GetStats().NumDropped, 3);
+		TestFalse(TEXT("Nothing is released after flushing"), Queue.Dequeue(FTimespan::FromMilliseconds(2000.0), Sample));
+
+		Queue.Enqueue(VlcMediaPresentationQueueTest::MakeSample(*Pool, 500.0, FIntRect(0, 0, 8, 8)));
+		TestTrue(TEXT("Older samples are accepted after flushing"), Queue.Dequeue(FTimespan::FromMilliseconds(500.0), Sample));
+		TestEqual(TEXT("The first sample after flushing is a complete frame"), Sample->GetDirtyRects().Num(), 0);
+	}
+
+	Sample.SafeRelease();
+	TestEqual(TEXT("All samples were returned to the pool"), Pool->GetStats().NumUsed, 0);
+
+	return true;
+}
+
+#endif
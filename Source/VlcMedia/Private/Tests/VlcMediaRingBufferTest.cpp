@@ -0,0 +1,198 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+#include "AutomationTest.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace VlcMediaRingBufferTest
+{
+	/** Number of records that the producer passes through the buffer in the concurrent test. */
+	const int32 NumConcurrentRecords = 100000;
+
+	/** A record whose size does not divide the buffer capacity, so that records straddle its end. */
+	struct FRecord
+	{
+		int32 Number;
+		int32 Check;
+		int32 Padding;
+	};
+
+	/**
+	 * Writes numbered records on its own thread.
+	 */
+	class FProducer
+		: public FRunnable
+	{
+	public:
+
+		/**
+		 * Creates and initializes a new instance.
+		 *
+		 * @param InBuffer The buffer to fill.
+		 */
+		FProducer(FVlcMediaRingBuffer& InBuffer)
+			: Buffer(InBuffer)
+		{ }
+
+	public:
+
+		// FRunnable interface
+
+		virtual uint32 Run() override
+		{
+			for (int32 Number = 0; Number < NumConcurrentRecords; ++Number)
+			{
+				while (Buffer.GetSpace() < sizeof(FRecord))
+				{
+					FPlatformProcess::Sleep(0.0f);
+				}
+
+				const FRecord Record = { Number, ~Number, 0 };
+
+				Buffer.Write(&Record, sizeof(FRecord));
+				Buffer.Commit();
+			}
+
+			return 0;
+		}
+
+	private:
+
+		/** The buffer to fill. */
+		FVlcMediaRingBuffer& Buffer;
+	};
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVlcMediaRingBufferTest, "System.Plugins.VlcMedia.RingBuffer", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+
+bool FVlcMediaRingBufferTest::RunTest(const FString& Parameters)
+{
+	// capacity and commits
+	{
+		FVlcMediaRingBuffer Buffer(100);
+		TestEqual(TEXT("The capacity is rounded up to a power of two"), (int32)Buffer.GetCapacity(), 128);
+
+		const int32 Value = 42;
+		int32 Result = 0;
+
+		Buffer.Write(&Value, sizeof(Value));
+		TestEqual(TEXT("Uncommitted data is not visible to the consumer"), (int32)Buffer.Num(), 0);
+		TestEqual(TEXT("Uncommitted data takes up space"), (int32)Buffer.GetSpace(), 124);
+
+		Buffer.Commit();
+		TestEqual(TEXT("Committed data is visible to the consumer"), (int32)Buffer.Num(), 4);
+		TestFalse(TEXT("Reading more than is available fails"), Buffer.Read(&Result, 8));
+		TestTrue(TEXT("Peeking succeeds"), Buffer.Peek(&Result, sizeof(Result)));
+		TestEqual(TEXT("Peeking does not remove data"), (int32)Buffer.Num(), 4);
+		TestTrue(TEXT("Reading succeeds"), Buffer.Read(&Result, sizeof(Result)) && (Result == Value));
+		TestEqual(TEXT("Reading hands the space back to the producer"), (int32)Buffer.GetSpace(), 128);
+	}
+
+	// records straddle the end of the buffer
+	{
+		FVlcMediaRingBuffer Buffer(32);
+		bool Intact = true;
+
+		for (int32 Number = 0; Number < 100; ++Number)
+		{
+			const VlcMediaRingBufferTest::FRecord Record = { Number, ~Number, 0 };
+
+			Buffer.Write(&Record, sizeof(Record));
+			Buffer.Commit();
+
+			VlcMediaRingBufferTest::FRecord Result;
+			Intact &= Buffer.Read(&Result, sizeof(Result)) && (Result.Number == Number) && (Result.Check == ~Number);
+		}
+
+		TestTrue(TEXT("Records that wrap around are read intact"), Intact);
+		TestEqual(TEXT("Drained buffers are empty"), (int32)Buffer.Num(), 0);
+	}
+
+	// producer flushes
+	{
+		FVlcMediaRingBuffer Buffer(64);
+		int32 Value = 1;
+
+		Buffer.Write(&Value, sizeof(Value));
+		Buffer.Commit();
+		Buffer.Flush();
+
+		Value = 2;
+		Buffer.Write(&Value, sizeof(Value));
+		Buffer.Commit();
+
+		TestEqual(TEXT("Flushed data stays visible until it is skipped"), (int32)Buffer.Num(), 8);
+
+		Buffer.SkipFlushed();
+
+		int32 Result = 0;
+		TestEqual(TEXT("Skipping flushed data keeps data committed afterwards"), (int32)Buffer.Num(), 4);
+		TestTrue(TEXT("Data committed after a flush is read"), Buffer.Read(&Result, sizeof(Result)) && (Result == 2));
+
+		// a flush that the consumer already read past must not move it backwards
+		Buffer.SkipFlushed();
+		TestEqual(TEXT("Skipping an old flush does nothing"), (int32)Buffer.Num(), 0);
+		TestEqual(TEXT("Skipping an old flush does not reclaim space"), (int32)Buffer.GetSpace(), 64);
+	}
+
+	// consumer flushes
+	{
+		FVlcMediaRingBuffer Buffer(64);
+		int32 Value = 1;
+
+		Buffer.Write(&Value, sizeof(Value));
+		Buffer.Commit();
+
+		Value = 2;
+		Buffer.Write(&Value, sizeof(Value));
+		Buffer.SkipAll();
+
+		TestEqual(TEXT("Skipping discards all committed data"), (int32)Buffer.Num(), 0);
+
+		Buffer.Commit();
+
+		int32 Result = 0;
+		TestTrue(TEXT("Data that was not committed when skipping is kept"), Buffer.Read(&Result, sizeof(Result)) && (Result == 2));
+	}
+
+	// concurrent producer and consumer
+	{
+		FVlcMediaRingBuffer Buffer(256);
+		VlcMediaRingBufferTest::FProducer Producer(Buffer);
+		FRunnableThread* Thread = FRunnableThread::Create(&Producer, TEXT("VlcMediaRingBufferTest"));
+
+		int32 NumReceived = 0;
+		bool Intact = true;
+
+		const double StartTime = FPlatformTime::Seconds();
+
+		while ((NumReceived < VlcMediaRingBufferTest::NumConcurrentRecords) && (FPlatformTime::Seconds() - StartTime < 30.0))
+		{
+			VlcMediaRingBufferTest::FRecord Record;
+
+			if (!Buffer.Read(&Record, sizeof(Record)))
+			{
+				FPlatformProcess::Sleep(0.0f);
+
+				continue;
+			}
+
+			Intact &= (Record.Number == NumReceived) && (Record.Check == ~NumReceived);
+			++NumReceived;
+		}
+
+		Thread->WaitForCompletion();
+		delete Thread;
+
+		TestEqual(TEXT("All concurrently written records are received"), NumReceived, VlcMediaRingBufferTest::NumConcurrentRecords);
+		TestTrue(TEXT("Concurrently written records are received intact and in order"), Intact);
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,234 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+#include "AutomationTest.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace VlcMediaSinkDispatcherTest
+{
+	/** Maximum time to wait for deliveries (in seconds). */
+	const double Timeout = 10.0;
+
+	/**
+	 * Records the times of the samples that it receives.
+	 */
+	class FRecordingSink
+		: public IVlcMediaSampleSink
+	{
+	public:
+
+		/**
+		 * Creates and initializes a new instance.
+		 *
+		 * @param InDelay Time to spend on each sample (in seconds).
+		 */
+		FRecordingSink(float InDelay = 0.0f)
+			: Delay(InDelay)
+		{ }
+
+		/**
+		 * Get the times of the received samples.
+		 *
+		 * @return Sample times (in ticks).
+		 */
+		TArray<int64> GetTimes() const
+		{
+			FScopeLock Lock(&CriticalSection);
+			return Times;
+		}
+
+	public:
+
+		// IVlcMediaSampleSink interface
+
+		virtual void ProcessMediaSample(const IVlcMediaSampleRef& Sample) override
+		{
+			if (Delay > 0.0f)
+			{
+				FPlatformProcess::Sleep(Delay);
+			}
+
+			FScopeLock Lock(&CriticalSection);
+			Times.Add(Sample->GetTime().GetTicks());
+		}
+
+	private:
+
+		/** Critical section for synchronizing access to the times. */
+		mutable FCriticalSection CriticalSection;
+
+		/** Time to spend on each sample (in seconds). */
+		float Delay;
+
+		/** The times of the received samples. */
+		TArray<int64> Times;
+	};
+
+	/**
+	 * Queue samples with consecutive times.
+	 *
+	 * @param Dispatcher The dispatcher to queue to.
+	 * @param Pool The pool to take the samples from.
+	 * @param First The time of the first sample (in ticks).
+	 * @param Count The number of samples to queue.
+	 */
+	void EnqueueSamples(FVlcMediaSinkDispatcher& Dispatcher, const TSharedRef<FVlcMediaSamplePool, ESPMode::ThreadSafe>& Pool, int64 First, int32 Count)
+	{
+		for (int64 Time = First; Time < First + Count; ++Time)
+		{
+			TRefCountPtr<FVlcMediaSample> Sample = Pool->Acquire();
+			Sample->SetTime(FTimespan(Time));
+
+			Dispatcher.Enqueue(IVlcMediaSampleRef(Sample.GetReference()));
+		}
+	}
+
+	/**
+	 * Wait until a dispatcher delivered the given number of samples.
+	 *
+	 * @param Dispatcher The dispatcher.
+	 * @param NumDelivered The number of samples to wait for.
+	 * @return true if the samples were delivered, false on timeout.
+	 */
+	bool WaitForDelivery(const FVlcMediaSinkDispatcher& Dispatcher, uint64 NumDelivered)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+
+		while (Dispatcher.GetStats().NumDelivered < NumDelivered)
+		{
+			if (FPlatformTime::Seconds() - StartTime > Timeout)
+			{
+				return false;
+			}
+
+			FPlatformProcess::Sleep(0.001f);
+		}
+
+		return true;
+	}
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVlcMediaSinkDispatcherTest, "System.Plugins.VlcMedia.SinkDispatcher", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+
+bool FVlcMediaSinkDispatcherTest::RunTest(const FString& Parameters)
+{
+	TSharedRef<FVlcMediaSamplePool, ESPMode::ThreadSafe> Pool = MakeShareable(new FVlcMediaSamplePool(16, 16));
+
+	FVlcMediaSinkOptions Options;
+	Options.QueueCapacity = 4;
+
+	// the worker is started after queuing, so that the queue overflows deterministically
+	{
+		TSharedRef<VlcMediaSinkDispatcherTest::FRecordingSink, ESPMode::ThreadSafe> Sink = MakeShareable(new VlcMediaSinkDispatcherTest::FRecordingSink);
+
+		Options.OverflowPolicy = EVlcMediaSinkOverflowPolicy::DropOldest;
+		FVlcMediaSampleSinkDispatcher Dispatcher(Sink, Options);
+
+		VlcMediaSinkDispatcherTest::EnqueueSamples(Dispatcher, Pool, 0, 10);
+
+		const FVlcMediaSinkStats Stats = Dispatcher.GetStats();
+		TestEqual(TEXT("DropOldest queues every sample"), (int32)Stats.NumQueued, 10);
+		TestEqual(TEXT("DropOldest drops the samples that do not fit"), (int32)Stats.NumDropped, 6);
+		TestEqual(TEXT("DropOldest keeps the queue full"), Stats.QueueLength, 4);
+
+		Dispatcher.Start();
+
+		if (TestTrue(TEXT("DropOldest delivers the queued samples"), VlcMediaSinkDispatcherTest::WaitForDelivery(Dispatcher, 4)))
+		{
+			const int64 Expected[] = { 6, 7, 8, 9 };
+			TestTrue(TEXT("DropOldest keeps the newest samples"), Sink->GetTimes() == TArray<int64>(Expected, ARRAY_COUNT(Expected)));
+		}
+	}
+
+	{
+		TSharedRef<VlcMediaSinkDispatcherTest::FRecordingSink, ESPMode::ThreadSafe> Sink = MakeShareable(new VlcMediaSinkDispatcherTest::FRecordingSink);
+
+		Options.OverflowPolicy = EVlcMediaSinkOverflowPolicy::DropNewest;
+		FVlcMediaSampleSinkDispatcher Dispatcher(Sink, Options);
+
+		VlcMediaSinkDispatcherTest::EnqueueSamples(Dispatcher, Pool, 0, 10);
+
+		const FVlcMediaSinkStats Stats = Dispatcher.GetStats();
+		TestEqual(TEXT("DropNewest only queues the samples that fit"), (int32)Stats.NumQueued, 4);
+		TestEqual(TEXT("DropNewest drops the samples that do not fit"), (int32)Stats.NumDropped, 6);
+
+		Dispatcher.Start();
+
+		if (TestTrue(TEXT("DropNewest delivers the queued samples"), VlcMediaSinkDispatcherTest::WaitForDelivery(Dispatcher, 4)))
+		{
+			const int64 Expected[] = { 0, 1, 2, 3 };
+			TestTrue(TEXT("DropNewest keeps the oldest samples"), Sink->GetTimes() == TArray<int64>(Expected, ARRAY_COUNT(Expected)));
+		}
+	}
+
+	// a slow sink makes the decoder wait instead of losing samples
+	{
+		TSharedRef<VlcMediaSinkDispatcherTest::FRecordingSink, ESPMode::ThreadSafe> Sink = MakeShareable(new VlcMediaSinkDispatcherTest::FRecordingSink(0.002f));
+
+		Options.OverflowPolicy = EVlcMediaSinkOverflowPolicy::Block;
+		FVlcMediaSampleSinkDispatcher Dispatcher(Sink, Options);
+
+		Dispatcher.Start();
+		VlcMediaSinkDispatcherTest::EnqueueSamples(Dispatcher, Pool, 0, 20);
+
+		TestEqual(TEXT("Block does not drop samples"), (int32)Dispatcher.GetStats().NumDropped, 0);
+
+		if (TestTrue(TEXT("Block delivers all samples"), VlcMediaSinkDispatcherTest::WaitForDelivery(Dispatcher, 20)))
+		{
+			const TArray<int64> Times = Sink->GetTimes();
+			bool Ordered = true;
+
+			for (int32 Index = 0; Index < Times.Num(); ++Index)
+			{
+				Ordered &= (Times[Index] == Index);
+			}
+
+			TestTrue(TEXT("Block delivers the samples in order"), Ordered);
+		}
+	}
+
+	// decoders never wait for a dispatcher that was shut down
+	{
+		TSharedRef<VlcMediaSinkDispatcherTest::FRecordingSink, ESPMode::ThreadSafe> Sink = MakeShareable(new VlcMediaSinkDispatcherTest::FRecordingSink);
+
+		Options.OverflowPolicy = EVlcMediaSinkOverflowPolicy::Block;
+		FVlcMediaSampleSinkDispatcher Dispatcher(Sink, Options);
+
+		VlcMediaSinkDispatcherTest::EnqueueSamples(Dispatcher, Pool, 0, 4);
+		Dispatcher.Shutdown();
+		VlcMediaSinkDispatcherTest::EnqueueSamples(Dispatcher, Pool, 4, 1);
+
+		TestEqual(TEXT("Samples are not queued after shutting down"), (int32)Dispatcher.GetStats().NumQueued, 4);
+	}
+
+	// sinks that were destroyed are detected by the worker
+	{
+		TSharedPtr<VlcMediaSinkDispatcherTest::FRecordingSink, ESPMode::ThreadSafe> Sink = MakeShareable(new VlcMediaSinkDispatcherTest::FRecordingSink);
+
+		Options.OverflowPolicy = EVlcMediaSinkOverflowPolicy::DropOldest;
+		FVlcMediaSampleSinkDispatcher Dispatcher(Sink.ToSharedRef(), Options);
+
+		Sink.Reset();
+		Dispatcher.Start();
+		VlcMediaSinkDispatcherTest::EnqueueSamples(Dispatcher, Pool, 0, 1);
+
+		const double StartTime = FPlatformTime::Seconds();
+
+		while (!Dispatcher.IsSinkExpired() && (FPlatformTime::Seconds() - StartTime < VlcMediaSinkDispatcherTest::Timeout))
+		{
+			FPlatformProcess::Sleep(0.001f);
+		}
+
+		TestTrue(TEXT("Destroyed sinks are detected"), Dispatcher.IsSinkExpired());
+	}
+
+	TestEqual(TEXT("All samples were returned to the pool"), Pool->GetStats().NumUsed, 0);
+
+	return true;
+}
+
+#endif
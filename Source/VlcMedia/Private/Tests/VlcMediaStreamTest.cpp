@@ -0,0 +1,184 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#include "VlcMediaPrivatePCH.h"
+#include "AutomationTest.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace VlcMediaStreamTest
+{
+	/** How long blocked reads wait for data (in seconds). */
+	const double ReadTimeout = 10.0;
+
+	/**
+	 * Reads from a stream on its own thread, like libvlc's input thread does.
+	 */
+	class FReader
+		: public FRunnable
+	{
+	public:
+
+		/**
+		 * Creates and initializes a new instance.
+		 *
+		 * @param InStream The stream to read from.
+		 * @param InPosition The position to read from.
+		 */
+		FReader(FVlcMediaStream& InStream, SIZE_T InPosition)
+			: Interrupted(0)
+			, Position(InPosition)
+			, Result(0)
+			, Stream(InStream)
+			, Value(0)
+			, WaitEvent(FPlatformProcess::GetSynchEventFromPool(false))
+		{
+			Stream.AddWaitEvent(WaitEvent);
+		}
+
+		/** Destructor. */
+		~FReader()
+		{
+			Stream.RemoveWaitEvent(WaitEvent);
+			FPlatformProcess::ReturnSynchEventToPool(WaitEvent);
+		}
+
+	public:
+
+		/** Make the read fail, like FVlcMediaStreamSource::Interrupt does. */
+		void Interrupt()
+		{
+			FPlatformAtomics::InterlockedExchange(&Interrupted, 1);
+			WaitEvent->Trigger();
+		}
+
+	public:
+
+		// FRunnable interface
+
+		virtual uint32 Run() override
+		{
+			Result = Stream.Read(Position, &Value, 1, WaitEvent, Interrupted);
+
+			return 0;
+		}
+
+	public:
+
+		/** Whether the read is interrupted (as bool). */
+		volatile int32 Interrupted;
+
+		/** The read position. */
+		SIZE_T Position;
+
+		/** The result of the read. */
+		SSIZE_T Result;
+
+		/** The stream. */
+		FVlcMediaStream& Stream;
+
+		/** The byte that was read. */
+		uint8 Value;
+
+		/** The event that the stream triggers. */
+		FEvent* WaitEvent;
+	};
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVlcMediaStreamTest, "System.Plugins.VlcMedia.Stream", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+
+bool FVlcMediaStreamTest::RunTest(const FString& Parameters)
+{
+	const uint8 Data[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+
+	// appending, seeking and reading
+	{
+		FVlcMediaStream Stream(16, FTimespan::FromSeconds(VlcMediaStreamTest::ReadTimeout));
+		FEvent* WaitEvent = FPlatformProcess::GetSynchEventFromPool(false);
+		volatile int32 Interrupted = 0;
+
+		Stream.AddWaitEvent(WaitEvent);
+
+		TestTrue(TEXT("Data can be appended"), Stream.Append(Data, sizeof(Data)));
+		TestEqual(TEXT("Appended data is counted"), (int32)Stream.GetNumAppended(), 8);
+		TestTrue(TEXT("The expected size is reported while appending"), Stream.GetMediaSize() == 16);
+		TestTrue(TEXT("Seeking past the appended data is allowed while appending"), Stream.CanSeek(12));
+		TestFalse(TEXT("Seeking past the expected size is not allowed"), Stream.CanSeek(16));
+
+		uint8 Buffer[16];
+		SIZE_T Position = 6;
+
+		TestEqual(TEXT("Reads return the available data"), (int32)Stream.Read(Position, Buffer, sizeof(Buffer), WaitEvent, Interrupted), 2);
+		TestTrue(TEXT("Reads copy from their position"), (Buffer[0] == 7) && (Buffer[1] == 8) && (Position == 8));
+
+		// reads past the appended data wait until the stream finishes
+		Stream.Finish();
+
+		TestEqual(TEXT("Reads at the end of finished streams return zero"), (int32)Stream.Read(Position, Buffer, sizeof(Buffer), WaitEvent, Interrupted), 0);
+		TestFalse(TEXT("Finished streams cannot be appended to"), Stream.Append(Data, sizeof(Data)));
+		TestTrue(TEXT("The appended size is reported after finishing"), Stream.GetMediaSize() == 8);
+		TestFalse(TEXT("Seeking past the appended data is not allowed after finishing"), Stream.CanSeek(8));
+
+		Stream.RemoveWaitEvent(WaitEvent);
+		FPlatformProcess::ReturnSynchEventToPool(WaitEvent);
+	}
+
+	// reads time out if no data arrives
+	{
+		FVlcMediaStream Stream(0, FTimespan::FromMilliseconds(50.0));
+		FEvent* WaitEvent = FPlatformProcess::GetSynchEventFromPool(false);
+		volatile int32 Interrupted = 0;
+
+		Stream.AddWaitEvent(WaitEvent);
+
+		TestTrue(TEXT("The size of streams without an expected size is unknown"), Stream.GetMediaSize() == MAX_uint64);
+
+		uint8 Value = 0;
+		SIZE_T Position = 0;
+
+		TestEqual(TEXT("Reads fail when they time out"), (int32)Stream.Read(Position, &Value, 1, WaitEvent, Interrupted), -1);
+		TestTrue(TEXT("Failed reads do not move the position"), Position == 0);
+
+		Stream.RemoveWaitEvent(WaitEvent);
+		FPlatformProcess::ReturnSynchEventToPool(WaitEvent);
+	}
+
+	// blocked readers wake up when data is appended or when they are interrupted
+	{
+		FVlcMediaStream Stream(0, FTimespan::FromSeconds(VlcMediaStreamTest::ReadTimeout));
+
+		VlcMediaStreamTest::FReader AppendedReader(Stream, 0);
+		VlcMediaStreamTest::FReader InterruptedReader(Stream, 0);
+
+		FRunnableThread* AppendedThread = FRunnableThread::Create(&AppendedReader, TEXT("VlcMediaStreamTest1"));
+		FRunnableThread* InterruptedThread = FRunnableThread::Create(&InterruptedReader, TEXT("VlcMediaStreamTest2"));
+
+		// give the readers time to block
+		FPlatformProcess::Sleep(0.1f);
+
+		const double StartTime = FPlatformTime::Seconds();
+
+		// interrupting one reader must not affect the other reader of the same stream
+		InterruptedReader.Interrupt();
+		InterruptedThread->WaitForCompletion();
+
+		Stream.Append(Data, sizeof(Data));
+		AppendedThread->WaitForCompletion();
+
+		const double WaitTime = FPlatformTime::Seconds() - StartTime;
+
+		delete AppendedThread;
+		delete InterruptedThread;
+
+		TestEqual(TEXT("Interrupted reads fail"), (int32)InterruptedReader.Result, -1);
+		TestEqual(TEXT("Blocked reads return appended data"), (int32)AppendedReader.Result, 1);
+		TestEqual(TEXT("Blocked reads return the first appended byte"), (int32)AppendedReader.Value, 1);
+		TestTrue(TEXT("Blocked reads return without waiting for the timeout"), WaitTime < 0.5 * VlcMediaStreamTest::ReadTimeout);
+	}
+
+	return true;
+}
+
+#endif
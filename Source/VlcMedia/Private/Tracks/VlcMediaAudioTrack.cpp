@@ -3,13 +3,50 @@
 #include "VlcMediaPrivatePCH.h"
 
 
+/** Size of the buffer between libvlc's audio thread and the ticking thread (about one second of 48 kHz 5.1 float audio). */
+#define VLCMEDIA_AUDIO_BUFFER_SIZE (1024 * 1024)
+
+/** Number of channels assumed until libvlc reports the stream format. */
+#define VLCMEDIA_AUDIO_DEFAULT_CHANNELS 2
+
+/** Sample rate assumed until libvlc reports the stream format. */
+#define VLCMEDIA_AUDIO_DEFAULT_SAMPLE_RATE 44100
+
+/** Size of pooled audio samples (larger blocks grow the pool). */
+#define VLCMEDIA_AUDIO_SAMPLE_SIZE (16 * 1024)
+
+/** Number of pooled audio samples. */
+#define VLCMEDIA_NUM_AUDIO_SAMPLES 16
+
+
 /* FVlcMediaAudioTrack structors
  *****************************************************************************/
 
-FVlcMediaAudioTrack::FVlcMediaAudioTrack(FLibvlcMediaPlayer* InPlayer, uint32 InTrackIndex, FLibvlcTrackDescription* Descr)
-	: FVlcMediaTrack(InPlayer, InTrackIndex, Descr)
+FVlcMediaAudioTrack::FVlcMediaAudioTrack(FLibvlcMediaPlayer* InPlayer, const FVlcMediaPlayerClockRef& InClock, const FVlcMediaPlayerStateRef& InState, uint32 InTrackIndex, FLibvlcTrackDescription* Descr)
+	: FVlcMediaTrack(InPlayer, InClock, InState, InTrackIndex, Descr)
 	, AudioTrackId(Descr->Id)
-{ }
+	, Buffer(VLCMEDIA_AUDIO_BUFFER_SIZE)
+	, FlushCount(0)
+	, FlushRequested(0)
+	, LastFlushCount(0)
+	, OutputNumChannels(0)
+	, OutputSamplesPerSecond(0)
+	, Paused(0)
+	, SamplePool(MakeShareable(new FVlcMediaSamplePool(VLCMEDIA_AUDIO_SAMPLE_SIZE, VLCMEDIA_NUM_AUDIO_SAMPLES)))
+	, StreamNumChannels(VLCMEDIA_AUDIO_DEFAULT_CHANNELS)
+	, StreamSamplesPerSecond(VLCMEDIA_AUDIO_DEFAULT_SAMPLE_RATE)
+	, ThreadNumChannels(VLCMEDIA_AUDIO_DEFAULT_CHANNELS)
+	, ThreadSamplesPerSecond(VLCMEDIA_AUDIO_DEFAULT_SAMPLE_RATE)
+{
+	// @todo gmp: implement support for multiple active VLC tracks
+	BindOutput();
+}
+
+
+FVlcMediaAudioTrack::~FVlcMediaAudioTrack()
+{
+	// the player may be in use by another media player by now, so the pool removes the callbacks when it stops the player
+}
 
 
 /* IMediaTrack interface
@@ -17,14 +54,33 @@ FVlcMediaAudioTrack::FVlcMediaAudioTrack(FLibvlcMediaPlayer* InPlayer, uint32 In
 
 bool FVlcMediaAudioTrack::Disable()
 {
-	return (!IsEnabled() || (FVlc::AudioSetTrack(GetPlayer(), -1) == 0));
+	if (!IsEnabled())
+	{
+		return true;
+	}
+
+	if (FVlc::AudioSetTrack(GetPlayer(), -1) != 0)
+	{
+		return false;
+	}
+
+	GetPlayerState().SetSelectedTrack(ELibvlcTrackType::Audio, -1);
+
+	return true;
 }
 
 
 bool FVlcMediaAudioTrack::Enable()
 {
 	// @todo gmp: implement support for multiple active VLC tracks
-	return (FVlc::AudioSetTrack(GetPlayer(), AudioTrackId) == 0);
+	if (FVlc::AudioSetTrack(GetPlayer(), AudioTrackId) != 0)
+	{
+		return false;
+	}
+
+	GetPlayerState().SetSelectedTrack(ELibvlcTrackType::Audio, AudioTrackId);
+
+	return true;
 }
 
 
@@ -57,7 +113,7 @@ const IMediaTrackVideoDetails& FVlcMediaAudioTrack::GetVideoDetails() const
 bool FVlcMediaAudioTrack::IsEnabled() const
 {
 	// @todo gmp: implement support for multiple active VLC tracks
-	return (FVlc::AudioGetTrack(GetPlayer()) == AudioTrackId);
+	return (GetPlayerState().GetSelectedTrack(ELibvlcTrackType::Audio) == AudioTrackId);
 }
 
 
@@ -66,11 +122,290 @@ bool FVlcMediaAudioTrack::IsEnabled() const
 
 uint32 FVlcMediaAudioTrack::GetNumChannels() const
 {
-	return 1;
+	FScopeLock Lock(&FormatCriticalSection);
+	return (OutputNumChannels != 0) ? OutputNumChannels : FMath::Min(StreamNumChannels, 2u);
 }
 
 
 uint32 FVlcMediaAudioTrack::GetSamplesPerSecond() const
 {
+	FScopeLock Lock(&FormatCriticalSection);
+	return (OutputSamplesPerSecond != 0) ? OutputSamplesPerSecond : StreamSamplesPerSecond;
+}
+
+
+/* IVlcMediaAudioTrack interface
+ *****************************************************************************/
+
+uint32 FVlcMediaAudioTrack::GetStreamNumChannels() const
+{
+	FScopeLock Lock(&FormatCriticalSection);
+	return StreamNumChannels;
+}
+
+
+uint32 FVlcMediaAudioTrack::GetStreamSamplesPerSecond() const
+{
+	FScopeLock Lock(&FormatCriticalSection);
+	return StreamSamplesPerSecond;
+}
+
+
+void FVlcMediaAudioTrack::SetOutputFormat(uint32 SamplesPerSecond, uint32 NumChannels)
+{
+	FScopeLock Lock(&FormatCriticalSection);
+
+	OutputNumChannels = FMath::Min(NumChannels, FVlcMediaAudioResampler::MaxChannels);
+	OutputSamplesPerSecond = SamplesPerSecond;
+}
+
+
+/* FVlcMediaTrack interface
+ *****************************************************************************/
+
+void FVlcMediaAudioTrack::BindOutput()
+{
+	FVlc::AudioSetCallbacks(
+		GetPlayer(),
+		&FVlcMediaAudioTrack::HandleAudioPlay,
+		&FVlcMediaAudioTrack::HandleAudioPause,
+		&FVlcMediaAudioTrack::HandleAudioResume,
+		&FVlcMediaAudioTrack::HandleAudioFlush,
+		&FVlcMediaAudioTrack::HandleAudioDrain,
+		this);
+
+	// libvlc decodes in the stream's own format, and the plugin converts it when the track is ticked
+	FVlc::AudioSetFormatCallbacks(
+		GetPlayer(),
+		&FVlcMediaAudioTrack::HandleAudioSetup,
+		&FVlcMediaAudioTrack::HandleAudioCleanup);
+}
+
+
+void FVlcMediaAudioTrack::Rebind(FLibvlcMediaPlayer* NewPlayer, int32 NewTrackId)
+{
+	FVlc::AudioSetCallbacks(GetPlayer(), nullptr, nullptr, nullptr, nullptr, nullptr, nullptr);
+	FVlc::AudioSetFormatCallbacks(GetPlayer(), nullptr, nullptr);
+
+	FVlcMediaTrack::Rebind(NewPlayer, NewTrackId);
+
+	// audio of the previous media that was not delivered yet is dropped by the consumer, because only libvlc's audio thread may flush
+	FPlatformAtomics::InterlockedExchange(&FlushRequested, 1);
+	AudioTrackId = NewTrackId;
+
+	BindOutput();
+
+	if (FVlc::AudioGetTrack(NewPlayer) == NewTrackId)
+	{
+		FVlc::AudioSetTrack(NewPlayer, -1);
+		FVlc::AudioSetTrack(NewPlayer, NewTrackId);
+	}
+}
+
+
+void FVlcMediaAudioTrack::Tick(FTimespan Time)
+{
+	// audio is held back while the output is paused, so sinks don't run ahead
+	if (Paused != 0)
+	{
+		return;
+	}
+
+	uint32 NumChannels;
+	uint32 SamplesPerSecond;
+	{
+		FScopeLock Lock(&FormatCriticalSection);
+
+		NumChannels = OutputNumChannels;
+		SamplesPerSecond = OutputSamplesPerSecond;
+	}
+
+	// interpolation history from before a flush must not bleed into new audio
+	const int32 CurrentFlushCount = FlushCount;
+
+	if (CurrentFlushCount != LastFlushCount)
+	{
+		LastFlushCount = CurrentFlushCount;
+		Resampler.Reset();
+	}
+
+	if (FPlatformAtomics::InterlockedExchange(&FlushRequested, 0) != 0)
+	{
+		Buffer.SkipAll();
+		Resampler.Reset();
+	}
+
+	FBlockHeader Header;
+
+	while (true)
+	{
+		// flushes are only honored between blocks, so that a header is never read from the middle of one
+		Buffer.SkipFlushed();
+
+		if (!Buffer.Read(&Header, sizeof(Header)))
+		{
+			break;
+		}
+
+		// the header and its data are committed together
+		const uint32 NumInputFrames = Header.Size / (Header.NumChannels * sizeof(float));
+
+		InputSamples.Reset(Header.Size / sizeof(float));
+		InputSamples.AddUninitialized(Header.Size / sizeof(float));
+		verify(Buffer.Read(InputSamples.GetData(), Header.Size));
+
+		// unless requested otherwise, surround streams are down-mixed to stereo
+		const uint32 OutputChannels = (NumChannels != 0) ? NumChannels : FMath::Min(Header.NumChannels, 2u);
+		const uint32 OutputRate = (SamplesPerSecond != 0) ? SamplesPerSecond : Header.SampleRate;
+
+		if (!Resampler.IsConfiguredFor(Header.NumChannels, Header.SampleRate, OutputChannels, OutputRate) &&
+			!Resampler.Configure(Header.NumChannels, Header.SampleRate, OutputChannels, OutputRate))
+		{
+			continue;
+		}
+
+		const uint32 MaxOutputSize = Resampler.GetMaxOutputFrames(NumInputFrames) * OutputChannels * sizeof(int16);
+
+		if (MaxOutputSize > SamplePool->GetBufferSize())
+		{
+			SamplePool = MakeShareable(new FVlcMediaSamplePool(MaxOutputSize, VLCMEDIA_NUM_AUDIO_SAMPLES));
+		}
+
+		TRefCountPtr<FVlcMediaSample> Sample = SamplePool->Acquire();
+		const uint32 NumOutputFrames = Resampler.Process(InputSamples.GetData(), NumInputFrames, (int16*)Sample->GetBuffer());
+
+		if (NumOutputFrames == 0)
+		{
+			continue;
+		}
+
+		Sample->SetDuration(FTimespan::FromSeconds((double)NumOutputFrames / OutputRate));
+		Sample->SetSize(NumOutputFrames * OutputChannels * sizeof(int16));
+		Sample->SetTime(FTimespan(Header.Time));
+
+		ProcessMediaSample(IVlcMediaSampleRef(Sample.GetReference()));
+	}
+}
+
+
+/* FVlcMediaAudioTrack static functions
+ *****************************************************************************/
+
+int FVlcMediaAudioTrack::HandleAudioSetup(void** Opaque, ANSICHAR* Format, uint32* Rate, uint32* Channels)
+{
+	FVlcMediaAudioTrack* AudioTrack = (FVlcMediaAudioTrack*)*Opaque;
+
+	if ((AudioTrack == nullptr) || (*Rate == 0))
+	{
+		return -1;
+	}
+
+	// request 32-bit float samples in the stream's rate and channel layout
+	FMemory::Memcpy(Format, "FL32", 4);
+	*Channels = FMath::Clamp(*Channels, 1u, FVlcMediaAudioResampler::MaxChannels);
+
+	AudioTrack->ThreadNumChannels = *Channels;
+	AudioTrack->ThreadSamplesPerSecond = *Rate;
+	{
+		FScopeLock Lock(&AudioTrack->FormatCriticalSection);
+
+		AudioTrack->StreamNumChannels = *Channels;
+		AudioTrack->StreamSamplesPerSecond = *Rate;
+	}
+
 	return 0;
 }
+
+
+void FVlcMediaAudioTrack::HandleAudioCleanup(void* /*Opaque*/)
+{
+	// nothing to clean up
+}
+
+
+void FVlcMediaAudioTrack::HandleAudioPlay(void* Opaque, const void* Samples, uint32 Count, int64 Pts)
+{
+	// this runs on libvlc's audio thread, which must not allocate memory or take locks
+	FVlcMediaAudioTrack* AudioTrack = (FVlcMediaAudioTrack*)Opaque;
+
+	if ((AudioTrack == nullptr) || (Samples == nullptr) || (Count == 0))
+	{
+		return;
+	}
+
+	FBlockHeader Header;
+	{
+		// the samples are due at the given libvlc clock time
+		const FTimespan Delay = FTimespan::FromMilliseconds((Pts - FVlc::Clock()) / 1000.0);
+
+		Header.NumChannels = AudioTrack->ThreadNumChannels;
+		Header.SampleRate = AudioTrack->ThreadSamplesPerSecond;
+		Header.Size = Count * Header.NumChannels * sizeof(float);
+		Header.Time = (AudioTrack->GetClock().GetTime() + Delay).GetTicks();
+	}
+
+	FVlcMediaRingBuffer& Buffer = AudioTrack->Buffer;
+
+	// if ticking falls behind, the newest audio is dropped
+	if (Buffer.GetSpace() < sizeof(Header) + Header.Size)
+	{
+		return;
+	}
+
+	Buffer.Write(&Header, sizeof(Header));
+	Buffer.Write(Samples, Header.Size);
+	Buffer.Commit();
+}
+
+
+void FVlcMediaAudioTrack::HandleAudioPause(void* Opaque, int64 /*Pts*/)
+{
+	FVlcMediaAudioTrack* AudioTrack = (FVlcMediaAudioTrack*)Opaque;
+
+	if (AudioTrack != nullptr)
+	{
+		FPlatformAtomics::InterlockedExchange(&AudioTrack->Paused, 1);
+	}
+}
+
+
+void FVlcMediaAudioTrack::HandleAudioResume(void* Opaque, int64 /*Pts*/)
+{
+	FVlcMediaAudioTrack* AudioTrack = (FVlcMediaAudioTrack*)Opaque;
+
+	if (AudioTrack != nullptr)
+	{
+		FPlatformAtomics::InterlockedExchange(&AudioTrack->Paused, 0);
+	}
+}
+
+
+void FVlcMediaAudioTrack::HandleAudioFlush(void* Opaque, int64 /*Pts*/)
+{
+	FVlcMediaAudioTrack* AudioTrack = (FVlcMediaAudioTrack*)Opaque;
+
+	if (AudioTrack != nullptr)
+	{
+		AudioTrack->Buffer.Flush();
+		FPlatformAtomics::InterlockedIncrement(&AudioTrack->FlushCount);
+	}
+}
+
+
+void FVlcMediaAudioTrack::HandleAudioDrain(void* Opaque)
+{
+	FVlcMediaAudioTrack* AudioTrack = (FVlcMediaAudioTrack*)Opaque;
+
+	if (AudioTrack == nullptr)
+	{
+		return;
+	}
+
+	// wait (briefly) until the track's tick picked up all remaining audio
+	const double Timeout = FPlatformTime::Seconds() + 0.5;
+
+	while ((AudioTrack->Buffer.GetSpace() < AudioTrack->Buffer.GetCapacity()) && (FPlatformTime::Seconds() < Timeout))
+	{
+		FPlatformProcess::Sleep(0.001f);
+	}
+}
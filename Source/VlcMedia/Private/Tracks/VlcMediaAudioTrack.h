@@ -6,6 +6,7 @@
 class FVlcMediaAudioTrack
 	: public FVlcMediaTrack
 	, public IMediaTrackAudioDetails
+	, public IVlcMediaAudioTrack
 {
 public:
 
@@ -13,13 +14,15 @@ public:
 	 * Creates and initializes a new instance.
 	 *
 	 * @param InPlayer The VLC media player instance that owns this track.
+	 * @param InClock The playback clock of the media player.
+	 * @param InState The cached state of the media player.
 	 * @param InTrackIndex The index number of this track.
 	 * @param Descr The track description.
 	 */
-    FVlcMediaAudioTrack(FLibvlcMediaPlayer* InPlayer, uint32 InTrackIndex, FLibvlcTrackDescription* Descr);
+    FVlcMediaAudioTrack(FLibvlcMediaPlayer* InPlayer, const FVlcMediaPlayerClockRef& InClock, const FVlcMediaPlayerStateRef& InState, uint32 InTrackIndex, FLibvlcTrackDescription* Descr);
 
 	/** Virtual destructor. */
-	virtual ~FVlcMediaAudioTrack() { }
+	virtual ~FVlcMediaAudioTrack();
 
 public:
 
@@ -40,8 +43,108 @@ public:
 	virtual uint32 GetNumChannels() const override;
 	virtual uint32 GetSamplesPerSecond() const override;
 
+public:
+
+	// IVlcMediaAudioTrack interface
+
+	virtual uint32 GetStreamNumChannels() const override;
+	virtual uint32 GetStreamSamplesPerSecond() const override;
+	virtual void SetOutputFormat(uint32 SamplesPerSecond, uint32 NumChannels) override;
+
+protected:
+
+	// FVlcMediaTrack interface
+
+	virtual void BindOutput() override;
+	virtual void Rebind(FLibvlcMediaPlayer* NewPlayer, int32 NewTrackId) override;
+	virtual void Tick(FTimespan Time) override;
+
+private:
+
+	/** Handles format setup callbacks from VLC. */
+	static int HandleAudioSetup(void** Opaque, ANSICHAR* Format, uint32* Rate, uint32* Channels);
+
+	/** Handles format cleanup callbacks from VLC. */
+	static void HandleAudioCleanup(void* Opaque);
+
+	/** Handles play callbacks from VLC. */
+	static void HandleAudioPlay(void* Opaque, const void* Samples, uint32 Count, int64 Pts);
+
+	/** Handles pause callbacks from VLC. */
+	static void HandleAudioPause(void* Opaque, int64 Pts);
+
+	/** Handles resume callbacks from VLC. */
+	static void HandleAudioResume(void* Opaque, int64 Pts);
+
+	/** Handles flush callbacks from VLC. */
+	static void HandleAudioFlush(void* Opaque, int64 Pts);
+
+	/** Handles drain callbacks from VLC. */
+	static void HandleAudioDrain(void* Opaque);
+
 private:
 
+	/** Header of a block of PCM data in the ring buffer. */
+	struct FBlockHeader
+	{
+		/** The number of bytes that follow the header. */
+		uint32 Size;
+
+		/** The number of interleaved channels. */
+		uint32 NumChannels;
+
+		/** The sample rate. */
+		uint32 SampleRate;
+
+		/** The presentation time of the block (in ticks). */
+		int64 Time;
+	};
+
 	/** The audio track's ID. */
 	int32 AudioTrackId;
+
+	/** Ring buffer that passes PCM data from libvlc's audio thread to the thread that ticks the track. */
+	FVlcMediaRingBuffer Buffer;
+
+	/** Number of flushes requested by libvlc. */
+	volatile int32 FlushCount;
+
+	/** Whether all buffered audio should be dropped by the next Tick (requested when rebinding). */
+	volatile int32 FlushRequested;
+
+	/** Critical section for synchronizing access to the stream and output formats. */
+	mutable FCriticalSection FormatCriticalSection;
+
+	/** Holds a block of float samples read from the ring buffer (only accessed by Tick). */
+	TArray<float> InputSamples;
+
+	/** Number of flushes that were processed (only accessed by Tick). */
+	int32 LastFlushCount;
+
+	/** The number of channels to output (zero for the stream's channels). */
+	uint32 OutputNumChannels;
+
+	/** The sample rate to output (zero for the stream's rate). */
+	uint32 OutputSamplesPerSecond;
+
+	/** Whether libvlc paused the audio output. */
+	volatile int32 Paused;
+
+	/** Converts the stream to the output format (only accessed by Tick). */
+	FVlcMediaAudioResampler Resampler;
+
+	/** Pool of audio samples (only accessed by Tick). */
+	TSharedPtr<FVlcMediaSamplePool, ESPMode::ThreadSafe> SamplePool;
+
+	/** The number of channels of the stream. */
+	uint32 StreamNumChannels;
+
+	/** The sample rate of the stream. */
+	uint32 StreamSamplesPerSecond;
+
+	/** The number of channels of the stream (only accessed on libvlc's audio thread). */
+	uint32 ThreadNumChannels;
+
+	/** The sample rate of the stream (only accessed on libvlc's audio thread). */
+	uint32 ThreadSamplesPerSecond;
 };
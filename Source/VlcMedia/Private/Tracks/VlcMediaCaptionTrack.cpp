@@ -6,8 +6,8 @@
 /* FVlcMediaCaptionTrack structors
  *****************************************************************************/
 
-FVlcMediaCaptionTrack::FVlcMediaCaptionTrack(FLibvlcMediaPlayer* InPlayer, uint32 InTrackIndex, FLibvlcTrackDescription* Descr)
-	: FVlcMediaTrack(InPlayer, InTrackIndex, Descr)
+FVlcMediaCaptionTrack::FVlcMediaCaptionTrack(FLibvlcMediaPlayer* InPlayer, const FVlcMediaPlayerClockRef& InClock, const FVlcMediaPlayerStateRef& InState, uint32 InTrackIndex, FLibvlcTrackDescription* Descr)
+	: FVlcMediaTrack(InPlayer, InClock, InState, InTrackIndex, Descr)
 	, SpuId(Descr->Id)
 { }
 
@@ -17,14 +17,33 @@ FVlcMediaCaptionTrack::FVlcMediaCaptionTrack(FLibvlcMediaPlayer* InPlayer, uint3
 
 bool FVlcMediaCaptionTrack::Disable()
 {
-	return (!IsEnabled() || (FVlc::VideoSetSpu(GetPlayer(), -1) == 0));
+	if (!IsEnabled())
+	{
+		return true;
+	}
+
+	if (FVlc::VideoSetSpu(GetPlayer(), -1) != 0)
+	{
+		return false;
+	}
+
+	GetPlayerState().SetSelectedTrack(ELibvlcTrackType::Text, -1);
+
+	return true;
 }
 
 
 bool FVlcMediaCaptionTrack::Enable()
 {
 	// @todo gmp: implement support for multiple active VLC tracks
-	return (FVlc::VideoSetSpu(GetPlayer(), SpuId) == 0);
+	if (FVlc::VideoSetSpu(GetPlayer(), SpuId) != 0)
+	{
+		return false;
+	}
+
+	GetPlayerState().SetSelectedTrack(ELibvlcTrackType::Text, SpuId);
+
+	return true;
 }
 
 
@@ -57,5 +76,15 @@ const IMediaTrackVideoDetails& FVlcMediaCaptionTrack::GetVideoDetails() const
 bool FVlcMediaCaptionTrack::IsEnabled() const
 {
 	// @todo gmp: implement support for multiple active VLC tracks
-	return (FVlc::VideoGetSpu(GetPlayer()) == SpuId);
+	return (GetPlayerState().GetSelectedTrack(ELibvlcTrackType::Text) == SpuId);
+}
+
+
+/* FVlcMediaTrack interface
+ *****************************************************************************/
+
+void FVlcMediaCaptionTrack::Rebind(FLibvlcMediaPlayer* NewPlayer, int32 NewTrackId)
+{
+	FVlcMediaTrack::Rebind(NewPlayer, NewTrackId);
+	SpuId = NewTrackId;
 }
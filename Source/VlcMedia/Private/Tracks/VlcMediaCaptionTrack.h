@@ -13,10 +13,12 @@ public:
 	 * Creates and initializes a new instance.
 	 *
 	 * @param InPlayer The VLC media player instance that owns this track.
+	 * @param InClock The playback clock of the media player.
+	 * @param InState The cached state of the media player.
 	 * @param InTrackIndex The index number of this track.
 	 * @param Descr The track description.
 	 */
-	FVlcMediaCaptionTrack(FLibvlcMediaPlayer* InPlayer, uint32 InTrackIndex, FLibvlcTrackDescription* Descr);
+	FVlcMediaCaptionTrack(FLibvlcMediaPlayer* InPlayer, const FVlcMediaPlayerClockRef& InClock, const FVlcMediaPlayerStateRef& InState, uint32 InTrackIndex, FLibvlcTrackDescription* Descr);
 
 	/** Virtual destructor. */
 	virtual ~FVlcMediaCaptionTrack() { }
@@ -33,6 +35,12 @@ public:
 	virtual const IMediaTrackVideoDetails& GetVideoDetails() const override;
 	virtual bool IsEnabled() const override;
 
+protected:
+
+	// FVlcMediaTrack interface
+
+	virtual void Rebind(FLibvlcMediaPlayer* NewPlayer, int32 NewTrackId) override;
+
 private:
 
 	/** The caption track's ID. */
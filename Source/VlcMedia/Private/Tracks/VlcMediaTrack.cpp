@@ -9,10 +9,14 @@
 /* FVlcMediaTrack structors
  *****************************************************************************/
 
-FVlcMediaTrack::FVlcMediaTrack(FLibvlcMediaPlayer* InPlayer, uint32 InTrackIndex, FLibvlcTrackDescription* Descr)
-    : LastTime(0.0f)
+FVlcMediaTrack::FVlcMediaTrack(FLibvlcMediaPlayer* InPlayer, const FVlcMediaPlayerClockRef& InClock, const FVlcMediaPlayerStateRef& InState, uint32 InTrackIndex, FLibvlcTrackDescription* Descr)
+	: Dispatchers(MakeShareable(new TArray<FVlcMediaSinkDispatcherPtr>()))
+	, FirstSampleTime(0)
+	, Clock(InClock)
 	, Name(ANSI_TO_TCHAR(Descr->Name))
 	, Player(InPlayer)
+	, State(InState)
+	, TrackId(Descr->Id)
 	, TrackIndex(InTrackIndex)
 {
 	if (Name.IsEmpty())
@@ -26,12 +30,79 @@ FVlcMediaTrack::FVlcMediaTrack(FLibvlcMediaPlayer* InPlayer, uint32 InTrackIndex
 }
 
 
+FVlcMediaTrack::~FVlcMediaTrack()
+{
+	FScopeLock Lock(&DispatchersCriticalSection);
+
+	for (const FVlcMediaSinkDispatcherPtr& Dispatcher : *Dispatchers)
+	{
+		Dispatcher->Shutdown();
+	}
+}
+
+
+/* FVlcMediaTrack interface
+ *****************************************************************************/
+
+void FVlcMediaTrack::Rebind(FLibvlcMediaPlayer* NewPlayer, int32 NewTrackId)
+{
+	FirstSampleTime = 0;
+	Player = NewPlayer;
+	TrackId = NewTrackId;
+}
+
+
+void FVlcMediaTrack::RemoveExpiredDispatchers()
+{
+	TArray<FVlcMediaSinkDispatcherPtr> ExpiredDispatchers;
+	{
+		FScopeLock Lock(&DispatchersCriticalSection);
+
+		for (const FVlcMediaSinkDispatcherPtr& Dispatcher : *Dispatchers)
+		{
+			if (Dispatcher->IsSinkExpired())
+			{
+				ExpiredDispatchers.Add(Dispatcher);
+			}
+		}
+
+		if (ExpiredDispatchers.Num() == 0)
+		{
+			return;
+		}
+
+		TSharedRef<TArray<FVlcMediaSinkDispatcherPtr>, ESPMode::ThreadSafe> NewDispatchers = MakeShareable(new TArray<FVlcMediaSinkDispatcherPtr>());
+
+		for (const FVlcMediaSinkDispatcherPtr& Dispatcher : *Dispatchers)
+		{
+			if (!ExpiredDispatchers.Contains(Dispatcher))
+			{
+				NewDispatchers->Add(Dispatcher);
+			}
+		}
+
+		Dispatchers = NewDispatchers;
+	}
+
+	// shutting down joins the worker threads, so it happens outside of the lock
+	for (const FVlcMediaSinkDispatcherPtr& Dispatcher : ExpiredDispatchers)
+	{
+		Dispatcher->Shutdown();
+	}
+
+	HandleDispatchersChanged();
+}
+
+
 /* IMediaTrack interface
  *****************************************************************************/
 
 void FVlcMediaTrack::AddSink(const IMediaSinkRef& Sink)
 {
-	Sinks.AddUnique(IMediaSinkWeakPtr(Sink));
+	if (!FindDispatcher(&Sink.Get()).IsValid())
+	{
+		AddDispatcher(MakeShareable(new FVlcMediaFrameworkSinkDispatcher(Sink, FVlcMediaSinkOptions())));
+	}
 }
 
 
@@ -75,24 +146,121 @@ bool FVlcMediaTrack::IsProtected() const
 
 void FVlcMediaTrack::RemoveSink(const IMediaSinkRef& Sink)
 {
-	Sinks.RemoveSingle(IMediaSinkWeakPtr(Sink));
+	RemoveDispatcher(&Sink.Get());
 }
 
 
 /* FVlcMediaTrack implementation
  *****************************************************************************/
 
-void FVlcMediaTrack::ProcessMediaSample(const void* SampleBuffer, uint32 SampleSize, FTimespan SampleDuration)
+void FVlcMediaTrack::AddDispatcher(const FVlcMediaSinkDispatcherPtr& Dispatcher)
+{
+	FVlcMediaSinkDispatcherPtr ReplacedDispatcher = DetachDispatcher(Dispatcher->GetSinkKey());
+
+	if (ReplacedDispatcher.IsValid())
+	{
+		ReplacedDispatcher->Shutdown();
+	}
+
+	Dispatcher->Start();
+	{
+		FScopeLock Lock(&DispatchersCriticalSection);
+
+		TSharedRef<TArray<FVlcMediaSinkDispatcherPtr>, ESPMode::ThreadSafe> NewDispatchers = MakeShareable(new TArray<FVlcMediaSinkDispatcherPtr>(*Dispatchers));
+		NewDispatchers->Add(Dispatcher);
+		Dispatchers = NewDispatchers;
+	}
+
+	HandleDispatchersChanged();
+}
+
+
+FVlcMediaSinkDispatcherPtr FVlcMediaTrack::FindDispatcher(const void* SinkKey) const
 {
-	for (IMediaSinkWeakPtr& SinkPtr : Sinks)
+	FScopeLock Lock(&DispatchersCriticalSection);
+
+	for (const FVlcMediaSinkDispatcherPtr& Dispatcher : *Dispatchers)
 	{
-		IMediaSinkPtr Sink = SinkPtr.Pin();
+		if (Dispatcher->GetSinkKey() == SinkKey)
+		{
+			return Dispatcher;
+		}
+	}
+
+	return FVlcMediaSinkDispatcherPtr();
+}
+
+
+void FVlcMediaTrack::GetDispatcherOptions(TArray<FVlcMediaSinkOptions>& OutOptions) const
+{
+	FScopeLock Lock(&DispatchersCriticalSection);
 
-		if (Sink.IsValid())
+	OutOptions.Reset(Dispatchers->Num());
+
+	for (const FVlcMediaSinkDispatcherPtr& Dispatcher : *Dispatchers)
+	{
+		OutOptions.Add(Dispatcher->GetOptions());
+	}
+}
+
+
+void FVlcMediaTrack::ProcessMediaSample(const IVlcMediaSampleRef& Sample)
+{
+	if (FirstSampleTime == 0)
+	{
+		FPlatformAtomics::InterlockedCompareExchange(&FirstSampleTime, (int64)(FPlatformTime::Seconds() * 1000000.0), 0);
+	}
+
+	// only the list reference is copied, so that decoder threads hold the lock as briefly as possible
+	TSharedPtr<const TArray<FVlcMediaSinkDispatcherPtr>, ESPMode::ThreadSafe> CurrentDispatchers;
+	{
+		FScopeLock Lock(&DispatchersCriticalSection);
+		CurrentDispatchers = Dispatchers;
+	}
+
+	// queuing may block, so it happens outside of the lock; expired dispatchers are removed on the game thread
+	for (const FVlcMediaSinkDispatcherPtr& Dispatcher : *CurrentDispatchers)
+	{
+		if (!Dispatcher->IsSinkExpired())
+		{
+			Dispatcher->Enqueue(Sample);
+		}
+	}
+}
+
+
+void FVlcMediaTrack::RemoveDispatcher(const void* SinkKey)
+{
+	FVlcMediaSinkDispatcherPtr RemovedDispatcher = DetachDispatcher(SinkKey);
+
+	// this also releases a decoder thread that is blocked on the dispatcher
+	if (RemovedDispatcher.IsValid())
+	{
+		RemovedDispatcher->Shutdown();
+		HandleDispatchersChanged();
+	}
+}
+
+
+FVlcMediaSinkDispatcherPtr FVlcMediaTrack::DetachDispatcher(const void* SinkKey)
+{
+	FScopeLock Lock(&DispatchersCriticalSection);
+
+	for (int32 DispatcherIndex = 0; DispatcherIndex < Dispatchers->Num(); ++DispatcherIndex)
+	{
+		if ((*Dispatchers)[DispatcherIndex]->GetSinkKey() == SinkKey)
 		{
-			Sink->ProcessMediaSample(SampleBuffer, SampleSize, SampleDuration, FTimespan::FromSeconds(LastTime));
+			FVlcMediaSinkDispatcherPtr Dispatcher = (*Dispatchers)[DispatcherIndex];
+
+			TSharedRef<TArray<FVlcMediaSinkDispatcherPtr>, ESPMode::ThreadSafe> NewDispatchers = MakeShareable(new TArray<FVlcMediaSinkDispatcherPtr>(*Dispatchers));
+			NewDispatchers->RemoveAt(DispatcherIndex);
+			Dispatchers = NewDispatchers;
+
+			return Dispatcher;
 		}
 	}
+
+	return FVlcMediaSinkDispatcherPtr();
 }
 
 
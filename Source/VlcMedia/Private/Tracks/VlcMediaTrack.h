@@ -18,16 +18,15 @@ public:
 	 * Creates and initializes a new instance.
 	 *
 	 * @param InPlayer The media player that owns this track.
+	 * @param InClock The playback clock of the media player.
+	 * @param InState The cached state of the media player.
 	 * @param InTrackIndex The index number of this track.
+	 * @param Descr The track description.
 	 */
-    FVlcMediaTrack(FLibvlcMediaPlayer* InPlayer, uint32 InTrackIndex, FLibvlcTrackDescription* Descr);
+    FVlcMediaTrack(FLibvlcMediaPlayer* InPlayer, const FVlcMediaPlayerClockRef& InClock, const FVlcMediaPlayerStateRef& InState, uint32 InTrackIndex, FLibvlcTrackDescription* Descr);
 
-public:
-
-	void SetTime(float Time)
-	{
-		LastTime = Time;
-	}
+	/** Virtual destructor. */
+	virtual ~FVlcMediaTrack();
 
 public:
 
@@ -42,8 +41,45 @@ public:
     virtual bool IsProtected() const override;
     virtual void RemoveSink(const IMediaSinkRef& Sink) override;
 
-protected:
-	
+public:
+
+	/**
+	 * Update the track (called once per game tick by the media player).
+	 *
+	 * The scheduler ticks the tracks of many players on task graph workers, so this may be
+	 * called on any thread, but the tracks of a player are ticked one after another, and
+	 * never concurrently with themselves. State that only Tick accesses needs no locking,
+	 * but anything shared with other players or the game thread does.
+	 *
+	 * @param Time The current playback time.
+	 */
+	virtual void Tick(FTimespan Time) { }
+
+	/**
+	 * Remove and shut down the dispatchers of sinks that were destroyed (called on the game thread).
+	 *
+	 * Decoder threads skip these dispatchers, but never modify the dispatcher list themselves.
+	 */
+	void RemoveExpiredDispatchers();
+
+	/**
+	 * Register the track's output callbacks with its libvlc player (called on the game thread).
+	 *
+	 * Only tracks that receive decoded data have output callbacks. libvlc picks them up
+	 * when it creates the next output, while existing outputs keep using the old ones.
+	 */
+	virtual void BindOutput() { }
+
+	/**
+	 * Get the platform time at which the first sample was delivered.
+	 *
+	 * @return Time (in seconds), or zero if no sample was delivered yet.
+	 */
+	double GetFirstSampleTime() const
+	{
+		return FirstSampleTime / 1000000.0;
+	}
+
 	/**
 	 * Get the VLC media player that owns this track.
 	 *
@@ -55,21 +91,133 @@ protected:
 	}
 
 	/**
-	 * Process a media data sample.
+	 * Get the libvlc identifier of the elementary stream that this track represents.
+	 *
+	 * @return Track identifier.
+	 */
+	int32 GetTrackId() const
+	{
+		return TrackId;
+	}
+
+	/**
+	 * Move the track to the libvlc player of the next media item (called on the game thread).
+	 *
+	 * Registered sinks stay attached. A stream that already runs on the new player is
+	 * restarted, so that libvlc picks up the track's callbacks.
+	 *
+	 * @param NewPlayer The player to move to.
+	 * @param NewTrackId The identifier of the corresponding elementary stream in the next media.
+	 */
+	virtual void Rebind(FLibvlcMediaPlayer* NewPlayer, int32 NewTrackId);
+
+	/**
+	 * Set the track's index number (when tracks in front of it were removed).
+	 *
+	 * @param InTrackIndex The new index number.
+	 */
+	void SetIndex(uint32 InTrackIndex)
+	{
+		TrackIndex = InTrackIndex;
+	}
+
+protected:
+
+	/**
+	 * Add a sink dispatcher, replacing any existing dispatcher for the same sink.
+	 *
+	 * @param Dispatcher The dispatcher to add.
+	 * @see FindDispatcher, RemoveDispatcher
+	 */
+	void AddDispatcher(const FVlcMediaSinkDispatcherPtr& Dispatcher);
+
+	/**
+	 * Find the dispatcher of a sink.
+	 *
+	 * @param SinkKey Pointer that identifies the sink.
+	 * @return The dispatcher, or nullptr if the sink is not registered.
+	 * @see AddDispatcher, RemoveDispatcher
+	 */
+	FVlcMediaSinkDispatcherPtr FindDispatcher(const void* SinkKey) const;
+
+	/**
+	 * Get the delivery options of all registered sinks.
+	 *
+	 * @param OutOptions Will contain the options.
+	 */
+	void GetDispatcherOptions(TArray<FVlcMediaSinkOptions>& OutOptions) const;
+
+	/**
+	 * Called after a sink was added, removed, expired or changed its options (on the game thread).
+	 */
+	virtual void HandleDispatchersChanged() { }
+
+	/**
+	 * Remove the dispatcher of a sink.
+	 *
+	 * @param SinkKey Pointer that identifies the sink.
+	 * @see AddDispatcher, FindDispatcher
+	 */
+	void RemoveDispatcher(const void* SinkKey);
+
+protected:
+	
+	/**
+	 * Get the playback clock of the media player.
+	 *
+	 * @return The clock.
+	 */
+	const FVlcMediaPlayerClock& GetClock() const
+	{
+		return *Clock;
+	}
+
+	/**
+	 * Get the cached state of the media player.
+	 *
+	 * @return The state.
+	 */
+	FVlcMediaPlayerState& GetPlayerState() const
+	{
+		return *State;
+	}
+
+	/**
+	 * Queue a media sample for delivery to all registered sinks.
 	 *
-	 * @param SampleBuffer The buffer containing the sample data.
-	 * @param SampleSize The number of bytes in the buffer.
-	 * @param SampleDuration The sample's duration.
+	 * @param Sample The sample to deliver.
 	 */
-    void ProcessMediaSample(const void* SampleBuffer, uint32 SampleSize, FTimespan SampleDuration);
+	void ProcessMediaSample(const IVlcMediaSampleRef& Sample);
 
 private:
 
+	/**
+	 * Remove the dispatcher of a sink without shutting it down.
+	 *
+	 * @param SinkKey Pointer that identifies the sink.
+	 * @return The removed dispatcher, or nullptr if the sink is not registered.
+	 */
+	FVlcMediaSinkDispatcherPtr DetachDispatcher(const void* SinkKey);
+
+private:
+
+	/** Type definition for immutable lists of sink dispatchers. */
+	typedef TSharedRef<const TArray<FVlcMediaSinkDispatcherPtr>, ESPMode::ThreadSafe> FDispatcherListRef;
+
+	/** The sink dispatchers (replaced as a whole whenever a sink is added or removed, so decoder threads can iterate without copying). */
+	FDispatcherListRef Dispatchers;
+
+	/** Critical section for synchronizing access to the dispatcher list. */
+	mutable FCriticalSection DispatchersCriticalSection;
+
 	/** The track's human readable name. */
 	FText DisplayName;
 
-	/** Last known playback time as a workaround for VLC's broken time management. */
-	float LastTime;
+	/** The platform time at which the first sample was delivered (in microseconds). */
+	volatile int64 FirstSampleTime;
+
+	/** The playback clock of the media player. */
+	FVlcMediaPlayerClockRef Clock;
 
 	/** The track's name. */
 	FString Name;
@@ -77,8 +225,11 @@ private:
 	/** The VLC media player that owns this track. */
 	FLibvlcMediaPlayer* Player;
 
-	/** The collection of registered media sinks. */
-    TArray<IMediaSinkWeakPtr> Sinks;
+	/** The cached state of the media player. */
+	FVlcMediaPlayerStateRef State;
+
+	/** The libvlc identifier of the track's elementary stream. */
+	int32 TrackId;
 
 	/** The track's index number. */
     uint32 TrackIndex;
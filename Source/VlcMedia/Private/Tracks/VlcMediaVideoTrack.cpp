@@ -3,42 +3,151 @@
 #include "VlcMediaPrivatePCH.h"
 
 
+/** Number of pictures that libvlc may lock at the same time. */
+#define VLCMEDIA_NUM_VIDEO_FRAMES 3
+
+/** Number of pooled video samples (decoder pictures plus samples held by sinks). */
+#define VLCMEDIA_NUM_VIDEO_SAMPLES 8
+
+/** Number of samples that may wait for presentation if frame pacing is enabled. */
+#define VLCMEDIA_NUM_PRESENTATION_SAMPLES 4
+
+
+namespace VlcMediaVideoTrack
+{
+	/**
+	 * Get the libvlc name of a video chroma.
+	 *
+	 * @param Chroma The chroma.
+	 * @return The four character code that libvlc uses for the chroma.
+	 */
+	const ANSICHAR* GetChromaName(EVlcMediaVideoChroma Chroma)
+	{
+		switch (Chroma)
+		{
+		case EVlcMediaVideoChroma::I420:
+			return "I420";
+
+		case EVlcMediaVideoChroma::Nv12:
+			return "NV12";
+
+		default:
+			return "RV32";
+		}
+	}
+
+
+	/**
+	 * Get the layout of BGRA samples converted from a YUV layout.
+	 *
+	 * @param Layout The layout of the decoded frames.
+	 * @return The layout of the converted samples.
+	 */
+	FVlcMediaVideoLayout GetConvertedLayout(const FVlcMediaVideoLayout& Layout)
+	{
+		FVlcMediaVideoLayout Result;
+		{
+			Result.Chroma = EVlcMediaVideoChroma::Rv32;
+			Result.Dimensions = Layout.Dimensions;
+			Result.NumPlanes = 1;
+			Result.Planes[0].Pitch = Layout.Dimensions.X * 4;
+			Result.Planes[0].Lines = Layout.Dimensions.Y;
+			Result.BufferSize = Result.Planes[0].Pitch * Result.Planes[0].Lines;
+		}
+
+		return Result;
+	}
+
+
+	/**
+	 * Get the size to decode video to.
+	 *
+	 * The video is scaled down, preserving its aspect ratio, until it fits the maximum size.
+	 * It is never scaled up, and dimensions are kept even for 4:2:0 chroma subsampling.
+	 *
+	 * @param Native The dimensions of the video.
+	 * @param Max The maximum output size (zero for no limit in that direction).
+	 * @return The output dimensions.
+	 */
+	FIntPoint GetOutputDimensions(const FIntPoint& Native, const FIntPoint& Max)
+	{
+		float Scale = 1.0f;
+
+		if ((Max.X > 0) && (Native.X > Max.X))
+		{
+			Scale = FMath::Min(Scale, (float)Max.X / Native.X);
+		}
+
+		if ((Max.Y > 0) && (Native.Y > Max.Y))
+		{
+			Scale = FMath::Min(Scale, (float)Max.Y / Native.Y);
+		}
+
+		if (Scale >= 1.0f)
+		{
+			return Native;
+		}
+
+		return FIntPoint(
+			FMath::Max(2, FMath::FloorToInt(Native.X * Scale) & ~1),
+			FMath::Max(2, FMath::FloorToInt(Native.Y * Scale) & ~1));
+	}
+
+
+	/**
+	 * Get the number of bytes that sinks receive for a sample.
+	 *
+	 * Sample buffers are allocated with extra lines at the bottom for decoders that write whole
+	 * macro blocks, but sinks that consume the buffer as a whole expect only the visible rows.
+	 *
+	 * @param Layout The layout of the sample.
+	 * @return The size up to the end of the last visible row (in bytes).
+	 */
+	uint32 GetSampleSize(const FVlcMediaVideoLayout& Layout)
+	{
+		if (Layout.NumPlanes == 0)
+		{
+			return 0;
+		}
+
+		const FVlcMediaVideoPlane& LastPlane = Layout.Planes[Layout.NumPlanes - 1];
+
+		return LastPlane.Offset + LastPlane.Pitch * LastPlane.Lines;
+	}
+}
+
+
 /* FVlcMediaVideoTrack structors
  *****************************************************************************/
 
-FVlcMediaVideoTrack::FVlcMediaVideoTrack(FLibvlcMediaPlayer* InPlayer, uint32 InTrackIndex, FLibvlcTrackDescription* Descr)
-	: FVlcMediaTrack(InPlayer, InTrackIndex, Descr)
+FVlcMediaVideoTrack::FVlcMediaVideoTrack(FLibvlcMediaPlayer* InPlayer, const FVlcMediaPlayerClockRef& InClock, const FVlcMediaPlayerStateRef& InState, uint32 InTrackIndex, FLibvlcTrackDescription* Descr)
+	: FVlcMediaTrack(InPlayer, InClock, InState, InTrackIndex, Descr)
+	, ConvertToBgra(false)
+	, DesiredChroma(EVlcMediaVideoChroma::Rv32)
 	, Dimensions(ForceInitToZero)
+	, MaxDimensions(ForceInitToZero)
+	, NativeDimensions(ForceInitToZero)
+	, FramePacing(false)
+	, FrameRate(0.0f)
 	, LastDelta(FTimespan::Zero())
+	, LastSampleTime(FTimespan::Zero())
+	, PendingPictures(VLCMEDIA_NUM_VIDEO_FRAMES)
+	, PresentationQueue(VLCMEDIA_NUM_PRESENTATION_SAMPLES)
+	, StaticFrameMode(EVlcMediaStaticFrameMode::Disabled)
 	, VideoTrackId(Descr->Id)
 {
 	Dimensions.X = FVlc::VideoGetWidth(InPlayer);
 	Dimensions.Y = FVlc::VideoGetHeight(InPlayer);
+	NativeDimensions = Dimensions;
 
-	if (Dimensions.GetMin() > 0)
-	{
-		FrameBuffer.AddUninitialized(Dimensions.X * Dimensions.Y * 4);
-
-		// @todo gmp: implement support for multiple active VLC tracks
-		FVlc::VideoSetCallbacks(
-			InPlayer,
-			&FVlcMediaVideoTrack::HandleVideoLock,
-			&FVlcMediaVideoTrack::HandleVideoUnlock,
-			&FVlcMediaVideoTrack::HandleVideoDisplay,
-			this);
-
-		FVlc::VideoSetFormat(InPlayer, "RV32", Dimensions.X, Dimensions.Y, Dimensions.X * 4);
-	}
+	// @todo gmp: implement support for multiple active VLC tracks
+	BindOutput();
 }
 
 
 FVlcMediaVideoTrack::~FVlcMediaVideoTrack()
 {
-	if (Dimensions.GetMin() > 0)
-	{
-		// @todo gmp: this is probably not thread-safe
-		FVlc::VideoSetCallbacks(GetPlayer(), nullptr, nullptr, nullptr, nullptr);
-	}
+	// the player may be in use by another media player by now, so the pool removes the callbacks when it stops the player
 }
 
 
@@ -47,14 +156,33 @@ FVlcMediaVideoTrack::~FVlcMediaVideoTrack()
 
 bool FVlcMediaVideoTrack::Disable()
 {
-	return (!IsEnabled() || (FVlc::VideoSetTrack(GetPlayer(), -1) == 0));
+	if (!IsEnabled())
+	{
+		return true;
+	}
+
+	if (FVlc::VideoSetTrack(GetPlayer(), -1) != 0)
+	{
+		return false;
+	}
+
+	GetPlayerState().SetSelectedTrack(ELibvlcTrackType::Video, -1);
+
+	return true;
 }
 
 
 bool FVlcMediaVideoTrack::Enable()
 {
 	// @todo gmp: implement support for multiple active VLC tracks
-	return (FVlc::VideoSetTrack(GetPlayer(), VideoTrackId) == 0);
+	if (FVlc::VideoSetTrack(GetPlayer(), VideoTrackId) != 0)
+	{
+		return false;
+	}
+
+	GetPlayerState().SetSelectedTrack(ELibvlcTrackType::Video, VideoTrackId);
+
+	return true;
 }
 
 
@@ -87,7 +215,7 @@ const IMediaTrackVideoDetails& FVlcMediaVideoTrack::GetVideoDetails() const
 bool FVlcMediaVideoTrack::IsEnabled() const
 {
 	// @todo gmp: implement support for multiple active VLC tracks
-	return (FVlc::VideoGetTrack(GetPlayer()) == VideoTrackId);
+	return (GetPlayerState().GetSelectedTrack(ELibvlcTrackType::Video) == VideoTrackId);
 }
 
 
@@ -102,6 +230,8 @@ uint32 FVlcMediaVideoTrack::GetBitRate() const
 
 FIntPoint FVlcMediaVideoTrack::GetDimensions() const
 {
+	FScopeLock Lock(&LayoutCriticalSection);
+
 	return Dimensions;
 }
 
@@ -112,35 +242,644 @@ float FVlcMediaVideoTrack::GetFrameRate() const
 }
 
 
-/* FVlcMediaVideoTrack static functions
+/* IVlcMediaVideoTrack interface
  *****************************************************************************/
 
-void* FVlcMediaVideoTrack::HandleVideoLock(void* Opaque, void** Planes)
+void FVlcMediaVideoTrack::AddSampleSink(const IVlcMediaSampleSinkRef& Sink, const FVlcMediaSinkOptions& Options)
 {
-	if (Opaque != nullptr)
+	AddDispatcher(MakeShareable(new FVlcMediaSampleSinkDispatcher(Sink, Options)));
+}
+
+
+FVlcMediaFramePacingStats FVlcMediaVideoTrack::GetFramePacingStats() const
+{
+	return PresentationQueue.GetStats();
+}
+
+
+EVlcMediaVideoChroma FVlcMediaVideoTrack::GetOutputChroma() const
+{
+	FScopeLock Lock(&LayoutCriticalSection);
+
+	return DesiredChroma;
+}
+
+
+FVlcMediaVideoLayout FVlcMediaVideoTrack::GetSampleLayout() const
+{
+	FScopeLock Lock(&LayoutCriticalSection);
+
+	if (ConvertToBgra && (Layout.Chroma != EVlcMediaVideoChroma::Rv32))
+	{
+		return VlcMediaVideoTrack::GetConvertedLayout(Layout);
+	}
+
+	return Layout;
+}
+
+
+void FVlcMediaVideoTrack::GetSamplePoolStats(FVlcMediaSamplePoolStats& OutDecoded, FVlcMediaSamplePoolStats& OutConverted) const
+{
+	FScopeLock Lock(&LayoutCriticalSection);
+
+	OutDecoded = DecodedPool.IsValid() ? DecodedPool->GetStats() : FVlcMediaSamplePoolStats();
+	OutConverted = ConvertedPool.IsValid() ? ConvertedPool->GetStats() : FVlcMediaSamplePoolStats();
+}
+
+
+EVlcMediaStaticFrameMode FVlcMediaVideoTrack::GetStaticFrameMode() const
+{
+	FScopeLock Lock(&LayoutCriticalSection);
+
+	return StaticFrameMode;
+}
+
+
+FVlcMediaStaticFrameStats FVlcMediaVideoTrack::GetStaticFrameStats() const
+{
+	FScopeLock Lock(&LayoutCriticalSection);
+
+	return StaticFrameStats;
+}
+
+
+bool FVlcMediaVideoTrack::IsColorConversionEnabled() const
+{
+	FScopeLock Lock(&LayoutCriticalSection);
+
+	return ConvertToBgra;
+}
+
+
+bool FVlcMediaVideoTrack::IsFramePacingEnabled() const
+{
+	FScopeLock Lock(&LayoutCriticalSection);
+
+	return FramePacing;
+}
+
+
+bool FVlcMediaVideoTrack::GetSinkStats(const IMediaSinkRef& Sink, FVlcMediaSinkStats& OutStats) const
+{
+	FVlcMediaSinkDispatcherPtr Dispatcher = FindDispatcher(&Sink.Get());
+
+	if (!Dispatcher.IsValid())
+	{
+		return false;
+	}
+
+	OutStats = Dispatcher->GetStats();
+
+	return true;
+}
+
+
+bool FVlcMediaVideoTrack::GetSinkStats(const IVlcMediaSampleSinkRef& Sink, FVlcMediaSinkStats& OutStats) const
+{
+	FVlcMediaSinkDispatcherPtr Dispatcher = FindDispatcher(&Sink.Get());
+
+	if (!Dispatcher.IsValid())
+	{
+		return false;
+	}
+
+	OutStats = Dispatcher->GetStats();
+
+	return true;
+}
+
+
+void FVlcMediaVideoTrack::RemoveSampleSink(const IVlcMediaSampleSinkRef& Sink)
+{
+	RemoveDispatcher(&Sink.Get());
+}
+
+
+void FVlcMediaVideoTrack::SetColorConversion(bool Enabled, EVlcMediaColorMatrix Matrix, EVlcMediaColorRange Range)
+{
+	FScopeLock Lock(&LayoutCriticalSection);
+
+	ColorConverter.SetColorSpace(Matrix, Range);
+	ConvertToBgra = Enabled;
+}
+
+
+void FVlcMediaVideoTrack::SetFramePacing(bool Enabled)
+{
+	{
+		FScopeLock Lock(&LayoutCriticalSection);
+		FramePacing = Enabled;
+	}
+
+	if (!Enabled)
+	{
+		PresentationQueue.Flush();
+	}
+}
+
+
+bool FVlcMediaVideoTrack::SetSinkOptions(const IMediaSinkRef& Sink, const FVlcMediaSinkOptions& Options)
+{
+	if (!FindDispatcher(&Sink.Get()).IsValid())
+	{
+		return false;
+	}
+
+	AddDispatcher(MakeShareable(new FVlcMediaFrameworkSinkDispatcher(Sink, Options)));
+
+	return true;
+}
+
+
+bool FVlcMediaVideoTrack::SetOutputChroma(EVlcMediaVideoChroma Chroma)
+{
+	FScopeLock Lock(&LayoutCriticalSection);
+
+	DesiredChroma = Chroma;
+
+	return true;
+}
+
+
+void FVlcMediaVideoTrack::SetStaticFrameMode(EVlcMediaStaticFrameMode Mode)
+{
+	FScopeLock Lock(&LayoutCriticalSection);
+
+	StaticFrameMode = Mode;
+}
+
+
+/* FVlcMediaTrack interface
+ *****************************************************************************/
+
+void FVlcMediaVideoTrack::BindOutput()
+{
+	FVlc::VideoSetCallbacks(
+		GetPlayer(),
+		&FVlcMediaVideoTrack::HandleVideoLock,
+		&FVlcMediaVideoTrack::HandleVideoUnlock,
+		&FVlcMediaVideoTrack::HandleVideoDisplay,
+		this);
+
+	FVlc::VideoSetFormatCallbacks(
+		GetPlayer(),
+		&FVlcMediaVideoTrack::HandleVideoSetup,
+		&FVlcMediaVideoTrack::HandleVideoCleanup);
+}
+
+
+void FVlcMediaVideoTrack::HandleDispatchersChanged()
+{
+	const FIntPoint NewMaxDimensions = GetSinkMaxDimensions();
+	bool OutputChanged = false;
 	{
-		FVlcMediaVideoTrack* VideoTrack = (FVlcMediaVideoTrack*)Opaque;
+		FScopeLock Lock(&LayoutCriticalSection);
+
+		if (NewMaxDimensions == MaxDimensions)
 		{
-			*Planes = VideoTrack->FrameBuffer.GetData();
+			return;
 		}
+
+		MaxDimensions = NewMaxDimensions;
+		OutputChanged = (Layout.BufferSize > 0) && (VlcMediaVideoTrack::GetOutputDimensions(NativeDimensions, MaxDimensions) != Dimensions);
 	}
 
-	return nullptr;
+	// restarting the video stream makes libvlc negotiate a new output format
+	if (OutputChanged && IsEnabled())
+	{
+		FVlc::VideoSetTrack(GetPlayer(), -1);
+		FVlc::VideoSetTrack(GetPlayer(), VideoTrackId);
+	}
 }
 
 
-void FVlcMediaVideoTrack::HandleVideoUnlock(void* Opaque, void* /*Picture*/, void* const* Planes)
+void FVlcMediaVideoTrack::Rebind(FLibvlcMediaPlayer* NewPlayer, int32 NewTrackId)
 {
+	FVlc::VideoSetCallbacks(GetPlayer(), nullptr, nullptr, nullptr, nullptr);
+	FVlc::VideoSetFormatCallbacks(GetPlayer(), nullptr, nullptr);
+
+	// the output callbacks query the player on libvlc's video output thread
+	{
+		FScopeLock Lock(&LayoutCriticalSection);
+		FVlcMediaTrack::Rebind(NewPlayer, NewTrackId);
+	}
+
+	// frames of the previous media are timed against the previous clock
+	PresentationQueue.Flush();
+	VideoTrackId = NewTrackId;
+
+	BindOutput();
+
+	if (FVlc::VideoGetTrack(NewPlayer) == NewTrackId)
+	{
+		FVlc::VideoSetTrack(NewPlayer, -1);
+		FVlc::VideoSetTrack(NewPlayer, NewTrackId);
+	}
 }
 
 
-void FVlcMediaVideoTrack::HandleVideoDisplay(void* Opaque, void* /*Picture*/)
+void FVlcMediaVideoTrack::Tick(FTimespan Time)
 {
-	if (Opaque != nullptr)
+	TRefCountPtr<FVlcMediaSample> Sample;
+
+	if (PresentationQueue.Dequeue(Time, Sample))
+	{
+		ProcessMediaSample(IVlcMediaSampleRef(Sample.GetReference()));
+	}
+}
+
+
+/* FVlcMediaVideoTrack implementation
+ *****************************************************************************/
+
+uint32 FVlcMediaVideoTrack::ConfigureOutput(ANSICHAR* Chroma, uint32& Width, uint32& Height, uint32* OutPitches, uint32* OutLines)
+{
+	const FIntPoint DecodedDimensions(Width, Height);
+	EVlcMediaVideoChroma OutputChroma;
+	FLibvlcMediaPlayer* OutputPlayer = nullptr;
+
+	// libvlc scales to the requested size before handing out the pictures
+	{
+		FScopeLock Lock(&LayoutCriticalSection);
+
+		OutputChroma = DesiredChroma;
+		OutputPlayer = GetPlayer();
+
+		const FIntPoint OutputDimensions = VlcMediaVideoTrack::GetOutputDimensions(DecodedDimensions, MaxDimensions);
+
+		NativeDimensions = DecodedDimensions;
+		Width = OutputDimensions.X;
+		Height = OutputDimensions.Y;
+	}
+
+	FVlcMediaVideoLayout NewLayout;
+	{
+		NewLayout.Chroma = OutputChroma;
+		NewLayout.Dimensions = FIntPoint(Width, Height);
+	}
+
+	// rows are padded for SIMD friendly access, and some
+	// decoders write whole macro blocks beyond the visible area
+	const uint32 AllocatedLines = Align(Height, 16);
+	const uint32 ChromaLines = (Height + 1) / 2;
+
+	switch (OutputChroma)
+	{
+	case EVlcMediaVideoChroma::I420:
+		NewLayout.NumPlanes = 3;
+		OutPitches[0] = Align(Width, 32);
+		OutPitches[1] = OutPitches[2] = Align((Width + 1) / 2, 32);
+		OutLines[0] = AllocatedLines;
+		OutLines[1] = OutLines[2] = AllocatedLines / 2;
+		break;
+
+	case EVlcMediaVideoChroma::Nv12:
+		NewLayout.NumPlanes = 2;
+		OutPitches[0] = Align(Width, 32);
+		OutPitches[1] = Align(((Width + 1) / 2) * 2, 32);
+		OutLines[0] = AllocatedLines;
+		OutLines[1] = AllocatedLines / 2;
+		break;
+
+	default:
+		// tightly packed, because sinks expect contiguous BGRA rows
+		NewLayout.NumPlanes = 1;
+		OutPitches[0] = Width * 4;
+		OutLines[0] = AllocatedLines;
+	}
+
+	// planes are stored back to back in a single buffer
+	for (int32 PlaneIndex = 0; PlaneIndex < NewLayout.NumPlanes; ++PlaneIndex)
+	{
+		FVlcMediaVideoPlane& Plane = NewLayout.Planes[PlaneIndex];
+		{
+			Plane.Offset = NewLayout.BufferSize;
+			Plane.Pitch = OutPitches[PlaneIndex];
+			Plane.Lines = (PlaneIndex == 0) ? Height : ChromaLines;
+		}
+
+		NewLayout.BufferSize += OutPitches[PlaneIndex] * OutLines[PlaneIndex];
+	}
+
+	{
+		FScopeLock Lock(&LayoutCriticalSection);
+
+		// samples of the previous format that are still held by sinks keep the old pool alive
+		if (!DecodedPool.IsValid() || (DecodedPool->GetBufferSize() != NewLayout.BufferSize))
+		{
+			DecodedPool = MakeShareable(new FVlcMediaSamplePool(NewLayout.BufferSize, VLCMEDIA_NUM_VIDEO_SAMPLES));
+		}
+
+		Dimensions = NewLayout.Dimensions;
+		Layout = NewLayout;
+	}
+
+	FMemory::Memcpy(Chroma, VlcMediaVideoTrack::GetChromaName(OutputChroma), 4);
+
+	FrameRate = FVlc::MediaPlayerGetFps(OutputPlayer);
+	LastSampleTime = FTimespan::Zero();
+	PreviousSample.SafeRelease();
+
+	return VLCMEDIA_NUM_VIDEO_FRAMES;
+}
+
+
+FTimespan FVlcMediaVideoTrack::GetFrameDuration(FTimespan Time)
+{
+	// the frame rate is not always known when the output is set up
+	if (FrameRate <= 0.0f)
+	{
+		FLibvlcMediaPlayer* OutputPlayer = nullptr;
+		{
+			FScopeLock Lock(&LayoutCriticalSection);
+			OutputPlayer = GetPlayer();
+		}
+
+		FrameRate = FVlc::MediaPlayerGetFps(OutputPlayer);
+	}
+
+	FTimespan Duration = FTimespan::Zero();
+
+	if (FrameRate > 0.0f)
+	{
+		Duration = FTimespan::FromSeconds(1.0 / FrameRate);
+	}
+	else if (Time > LastSampleTime)
+	{
+		Duration = Time - LastSampleTime;
+	}
+
+	LastSampleTime = Time;
+
+	return Duration;
+}
+
+
+FTimespan FVlcMediaVideoTrack::GetPresentationTime(FTimespan ClockTime) const
+{
+	if ((FrameRate <= 0.0f) || (LastSampleTime <= FTimespan::Zero()))
+	{
+		return ClockTime;
+	}
+
+	const FTimespan ExpectedTime = LastSampleTime + FTimespan::FromSeconds(1.0 / FrameRate);
+	const FTimespan Tolerance = FTimespan::FromSeconds(0.5 / FrameRate);
+
+	if ((ClockTime < ExpectedTime - Tolerance) || (ClockTime > ExpectedTime + Tolerance))
+	{
+		return ClockTime;
+	}
+
+	return ExpectedTime;
+}
+
+
+FIntPoint FVlcMediaVideoTrack::GetSinkMaxDimensions() const
+{
+	TArray<FVlcMediaSinkOptions> SinkOptions;
+	GetDispatcherOptions(SinkOptions);
+
+	if (SinkOptions.Num() == 0)
+	{
+		return FIntPoint::ZeroValue;
+	}
+
+	FIntPoint Result(ForceInitToZero);
+	bool FirstSink = true;
+
+	// a direction is only limited if every sink limits it
+	for (const FVlcMediaSinkOptions& Options : SinkOptions)
+	{
+		Result.X = ((Options.MaxDimensions.X <= 0) || (!FirstSink && (Result.X == 0))) ? 0 : FMath::Max(Result.X, Options.MaxDimensions.X);
+		Result.Y = ((Options.MaxDimensions.Y <= 0) || (!FirstSink && (Result.Y == 0))) ? 0 : FMath::Max(Result.Y, Options.MaxDimensions.Y);
+		FirstSink = false;
+	}
+
+	return Result;
+}
+
+
+TRefCountPtr<FVlcMediaSample> FVlcMediaVideoTrack::ConvertSample(FVlcMediaSample& Sample)
+{
+	const FVlcMediaVideoLayout& SampleLayout = Sample.GetLayout();
+	const FVlcMediaVideoLayout ConvertedLayout = VlcMediaVideoTrack::GetConvertedLayout(SampleLayout);
+
+	FVlcMediaColorConverter Converter;
+	TSharedPtr<FVlcMediaSamplePool, ESPMode::ThreadSafe> Pool;
+	{
+		FScopeLock Lock(&LayoutCriticalSection);
+
+		if (!ConvertToBgra || (SampleLayout.Chroma == EVlcMediaVideoChroma::Rv32))
+		{
+			return TRefCountPtr<FVlcMediaSample>(&Sample);
+		}
+
+		if (!ConvertedPool.IsValid() || (ConvertedPool->GetBufferSize() != ConvertedLayout.BufferSize))
+		{
+			ConvertedPool = MakeShareable(new FVlcMediaSamplePool(ConvertedLayout.BufferSize, VLCMEDIA_NUM_VIDEO_SAMPLES));
+		}
+
+		Converter = ColorConverter;
+		Pool = ConvertedPool;
+	}
+
+	TRefCountPtr<FVlcMediaSample> ConvertedSample = Pool->Acquire();
+	{
+		ConvertedSample->SetDirtyRects(Sample.GetDirtyRects());
+		ConvertedSample->SetDuration(Sample.GetDuration());
+		ConvertedSample->SetLayout(ConvertedLayout);
+		ConvertedSample->SetTime(Sample.GetTime());
+	}
+
+	Converter.Convert(SampleLayout, Sample.GetData(), ConvertedSample->GetBuffer(), ConvertedLayout.Planes[0].Pitch);
+
+	return ConvertedSample;
+}
+
+
+bool FVlcMediaVideoTrack::DetectChanges(FVlcMediaSample& Sample)
+{
+	EVlcMediaStaticFrameMode Mode;
+	{
+		FScopeLock Lock(&LayoutCriticalSection);
+		Mode = StaticFrameMode;
+	}
+
+	if (Mode == EVlcMediaStaticFrameMode::Disabled)
+	{
+		PreviousSample.SafeRelease();
+
+		return true;
+	}
+
+	const FVlcMediaVideoLayout& SampleLayout = Sample.GetLayout();
+
+	// the first frame after enabling detection or changing formats is always delivered
+	if (!PreviousSample.IsValid() || (PreviousSample->GetSize() != Sample.GetSize()) || (PreviousSample->GetLayout().Dimensions != SampleLayout.Dimensions))
+	{
+		PreviousSample = &Sample;
+
+		return true;
+	}
+
+	int32 NumTiles = 0;
+	const bool StopAtFirstChange = (Mode != EVlcMediaStaticFrameMode::DirtyRects);
+	const int32 NumDirtyTiles = FVlcMediaFrameDiff::Compare(SampleLayout, Sample.GetData(), PreviousSample->GetData(), StopAtFirstChange, DirtyRects, NumTiles);
+	const bool Partial = !StopAtFirstChange && (NumDirtyTiles > 0) && (NumDirtyTiles < NumTiles);
+
+	if (Partial)
+	{
+		Sample.SetDirtyRects(DirtyRects);
+	}
+
 	{
-		FVlcMediaVideoTrack* VideoTrack = (FVlcMediaVideoTrack*)Opaque;
+		FScopeLock Lock(&LayoutCriticalSection);
+
+		++StaticFrameStats.NumFramesChecked;
+
+		if (NumDirtyTiles == 0)
+		{
+			++StaticFrameStats.NumFramesSuppressed;
+			StaticFrameStats.NumBytesSaved += Sample.GetSize();
+		}
+		else if (Partial)
 		{
-			VideoTrack->ProcessMediaSample(VideoTrack->FrameBuffer.GetData(), VideoTrack->FrameBuffer.Num(), 0.0f);
+			++StaticFrameStats.NumFramesPartial;
+			StaticFrameStats.NumBytesSaved += (uint64)Sample.GetSize() * (NumTiles - NumDirtyTiles) / NumTiles;
 		}
 	}
+
+	if (NumDirtyTiles == 0)
+	{
+		// keep the previous sample, so that its buffer stays the reference for the next comparison
+		return false;
+	}
+
+	PreviousSample = &Sample;
+
+	return true;
+}
+
+
+/* FVlcMediaVideoTrack static functions
+ *****************************************************************************/
+
+uint32 FVlcMediaVideoTrack::HandleVideoSetup(void** Opaque, ANSICHAR* Chroma, uint32* Width, uint32* Height, uint32* Pitches, uint32* Lines)
+{
+	if ((Opaque == nullptr) || (*Opaque == nullptr) || (*Width == 0) || (*Height == 0))
+	{
+		return 0;
+	}
+
+	FVlcMediaVideoTrack* VideoTrack = (FVlcMediaVideoTrack*)*Opaque;
+
+	return VideoTrack->ConfigureOutput(Chroma, *Width, *Height, Pitches, Lines);
+}
+
+
+void FVlcMediaVideoTrack::HandleVideoCleanup(void* Opaque)
+{
+	// the sample pool is kept, so that its memory can be reused for the next format
+	if (Opaque != nullptr)
+	{
+		((FVlcMediaVideoTrack*)Opaque)->PendingPictures.Reset();
+	}
+}
+
+
+void* FVlcMediaVideoTrack::HandleVideoLock(void* Opaque, void** Planes)
+{
+	if (Opaque == nullptr)
+	{
+		return nullptr;
+	}
+
+	FVlcMediaVideoTrack* VideoTrack = (FVlcMediaVideoTrack*)Opaque;
+
+	TSharedPtr<FVlcMediaSamplePool, ESPMode::ThreadSafe> Pool;
+	FVlcMediaVideoLayout SampleLayout;
+	{
+		FScopeLock Lock(&VideoTrack->LayoutCriticalSection);
+
+		Pool = VideoTrack->DecodedPool;
+		SampleLayout = VideoTrack->Layout;
+	}
+
+	check(Pool.IsValid());
+
+	TRefCountPtr<FVlcMediaSample> Sample = Pool->Acquire();
+	{
+		Sample->SetLayout(SampleLayout);
+		Sample->SetSize(VlcMediaVideoTrack::GetSampleSize(SampleLayout));
+	}
+
+	for (int32 PlaneIndex = 0; PlaneIndex < SampleLayout.NumPlanes; ++PlaneIndex)
+	{
+		Planes[PlaneIndex] = Sample->GetBuffer() + SampleLayout.Planes[PlaneIndex].Offset;
+	}
+
+	// libvlc holds a reference until the picture is displayed or dropped
+	Sample->AddRef();
+
+	return Sample.GetReference();
+}
+
+
+void FVlcMediaVideoTrack::HandleVideoUnlock(void* Opaque, void* Picture, void* const* /*Planes*/)
+{
+	if (Picture == nullptr)
+	{
+		return;
+	}
+
+	FVlcMediaSample* Sample = (FVlcMediaSample*)Picture;
+
+	// the picture is displayed later, so its buffer must not be handed to the decoder again until then
+	if (Opaque != nullptr)
+	{
+		((FVlcMediaVideoTrack*)Opaque)->PendingPictures.Add(Sample);
+	}
+
+	Sample->Release();
+}
+
+
+void FVlcMediaVideoTrack::HandleVideoDisplay(void* Opaque, void* Picture)
+{
+	if ((Opaque == nullptr) || (Picture == nullptr))
+	{
+		return;
+	}
+
+	FVlcMediaVideoTrack* VideoTrack = (FVlcMediaVideoTrack*)Opaque;
+	TRefCountPtr<FVlcMediaSample> Sample;
+
+	// pictures that are no longer pending may have been recycled already
+	if (!VideoTrack->PendingPictures.Remove(Picture, Sample))
+	{
+		return;
+	}
+
+	// libvlc displays pictures when they are due, so the clock matches their presentation time
+	const FTimespan Time = VideoTrack->GetPresentationTime(VideoTrack->GetClock().GetTime());
+	{
+		Sample->SetDuration(VideoTrack->GetFrameDuration(Time));
+		Sample->SetTime(Time);
+	}
+
+	if (!VideoTrack->DetectChanges(*Sample))
+	{
+		return;
+	}
+
+	TRefCountPtr<FVlcMediaSample> OutputSample = VideoTrack->ConvertSample(*Sample);
+
+	if (VideoTrack->IsFramePacingEnabled())
+	{
+		VideoTrack->PresentationQueue.Enqueue(OutputSample);
+	}
+	else
+	{
+		VideoTrack->ProcessMediaSample(IVlcMediaSampleRef(OutputSample.GetReference()));
+	}
 }
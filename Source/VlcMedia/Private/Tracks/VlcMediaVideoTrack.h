@@ -6,6 +6,7 @@
 class FVlcMediaVideoTrack
 	: public FVlcMediaTrack
 	, public IMediaTrackVideoDetails
+	, public IVlcMediaVideoTrack
 {
 public:
 
@@ -13,10 +14,12 @@ public:
 	 * Creates and initializes a new instance.
 	 *
 	 * @param InPlayer The VLC media player instance that owns this track.
+	 * @param InClock The playback clock of the media player.
+	 * @param InState The cached state of the media player.
 	 * @param InTrackIndex The index number of this track.
 	 * @param Descr The track description.
 	 */
-	FVlcMediaVideoTrack(FLibvlcMediaPlayer* InPlayer, uint32 InTrackIndex, FLibvlcTrackDescription* Descr);
+	FVlcMediaVideoTrack(FLibvlcMediaPlayer* InPlayer, const FVlcMediaPlayerClockRef& InClock, const FVlcMediaPlayerStateRef& InState, uint32 InTrackIndex, FLibvlcTrackDescription* Descr);
 
 	/** Virtual destructor. */
 	virtual ~FVlcMediaVideoTrack();
@@ -41,23 +44,174 @@ public:
 	virtual const IMediaTrackVideoDetails& GetVideoDetails() const override;
     virtual bool IsEnabled() const override;
 
+public:
+
+	// IVlcMediaVideoTrack interface
+
+	virtual void AddSampleSink(const IVlcMediaSampleSinkRef& Sink, const FVlcMediaSinkOptions& Options) override;
+	virtual FVlcMediaFramePacingStats GetFramePacingStats() const override;
+	virtual EVlcMediaVideoChroma GetOutputChroma() const override;
+	virtual FVlcMediaVideoLayout GetSampleLayout() const override;
+	virtual void GetSamplePoolStats(FVlcMediaSamplePoolStats& OutDecoded, FVlcMediaSamplePoolStats& OutConverted) const override;
+	virtual bool GetSinkStats(const IMediaSinkRef& Sink, FVlcMediaSinkStats& OutStats) const override;
+	virtual bool GetSinkStats(const IVlcMediaSampleSinkRef& Sink, FVlcMediaSinkStats& OutStats) const override;
+	virtual EVlcMediaStaticFrameMode GetStaticFrameMode() const override;
+	virtual FVlcMediaStaticFrameStats GetStaticFrameStats() const override;
+	virtual bool IsColorConversionEnabled() const override;
+	virtual bool IsFramePacingEnabled() const override;
+	virtual void RemoveSampleSink(const IVlcMediaSampleSinkRef& Sink) override;
+	virtual void SetColorConversion(bool Enabled, EVlcMediaColorMatrix Matrix, EVlcMediaColorRange Range) override;
+	virtual void SetFramePacing(bool Enabled) override;
+	virtual bool SetOutputChroma(EVlcMediaVideoChroma Chroma) override;
+	virtual bool SetSinkOptions(const IMediaSinkRef& Sink, const FVlcMediaSinkOptions& Options) override;
+	virtual void SetStaticFrameMode(EVlcMediaStaticFrameMode Mode) override;
+
+protected:
+
+	// FVlcMediaTrack interface
+
+	virtual void BindOutput() override;
+	virtual void HandleDispatchersChanged() override;
+	virtual void Rebind(FLibvlcMediaPlayer* NewPlayer, int32 NewTrackId) override;
+	virtual void Tick(FTimespan Time) override;
+
+protected:
+
+	/**
+	 * Negotiate the output format with libvlc and set up the frame buffers.
+	 *
+	 * @param Chroma Will contain the four character code of the output chroma.
+	 * @param Width The width of the decoded video, replaced with the output width (in pixels).
+	 * @param Height The height of the decoded video, replaced with the output height (in pixels).
+	 * @param OutPitches Will contain the row pitch of each plane.
+	 * @param OutLines Will contain the number of allocated rows in each plane.
+	 * @return The number of picture buffers that libvlc may lock at the same time.
+	 */
+	uint32 ConfigureOutput(ANSICHAR* Chroma, uint32& Width, uint32& Height, uint32* OutPitches, uint32* OutLines);
+
+	/**
+	 * Get the duration of a displayed frame (called from the display callback).
+	 *
+	 * @param Time The presentation time of the frame.
+	 * @return Frame duration.
+	 */
+	FTimespan GetFrameDuration(FTimespan Time);
+
+	/**
+	 * Get the presentation time of a displayed frame (called from the display callback).
+	 *
+	 * Display callbacks jitter by a few milliseconds, so times that are close to the
+	 * expected time of the next frame are snapped to it.
+	 *
+	 * @param ClockTime The playback time at which the frame was displayed.
+	 * @return Presentation time.
+	 */
+	FTimespan GetPresentationTime(FTimespan ClockTime) const;
+
+	/**
+	 * Get the largest output size that satisfies all sinks.
+	 *
+	 * @return Maximum dimensions (zero for no limit in that direction).
+	 */
+	FIntPoint GetSinkMaxDimensions() const;
+
+	/**
+	 * Convert a decoded sample to BGRA if color conversion is enabled.
+	 *
+	 * @param Sample The decoded sample.
+	 * @return The sample to pass to sinks.
+	 */
+	TRefCountPtr<FVlcMediaSample> ConvertSample(FVlcMediaSample& Sample);
+
+	/**
+	 * Check whether a decoded sample changed since the previous one (called from the display callback).
+	 *
+	 * In the DirtyRects mode, the changed regions are stored in the sample.
+	 *
+	 * @param Sample The decoded sample.
+	 * @return true if the sample should be passed to sinks, false if it is unchanged.
+	 */
+	bool DetectChanges(FVlcMediaSample& Sample);
+
 private:
 
+	/** Handles format setup callbacks from VLC. */
+	static uint32 HandleVideoSetup(void** Opaque, ANSICHAR* Chroma, uint32* Width, uint32* Height, uint32* Pitches, uint32* Lines);
+
+	/** Handles format cleanup callbacks from VLC. */
+	static void HandleVideoCleanup(void* Opaque);
+
+	/** Handles lock callbacks from VLC. */
 	static void* HandleVideoLock(void* Opaque, void** Planes);
+
+	/** Handles unlock callbacks from VLC. */
 	static void HandleVideoUnlock(void* Opaque, void* Picture, void* const* Planes);
+
+	/** Handles display callbacks from VLC. */
 	static void HandleVideoDisplay(void* Opaque, void* Picture);
 
 private:
 
-	/** The video's dimensions. */
+	/** Pool of color converted samples. */
+	TSharedPtr<FVlcMediaSamplePool, ESPMode::ThreadSafe> ConvertedPool;
+
+	/** Converts YUV frames to BGRA. */
+	FVlcMediaColorConverter ColorConverter;
+
+	/** Whether YUV frames are converted to BGRA. */
+	bool ConvertToBgra;
+
+	/** Pool of samples that libvlc decodes into. */
+	TSharedPtr<FVlcMediaSamplePool, ESPMode::ThreadSafe> DecodedPool;
+
+	/** The output chroma to use for the next format negotiation. */
+	EVlcMediaVideoChroma DesiredChroma;
+
+	/** Scratch buffer for the changed regions of a frame (only accessed by libvlc's video output thread). */
+	TArray<FIntRect> DirtyRects;
+
+	/** The dimensions of the decoded (and possibly scaled) video. */
 	FIntPoint Dimensions;
 
-	/** Buffer to write frame data to. */
-	TArray<uint8> FrameBuffer;
+	/** The largest output size requested by the sinks (zero for no limit). */
+	FIntPoint MaxDimensions;
+
+	/** The dimensions of the video before scaling. */
+	FIntPoint NativeDimensions;
+
+	/** Whether frames are paced on the game tick. */
+	bool FramePacing;
+
+	/** The frame rate of the video (zero if unknown, only accessed by libvlc's video output thread). */
+	float FrameRate;
 
 	/** Last delta time. */
 	FTimespan LastDelta;
 
+	/** Presentation time of the most recently displayed frame (only accessed by libvlc's video output thread). */
+	FTimespan LastSampleTime;
+
+	/** Memory layout of the frame buffers. */
+	FVlcMediaVideoLayout Layout;
+
+	/** Critical section for synchronizing access to the dimensions, layout, output chroma, pools, color conversion, static frame and pacing settings, and to the player from the output thread. */
+	mutable FCriticalSection LayoutCriticalSection;
+
+	/** Decoded pictures that wait to be displayed. */
+	FVlcMediaPendingPictures PendingPictures;
+
+	/** Holds samples until they are due (only used if frame pacing is enabled). */
+	FVlcMediaPresentationQueue PresentationQueue;
+
+	/** The previously delivered decoded sample (only accessed by libvlc's video output thread). */
+	TRefCountPtr<FVlcMediaSample> PreviousSample;
+
+	/** The mode for detecting frames that did not change. */
+	EVlcMediaStaticFrameMode StaticFrameMode;
+
+	/** Statistics of static frame detection. */
+	FVlcMediaStaticFrameStats StaticFrameStats;
+
 	/** The track's cached name. */
 	FString Name;
 
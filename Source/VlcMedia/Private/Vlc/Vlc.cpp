@@ -37,10 +37,13 @@ VLC_DEFINE(Retain);
 VLC_DEFINE(Errmsg);
 VLC_DEFINE(Clearerr);
 
+VLC_DEFINE(Clock);
+
 VLC_DEFINE(EventAttach);
 VLC_DEFINE(EventDetach);
 VLC_DEFINE(EventTypeName);
 
+VLC_DEFINE(MediaAddOption);
 VLC_DEFINE(MediaEventManager);
 VLC_DEFINE(MediaNewCallbacks);
 VLC_DEFINE(MediaNewLocation);
@@ -79,11 +82,15 @@ VLC_DEFINE(MediaPlayerWillPlay);
 
 VLC_DEFINE(AudioGetTrack);
 VLC_DEFINE(AudioSetTrack);
+VLC_DEFINE(AudioSetCallbacks);
+VLC_DEFINE(AudioSetFormat);
+VLC_DEFINE(AudioSetFormatCallbacks);
 
 VLC_DEFINE(VideoGetHeight);
 VLC_DEFINE(VideoGetWidth);
 VLC_DEFINE(VideoSetCallbacks);
 VLC_DEFINE(VideoSetFormat);
+VLC_DEFINE(VideoSetFormatCallbacks);
 VLC_DEFINE(VideoGetSpu);
 VLC_DEFINE(VideoSetSpu);
 VLC_DEFINE(VideoGetTrack);
@@ -148,10 +155,13 @@ bool FVlc::Initialize()
 	VLC_IMPORT(libvlc_errmsg, Errmsg);
 	VLC_IMPORT(libvlc_clearerr, Clearerr);
 
+	VLC_IMPORT(libvlc_clock, Clock);
+
 	VLC_IMPORT(libvlc_event_attach, EventAttach);
 	VLC_IMPORT(libvlc_event_detach, EventDetach);
 	VLC_IMPORT(libvlc_event_type_name, EventTypeName);
 
+	VLC_IMPORT(libvlc_media_add_option, MediaAddOption);
 	VLC_IMPORT(libvlc_media_event_manager, MediaEventManager);
 	VLC_IMPORT(libvlc_media_new_callbacks, MediaNewCallbacks);
 	VLC_IMPORT(libvlc_media_new_location, MediaNewLocation);
@@ -190,11 +200,15 @@ bool FVlc::Initialize()
 
 	VLC_IMPORT(libvlc_audio_get_track, AudioGetTrack);
 	VLC_IMPORT(libvlc_audio_set_track, AudioSetTrack);
+	VLC_IMPORT(libvlc_audio_set_callbacks, AudioSetCallbacks);
+	VLC_IMPORT(libvlc_audio_set_format, AudioSetFormat);
+	VLC_IMPORT(libvlc_audio_set_format_callbacks, AudioSetFormatCallbacks);
 
 	VLC_IMPORT(libvlc_video_get_height, VideoGetHeight);
 	VLC_IMPORT(libvlc_video_get_width, VideoGetWidth);
 	VLC_IMPORT(libvlc_video_set_callbacks, VideoSetCallbacks);
 	VLC_IMPORT(libvlc_video_set_format, VideoSetFormat);
+	VLC_IMPORT(libvlc_video_set_format_callbacks, VideoSetFormatCallbacks);
 	VLC_IMPORT(libvlc_video_get_spu, VideoGetSpu);
 	VLC_IMPORT(libvlc_video_set_spu, VideoSetSpu);
 	VLC_IMPORT(libvlc_video_get_track, VideoGetTrack);
@@ -23,10 +23,13 @@ public:
 	static FLibvlcErrmsgProc Errmsg;
 	static FLibvlcClearerrProc Clearerr;
 
+	static FLibvlcClockProc Clock;
+
 	static FLibvlcEventAttachProc EventAttach;
 	static FLibvlcEventAttachProc EventDetach;
 	static FLibvlcEventTypeNameProc EventTypeName;
 
+	static FLibvlcMediaAddOptionProc MediaAddOption;
 	static FLibvlcMediaEventManagerProc MediaEventManager;
 	static FLibvlcMediaNewCallbacksProc MediaNewCallbacks;
 	static FLibvlcMediaNewLocationProc MediaNewLocation;
@@ -65,11 +68,15 @@ public:
 
 	static FLibvlcAudioGetTrackProc AudioGetTrack;
 	static FLibvlcAudioSetTrackProc AudioSetTrack;
+	static FLibvlcAudioSetCallbacksProc AudioSetCallbacks;
+	static FLibvlcAudioSetFormatProc AudioSetFormat;
+	static FLibvlcAudioSetFormatCallbacksProc AudioSetFormatCallbacks;
 
 	static FLibvlcVideoGetHeightProc VideoGetHeight;
 	static FLibvlcVideoGetWidthProc VideoGetWidth;
 	static FLibvlcVideoSetCallbacksProc VideoSetCallbacks;
 	static FLibvlcVideoSetFormatProc VideoSetFormat;
+	static FLibvlcVideoSetFormatCallbacksProc VideoSetFormatCallbacks;
 	static FLibvlcVideoGetSpuProc VideoGetSpu;
 	static FLibvlcVideoSetSpuProc VideoSetSpu;
 	static FLibvlcVideoGetTrackProc VideoGetTrack;
@@ -14,6 +14,9 @@ typedef void (*FLibvlcRetainProc)(FLibvlcInstance* /*Instance*/);
 typedef const char* (*FLibvlcErrmsgProc)();
 typedef void (*FLibvlcClearerrProc)();
 
+// time
+typedef int64 (*FLibvlcClockProc)();
+
 // events
 typedef void (*FLibvlcCallback)(FLibvlcEvent* /*Event*/, void* /*UserData*/);
 typedef int (*FLibvlcEventAttachProc)(FLibvlcEventManager* /*EventManager*/, ELibvlcEventType /*EventType*/, FLibvlcCallback /*Callback*/, void* /*UserData*/);
@@ -39,6 +42,7 @@ typedef FLibvlcMedia* (*FLibvlcMediaNewCallbacksProc)(
 
 typedef FLibvlcMedia* (*FLibvlcMediaNewLocationProc)(FLibvlcInstance* /*Instance*/, const ANSICHAR* /*Location*/);
 typedef FLibvlcMedia* (*FLibvlcMediaNewPathProc)(FLibvlcInstance* /*Instance*/, const ANSICHAR* /*Path*/);
+typedef void (*FLibvlcMediaAddOptionProc)(FLibvlcMedia* /*Media*/, const ANSICHAR* /*Options*/);
 typedef void (*FLibvlcMediaParseAsyncProc)(FLibvlcMedia* /*Media*/);
 typedef void (*FLibvlcMediaReleaseProc)(FLibvlcMedia* /*Media*/);
 typedef void (*FLibvlcMediaRetainProc)(FLibvlcMedia* /*Media*/);
@@ -74,15 +78,50 @@ typedef void (*FLibvlcMediaPlayerSetPauseProc)(FLibvlcMediaPlayer* /*Player*/, i
 typedef void (*FLibvlcMediaPlayerStopProc)(FLibvlcMediaPlayer* /*Player*/);
 typedef int32 (*FLibvlcMediaPlayerWillPlayProc)(FLibvlcMediaPlayer* /*Player*/);
 
+// audio callbacks
+typedef void (*FLibvlcAudioPlayCb)(void* /*Opaque*/, const void* /*Samples*/, uint32 /*Count*/, int64 /*Pts*/);
+typedef void (*FLibvlcAudioPauseCb)(void* /*Opaque*/, int64 /*Pts*/);
+typedef void (*FLibvlcAudioResumeCb)(void* /*Opaque*/, int64 /*Pts*/);
+typedef void (*FLibvlcAudioFlushCb)(void* /*Opaque*/, int64 /*Pts*/);
+typedef void (*FLibvlcAudioDrainCb)(void* /*Opaque*/);
+
+// audio format callbacks
+typedef int (*FLibvlcAudioSetupCb)(void** /*Opaque*/, ANSICHAR* /*Format*/, uint32* /*Rate*/, uint32* /*Channels*/);
+typedef void (*FLibvlcAudioCleanupCb)(void* /*Opaque*/);
+
 // audio
 typedef int32 (*FLibvlcAudioGetTrackProc)(FLibvlcMediaPlayer* /*Player*/);
 typedef int32 (*FLibvlcAudioSetTrackProc)(FLibvlcMediaPlayer* /*Player*/, int32 /*TrackId*/);
 
+typedef void (*FLibvlcAudioSetCallbacksProc)(
+	FLibvlcMediaPlayer* /*Player*/,
+	FLibvlcAudioPlayCb /*Play*/,
+	FLibvlcAudioPauseCb /*Pause*/,
+	FLibvlcAudioResumeCb /*Resume*/,
+	FLibvlcAudioFlushCb /*Flush*/,
+	FLibvlcAudioDrainCb /*Drain*/,
+	void* /*Opaque*/);
+
+typedef void (*FLibvlcAudioSetFormatCallbacksProc)(
+	FLibvlcMediaPlayer* /*Player*/,
+	FLibvlcAudioSetupCb /*Setup*/,
+	FLibvlcAudioCleanupCb /*Cleanup*/);
+
+typedef void (*FLibvlcAudioSetFormatProc)(
+	FLibvlcMediaPlayer* /*Player*/,
+	const ANSICHAR* /*Format*/,
+	uint32 /*Rate*/,
+	uint32 /*Channels*/);
+
 // video callbacks
 typedef void* (*FLibvlcVideoLockCb)(void* /*Opaque*/, void** /*Planes*/);
 typedef void (*FlibvlcVideoUnlockCb)(void* /*Opaque*/, void* /*Picture*/, void* const* /*Planes*/);
 typedef void (*FlibvlcVideoDisplayCb)(void* /*Opaque*/, void* /*Picture*/);
 
+// video format callbacks
+typedef uint32 (*FLibvlcVideoFormatCb)(void** /*Opaque*/, ANSICHAR* /*Chroma*/, uint32* /*Width*/, uint32* /*Height*/, uint32* /*Pitches*/, uint32* /*Lines*/);
+typedef void (*FLibvlcVideoCleanupCb)(void* /*Opaque*/);
+
 // video
 typedef void (*FLibvlcVideoSetCallbacksProc)(
 	FLibvlcMediaPlayer* /*Player*/,
@@ -91,6 +130,11 @@ typedef void (*FLibvlcVideoSetCallbacksProc)(
 	FlibvlcVideoDisplayCb /*Display*/,
 	void* /*Opaque*/);
 
+typedef void (*FLibvlcVideoSetFormatCallbacksProc)(
+	FLibvlcMediaPlayer* /*Player*/,
+	FLibvlcVideoFormatCb /*Setup*/,
+	FLibvlcVideoCleanupCb /*Cleanup*/);
+
 typedef void (*FLibvlcVideoSetFormatProc)(
 	FLibvlcMediaPlayer* /*Player*/,
 	const ANSICHAR* /*Chroma*/,
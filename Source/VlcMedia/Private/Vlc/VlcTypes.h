@@ -118,10 +118,10 @@ enum class ELibvlcState
 /** Enumerates known track types. */
 enum class ELibvlcTrackType
 {
-	Unknown,
-	Audio,
-	Video,
-	Text
+	Unknown = -1,
+	Audio = 0,
+	Video = 1,
+	Text = 2
 };
 
 
@@ -283,6 +283,13 @@ struct FLibvlcEvent
         {
             FLibvlcMedia* NewMedia;
         } MediaPlayerMediaChanged;
+
+        // elementary streams
+        struct
+        {
+            ELibvlcTrackType Type;
+            int32 Id;
+        } MediaPlayerESChanged;
     } Descriptor;
 };
 
@@ -3,6 +3,7 @@
 #include "VlcMediaPrivatePCH.h"
 #include "IMediaModule.h"
 #include "IMediaPlayerFactory.h"
+#include "IVlcMediaModule.h"
 #include "ModuleInterface.h"
 #include "ModuleManager.h"
 
@@ -12,11 +13,15 @@ DEFINE_LOG_CATEGORY(LogVlcMedia);
 #define LOCTEXT_NAMESPACE "FVlcMediaModule"
 
 
+/** Number of libvlc media players that are created up front. */
+#define VLCMEDIA_PLAYER_POOL_SIZE 2
+
+
 /**
  * Implements the VlcMedia module.
  */
 class FVlcMediaModule
-	: public IModuleInterface
+	: public IVlcMediaModule
 	, public IMediaPlayerFactory
 {
 public:
@@ -54,8 +59,8 @@ public:
 		const ANSICHAR* Args[] =
 		{
 			TCHAR_TO_ANSI(*(FString(TEXT("--plugin-path=")) + FVlc::GetPluginDir())),
+			"--aout", "amem",
 			"--intf", "dummy",
-			"--no-audio",
 			"--no-disable-screensaver",
 			"--no-snapshot-preview",
 			"--no-stats",
@@ -77,6 +82,9 @@ public:
 			return;
 		}
 
+		PlayerPool = MakeShareable(new FVlcMediaPlayerPool(VlcInstance, VLCMEDIA_PLAYER_POOL_SIZE));
+		Scheduler = MakeShareable(new FVlcMediaScheduler(PlayerPool.ToSharedRef()));
+
 		// initialize supported media formats
 		SupportedFileTypes.Add(TEXT("3gp"), LOCTEXT("Format3gp", "3GP Video Stream"));
 		SupportedFileTypes.Add(TEXT("a52"), LOCTEXT("FormatA52", "Dolby Digital AC-3 Audio"));
@@ -146,6 +154,14 @@ public:
 			MediaModule->UnregisterPlayerFactory(*this);
 		}
 
+		Players.Empty();
+
+		// nothing may call into libvlc once its instance is released
+		Scheduler->Shutdown();
+		Scheduler.Reset();
+		PlayerPool->Shutdown();
+		PlayerPool.Reset();
+
 		// release LibVLC instance
 		FVlc::Release((FLibvlcInstance*)VlcInstance);
 		VlcInstance = nullptr;
@@ -165,7 +181,15 @@ public:
 			return nullptr;
 		}
 
-		return MakeShareable(new FVlcMediaPlayer(VlcInstance));
+		// forget players that no longer exist
+		Players.RemoveAll([](const TWeakPtr<FVlcMediaPlayer>& Player) {
+			return !Player.IsValid();
+		});
+
+		TSharedRef<FVlcMediaPlayer> NewPlayer = MakeShareable(new FVlcMediaPlayer(VlcInstance, Scheduler.ToSharedRef(), PlayerPool.ToSharedRef()));
+		Players.Add(NewPlayer);
+
+		return NewPlayer;
 	}
 
 	virtual const FMediaFileTypes& GetSupportedFileTypes() const override
@@ -193,11 +217,44 @@ public:
 		return false;
 	}
 
+public:
+
+	// IVlcMediaModule interface
+
+	virtual IVlcMediaStreamRef CreateStream(uint64 ExpectedSize, FTimespan ReadTimeout) const override
+	{
+		return MakeShareable(new FVlcMediaStream(ExpectedSize, ReadTimeout));
+	}
+
+	virtual IVlcMediaPlayerPtr GetVlcPlayer(const TSharedRef<IMediaPlayer>& MediaPlayer) const override
+	{
+		for (const TWeakPtr<FVlcMediaPlayer>& PlayerPtr : Players)
+		{
+			TSharedPtr<FVlcMediaPlayer> Player = PlayerPtr.Pin();
+
+			if (Player.IsValid() && (static_cast<IMediaPlayer*>(Player.Get()) == &MediaPlayer.Get()))
+			{
+				return Player;
+			}
+		}
+
+		return nullptr;
+	}
+
 private:
 
 	/** Whether the module has been initialized. */
 	bool Initialized;
 
+	/** The pool of pre-created libvlc players. */
+	TSharedPtr<FVlcMediaPlayerPool, ESPMode::ThreadSafe> PlayerPool;
+
+	/** The media players that were created by this module. */
+	TArray<TWeakPtr<FVlcMediaPlayer>> Players;
+
+	/** The scheduler that updates all media players. */
+	TSharedPtr<FVlcMediaScheduler, ESPMode::ThreadSafe> Scheduler;
+
 	/** The collection of supported media file types. */
 	FMediaFileTypes SupportedFileTypes;
 
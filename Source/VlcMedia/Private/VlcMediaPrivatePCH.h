@@ -15,6 +15,7 @@
 #include "IMediaTrackAudioDetails.h"
 #include "IMediaTrackCaptionDetails.h"
 #include "IMediaTrackVideoDetails.h"
+#include "IVlcMediaPlayer.h"
 
 
 /* Private macros
@@ -27,8 +28,26 @@ DECLARE_LOG_CATEGORY_EXTERN(LogVlcMedia, Log, All);
  *****************************************************************************/
 
 #include "Vlc.h"
+#include "VlcMediaAudioResampler.h"
+#include "VlcMediaColorConverter.h"
+#include "VlcMediaFrameDiff.h"
+#include "VlcMediaLoopDetector.h"
+#include "VlcMediaMappedFile.h"
+#include "VlcMediaPlayerClock.h"
+#include "VlcMediaPlayerState.h"
+#include "VlcMediaPrefetchReader.h"
+#include "VlcMediaSample.h"
+#include "VlcMediaSamplePool.h"
+#include "VlcMediaPendingPictures.h"
+#include "VlcMediaPresentationQueue.h"
+#include "VlcMediaRingBuffer.h"
+#include "VlcMediaSinkDispatcher.h"
+#include "VlcMediaSource.h"
+#include "VlcMediaStream.h"
 #include "VlcMediaTrack.h"
 #include "VlcMediaAudioTrack.h"
 #include "VlcMediaCaptionTrack.h"
 #include "VlcMediaVideoTrack.h"
+#include "VlcMediaPlayerPool.h"
+#include "VlcMediaScheduler.h"
 #include "VlcMediaPlayer.h"
@@ -0,0 +1,48 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#pragma once
+
+
+/**
+ * Interface for VLC specific audio track functionality.
+ */
+class IVlcMediaAudioTrack
+{
+public:
+
+	/**
+	 * Get the number of channels of the decoded audio stream.
+	 *
+	 * @return Number of channels (stereo until the stream was set up).
+	 * @see GetStreamSamplesPerSecond, SetOutputFormat
+	 */
+	virtual uint32 GetStreamNumChannels() const = 0;
+
+	/**
+	 * Get the sample rate of the decoded audio stream.
+	 *
+	 * @return Samples per second (44.1 kHz until the stream was set up).
+	 * @see GetStreamNumChannels, SetOutputFormat
+	 */
+	virtual uint32 GetStreamSamplesPerSecond() const = 0;
+
+	/**
+	 * Set the format of the audio that is passed to media sinks.
+	 *
+	 * Sinks always receive interleaved 16-bit PCM. By default, it has the sample rate and
+	 * channel count of the stream. If a different format is requested, i.e. to match the
+	 * engine's audio mixer, the plugin converts the sample rate and down-mixes channels
+	 * itself instead of using libvlc's filter chain. The output format is reported by
+	 * IMediaTrackAudioDetails.
+	 *
+	 * @param SamplesPerSecond The sample rate to output (zero to keep the stream's rate).
+	 * @param NumChannels The number of channels to output (zero to keep the stream's channels).
+	 * @see GetStreamNumChannels, GetStreamSamplesPerSecond
+	 */
+	virtual void SetOutputFormat(uint32 SamplesPerSecond, uint32 NumChannels) = 0;
+
+public:
+
+	/** Virtual destructor. */
+	virtual ~IVlcMediaAudioTrack() { }
+};
@@ -0,0 +1,41 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#pragma once
+
+#include "IMediaPlayer.h"
+#include "IVlcMediaPlayer.h"
+#include "IVlcMediaStream.h"
+#include "ModuleInterface.h"
+
+
+/**
+ * Interface for the VlcMedia module.
+ */
+class IVlcMediaModule
+	: public IModuleInterface
+{
+public:
+
+	/**
+	 * Create a stream for media data that is appended while it is being played.
+	 *
+	 * @param ExpectedSize The expected size of the media (in bytes), or zero if unknown.
+	 * @param ReadTimeout How long playback waits for data to be appended before it fails.
+	 * @return The stream.
+	 * @see IVlcMediaPlayer::OpenStream
+	 */
+	virtual IVlcMediaStreamRef CreateStream(uint64 ExpectedSize, FTimespan ReadTimeout) const = 0;
+
+	/**
+	 * Get the VLC specific interface of a media player.
+	 *
+	 * @param MediaPlayer A media player that was created by this module's player factory.
+	 * @return The VLC media player, or nullptr if the player was not created by this module.
+	 */
+	virtual IVlcMediaPlayerPtr GetVlcPlayer(const TSharedRef<IMediaPlayer>& MediaPlayer) const = 0;
+
+public:
+
+	/** Virtual destructor. */
+	virtual ~IVlcMediaModule() { }
+};
@@ -0,0 +1,153 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#pragma once
+
+#include "IVlcMediaAudioTrack.h"
+#include "IVlcMediaStream.h"
+#include "IVlcMediaVideoTrack.h"
+#include "VlcMediaTypes.h"
+
+
+/**
+ * Interface for VLC specific media player functionality.
+ *
+ * Use IVlcMediaModule::GetVlcPlayer to access this interface for a media player.
+ */
+class IVlcMediaPlayer
+{
+public:
+
+	/**
+	 * Get the VLC specific interface of an audio track.
+	 *
+	 * @param TrackIndex The index of the track (see IMediaTrack::GetIndex).
+	 * @return The audio track, or nullptr if the track does not exist or is not an audio track.
+	 */
+	virtual IVlcMediaAudioTrack* GetAudioTrack(uint32 TrackIndex) = 0;
+
+	/**
+	 * Get statistics of looping playback of the current media.
+	 *
+	 * @return Statistics.
+	 * @see IMediaPlayer::SetLooping
+	 */
+	virtual FVlcMediaLoopStats GetLoopStats() const = 0;
+
+	/**
+	 * Get statistics of opening the current media.
+	 *
+	 * @return Statistics.
+	 */
+	virtual FVlcMediaOpenStats GetOpenStats() const = 0;
+
+	/**
+	 * Get statistics of reading the current media through the read-ahead cache.
+	 *
+	 * @return Statistics (all zero if the media is not read through the cache).
+	 * @see SetPrefetchOptions
+	 */
+	virtual FVlcMediaPrefetchStats GetPrefetchStats() const = 0;
+
+	/**
+	 * Get the player's lifecycle status.
+	 *
+	 * Changes of the status are also reported through StatusChanged player events.
+	 *
+	 * @return Status.
+	 * @see OnPlayerEvents
+	 */
+	virtual EVlcMediaPlayerStatus GetStatus() const = 0;
+
+	/**
+	 * Get the VLC specific interface of a video track.
+	 *
+	 * @param TrackIndex The index of the track (see IMediaTrack::GetIndex).
+	 * @return The video track, or nullptr if the track does not exist or is not a video track.
+	 */
+	virtual IVlcMediaVideoTrack* GetVideoTrack(uint32 TrackIndex) = 0;
+
+public:
+
+	/**
+	 * Discard the media that was queued to play next.
+	 *
+	 * @see QueueNext
+	 */
+	virtual void ClearQueue() = 0;
+
+	/**
+	 * Open media that is appended while it is being played.
+	 *
+	 * Playback can start as soon as the stream holds enough data for libvlc to detect the
+	 * format. If playback catches up with the appended data, it waits for more data for up
+	 * to the stream's read timeout and fails afterwards.
+	 *
+	 * @param Stream The stream to play (must be created with IVlcMediaModule::CreateStream).
+	 * @param OriginalUrl The URL of the media that the stream is loaded from.
+	 * @return true if the media is being opened, false otherwise.
+	 * @see IMediaPlayer::Open
+	 */
+	virtual bool OpenStream(const IVlcMediaStreamRef& Stream, const FString& OriginalUrl) = 0;
+
+	/**
+	 * Queue media to play when the current media ends.
+	 *
+	 * The media is opened on a second libvlc player right away and held at its start, so
+	 * that its input is connected and buffered by the time it is needed. When the current
+	 * media ends, the existing tracks move to the new media and keep their sinks, and the
+	 * player sends a QueueAdvanced event instead of the closed and opened notifications.
+	 * Looping media advances once looping is disabled. Queuing replaces any media that
+	 * was queued before. If no media is open, the media is opened right away.
+	 *
+	 * @param Url The URL of the media to play next.
+	 * @return true if the media was queued, false otherwise.
+	 * @see ClearQueue
+	 */
+	virtual bool QueueNext(const FString& Url) = 0;
+
+	/**
+	 * Queue in-memory media to play when the current media ends.
+	 *
+	 * @param Buffer The buffer holding the media data.
+	 * @param OriginalUrl The URL of the media that the buffer was loaded from.
+	 * @return true if the media was queued, false otherwise.
+	 * @see ClearQueue
+	 */
+	virtual bool QueueNext(const TSharedRef<TArray<uint8>, ESPMode::ThreadSafe>& Buffer, const FString& OriginalUrl) = 0;
+
+	/**
+	 * Set how media from slow backing stores is read ahead.
+	 *
+	 * Local files are opened by libvlc itself until this is called. Afterwards they are mapped
+	 * into memory and read through a read-ahead cache, which is filled on a worker thread, so
+	 * that libvlc's input thread does not stall on slow drives or network shares. Files that
+	 * can only be read through the engine's file system, such as the ones in pak files, are
+	 * streamed in blocks and always use the cache, with the default options if it is disabled.
+	 * The options apply to media that is opened or queued afterwards.
+	 *
+	 * @param Options The cache options (a block size of zero disables the cache).
+	 * @see GetPrefetchStats
+	 */
+	virtual void SetPrefetchOptions(const FVlcMediaPrefetchOptions& Options) = 0;
+
+public:
+
+	/**
+	 * Gets an event delegate that is invoked once per game tick with the player events that arrived since the last tick.
+	 *
+	 * Bursts of buffering, length, position and time events are collapsed into their latest value.
+	 *
+	 * @return The delegate.
+	 */
+	DECLARE_EVENT_OneParam(IVlcMediaPlayer, FOnPlayerEvents, const TArray<FVlcMediaPlayerEvent>& /*Events*/)
+	virtual FOnPlayerEvents& OnPlayerEvents() = 0;
+
+public:
+
+	/** Virtual destructor. */
+	virtual ~IVlcMediaPlayer() { }
+};
+
+
+/** Type definition for shared pointers to instances of IVlcMediaPlayer. */
+typedef TSharedPtr<IVlcMediaPlayer> IVlcMediaPlayerPtr;
@@ -0,0 +1,90 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#pragma once
+
+#include "VlcMediaTypes.h"
+
+
+/**
+ * Interface for reference counted media samples.
+ *
+ * Samples are handed to sinks without copying. A sink may hold on to a sample for as long
+ * as it needs its data; the underlying buffer is returned to its pool once the last
+ * reference is released. Sample data must be treated as read-only.
+ */
+class IVlcMediaSample
+{
+public:
+
+	/**
+	 * Add a reference to this sample.
+	 *
+	 * @return The new reference count.
+	 * @see Release
+	 */
+	virtual uint32 AddRef() const = 0;
+
+	/**
+	 * Get the sample data.
+	 *
+	 * @return The sample buffer.
+	 * @see GetSize
+	 */
+	virtual const uint8* GetData() const = 0;
+
+	/**
+	 * Get the regions of a video sample that changed since the previous sample.
+	 *
+	 * The regions are relative to the previous sample delivered by the same track, so
+	 * sinks that skip samples must treat the whole frame as changed instead.
+	 *
+	 * @return Changed regions (in pixels), or an empty array if the entire frame changed.
+	 */
+	virtual const TArray<FIntRect>& GetDirtyRects() const = 0;
+
+	/**
+	 * Get the sample's duration.
+	 *
+	 * @return Duration.
+	 */
+	virtual FTimespan GetDuration() const = 0;
+
+	/**
+	 * Get the memory layout of the sample data (video samples only).
+	 *
+	 * @return The video layout.
+	 */
+	virtual const FVlcMediaVideoLayout& GetLayout() const = 0;
+
+	/**
+	 * Get the size of the sample data.
+	 *
+	 * @return Number of bytes.
+	 * @see GetData
+	 */
+	virtual uint32 GetSize() const = 0;
+
+	/**
+	 * Get the play time of the sample.
+	 *
+	 * @return Play time.
+	 */
+	virtual FTimespan GetTime() const = 0;
+
+	/**
+	 * Release a reference to this sample.
+	 *
+	 * @return The new reference count.
+	 * @see AddRef
+	 */
+	virtual uint32 Release() const = 0;
+
+protected:
+
+	/** Hidden destructor (samples are destroyed by releasing all references). */
+	virtual ~IVlcMediaSample() { }
+};
+
+
+/** Type definition for reference counted pointers to media samples. */
+typedef TRefCountPtr<const IVlcMediaSample> IVlcMediaSampleRef;
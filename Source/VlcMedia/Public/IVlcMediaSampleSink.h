@@ -0,0 +1,41 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#pragma once
+
+#include "IVlcMediaSample.h"
+
+
+/**
+ * Interface for sinks that receive reference counted media samples.
+ *
+ * Unlike IMediaSink, which receives a raw pointer that is only valid for the duration
+ * of the call, these sinks may keep the sample without copying its data.
+ */
+class IVlcMediaSampleSink
+{
+public:
+
+	/**
+	 * Process a media sample.
+	 *
+	 * This method is called from the decoder thread and should return quickly.
+	 *
+	 * @param Sample The sample to process.
+	 */
+	virtual void ProcessMediaSample(const IVlcMediaSampleRef& Sample) = 0;
+
+public:
+
+	/** Virtual destructor. */
+	virtual ~IVlcMediaSampleSink() { }
+};
+
+
+/** Type definition for shared pointers to instances of IVlcMediaSampleSink. */
+typedef TSharedPtr<IVlcMediaSampleSink, ESPMode::ThreadSafe> IVlcMediaSampleSinkPtr;
+
+/** Type definition for shared references to instances of IVlcMediaSampleSink. */
+typedef TSharedRef<IVlcMediaSampleSink, ESPMode::ThreadSafe> IVlcMediaSampleSinkRef;
+
+/** Type definition for weak pointers to instances of IVlcMediaSampleSink. */
+typedef TWeakPtr<IVlcMediaSampleSink, ESPMode::ThreadSafe> IVlcMediaSampleSinkWeakPtr;
@@ -0,0 +1,66 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#pragma once
+
+
+/**
+ * Interface for media data that is appended while it is being played.
+ *
+ * Streams allow playback to start before the media is fully downloaded or decrypted.
+ * The producer appends the data in order from any thread and calls Finish after the
+ * last chunk. Reads that get ahead of the appended data wait for it, up to the stream's
+ * read timeout, and so do reads after a seek past the appended data.
+ *
+ * Use IVlcMediaModule::CreateStream to create streams, and IVlcMediaPlayer::OpenStream
+ * to play them.
+ */
+class IVlcMediaStream
+{
+public:
+
+	/**
+	 * Append media data (called on any thread).
+	 *
+	 * @param Data The data to append.
+	 * @param Size The number of bytes to append.
+	 * @return true on success, false if the stream is finished or too large.
+	 * @see Finish
+	 */
+	virtual bool Append(const void* Data, uint32 Size) = 0;
+
+	/**
+	 * Mark the end of the media data (called on any thread).
+	 *
+	 * Reads past the appended data report the end of the media from now on.
+	 *
+	 * @see Append
+	 */
+	virtual void Finish() = 0;
+
+	/**
+	 * Get the number of bytes that were appended so far.
+	 *
+	 * @return Number of bytes.
+	 */
+	virtual uint64 GetNumAppended() const = 0;
+
+	/**
+	 * Check whether all media data was appended.
+	 *
+	 * @return true if the stream is finished, false otherwise.
+	 * @see Finish
+	 */
+	virtual bool IsFinished() const = 0;
+
+public:
+
+	/** Virtual destructor. */
+	virtual ~IVlcMediaStream() { }
+};
+
+
+/** Type definition for shared pointers to instances of IVlcMediaStream. */
+typedef TSharedPtr<IVlcMediaStream, ESPMode::ThreadSafe> IVlcMediaStreamPtr;
+
+/** Type definition for shared references to instances of IVlcMediaStream. */
+typedef TSharedRef<IVlcMediaStream, ESPMode::ThreadSafe> IVlcMediaStreamRef;
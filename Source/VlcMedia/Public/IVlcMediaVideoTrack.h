@@ -0,0 +1,195 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#pragma once
+
+#include "IMediaSink.h"
+#include "IVlcMediaSampleSink.h"
+
+
+/**
+ * Interface for VLC specific video track functionality.
+ */
+class IVlcMediaVideoTrack
+{
+public:
+
+	/**
+	 * Add a sink that receives reference counted video samples.
+	 *
+	 * Each sink has its own queue and delivery thread, so a slow sink does not stall
+	 * the decoder or other sinks. Adding a sink again replaces its options.
+	 *
+	 * @param Sink The sink to add.
+	 * @param Options The delivery options.
+	 * @see GetSinkStats, RemoveSampleSink
+	 */
+	virtual void AddSampleSink(const IVlcMediaSampleSinkRef& Sink, const FVlcMediaSinkOptions& Options = FVlcMediaSinkOptions()) = 0;
+
+	/**
+	 * Get the statistics of frame pacing.
+	 *
+	 * @return Pacing statistics.
+	 * @see IsFramePacingEnabled, SetFramePacing
+	 */
+	virtual FVlcMediaFramePacingStats GetFramePacingStats() const = 0;
+
+	/**
+	 * Get the pixel format that video is decoded to.
+	 *
+	 * @return The output chroma.
+	 * @see SetOutputChroma
+	 */
+	virtual EVlcMediaVideoChroma GetOutputChroma() const = 0;
+
+	/**
+	 * Get the memory layout of the samples that are passed to media sinks.
+	 *
+	 * @return The sample layout.
+	 */
+	virtual FVlcMediaVideoLayout GetSampleLayout() const = 0;
+
+	/**
+	 * Get the statistics of the sample pools.
+	 *
+	 * Pools are recreated when the video format changes, which resets their statistics.
+	 *
+	 * @param OutDecoded Will contain the statistics of the pool that libvlc decodes into.
+	 * @param OutConverted Will contain the statistics of the pool for color converted samples.
+	 */
+	virtual void GetSamplePoolStats(FVlcMediaSamplePoolStats& OutDecoded, FVlcMediaSamplePoolStats& OutConverted) const = 0;
+
+	/**
+	 * Get the delivery statistics of a media sink.
+	 *
+	 * @param Sink The sink (must have been added with IMediaTrack::AddSink).
+	 * @param OutStats Will contain the statistics.
+	 * @return true on success, false if the sink is not registered.
+	 * @see SetSinkOptions
+	 */
+	virtual bool GetSinkStats(const IMediaSinkRef& Sink, FVlcMediaSinkStats& OutStats) const = 0;
+
+	/**
+	 * Get the delivery statistics of a sample sink.
+	 *
+	 * @param Sink The sink (must have been added with AddSampleSink).
+	 * @param OutStats Will contain the statistics.
+	 * @return true on success, false if the sink is not registered.
+	 * @see AddSampleSink
+	 */
+	virtual bool GetSinkStats(const IVlcMediaSampleSinkRef& Sink, FVlcMediaSinkStats& OutStats) const = 0;
+
+	/**
+	 * Get the mode for detecting frames that did not change.
+	 *
+	 * @return The detection mode.
+	 * @see GetStaticFrameStats, SetStaticFrameMode
+	 */
+	virtual EVlcMediaStaticFrameMode GetStaticFrameMode() const = 0;
+
+	/**
+	 * Get the statistics of static frame detection.
+	 *
+	 * @return Detection statistics.
+	 * @see GetStaticFrameMode, SetStaticFrameMode
+	 */
+	virtual FVlcMediaStaticFrameStats GetStaticFrameStats() const = 0;
+
+	/**
+	 * Check whether YUV video is converted to BGRA before it is passed to media sinks.
+	 *
+	 * @return true if color conversion is enabled, false otherwise.
+	 * @see SetColorConversion
+	 */
+	virtual bool IsColorConversionEnabled() const = 0;
+
+	/**
+	 * Check whether frames are paced on the game tick.
+	 *
+	 * @return true if frame pacing is enabled, false otherwise.
+	 * @see GetFramePacingStats, SetFramePacing
+	 */
+	virtual bool IsFramePacingEnabled() const = 0;
+
+	/**
+	 * Remove a sink that receives reference counted video samples.
+	 *
+	 * @param Sink The sink to remove.
+	 * @see AddSampleSink
+	 */
+	virtual void RemoveSampleSink(const IVlcMediaSampleSinkRef& Sink) = 0;
+
+	/**
+	 * Enable or disable conversion of YUV video to BGRA.
+	 *
+	 * When enabled, video decoded to a YUV chroma is converted on the decoder thread using
+	 * the fastest instruction set available on the CPU, and sinks receive BGRA samples.
+	 * This is usually faster than letting libvlc convert to RV32. It has no effect when
+	 * the output chroma is already RV32.
+	 *
+	 * @param Enabled Whether to convert to BGRA.
+	 * @param Matrix The color matrix of the video.
+	 * @param Range The value range of the video.
+	 * @see GetSampleLayout, IsColorConversionEnabled, SetOutputChroma
+	 */
+	virtual void SetColorConversion(bool Enabled, EVlcMediaColorMatrix Matrix, EVlcMediaColorRange Range) = 0;
+
+	/**
+	 * Enable or disable frame pacing on the game tick.
+	 *
+	 * By default, samples are passed to sinks as soon as libvlc displays them, which is
+	 * unrelated to the engine's frame rate and causes judder at many frame rate and
+	 * refresh rate combinations. When pacing is enabled, samples are held in a small
+	 * queue ordered by presentation time, and each game tick releases the newest sample
+	 * that is due. Samples that were overtaken are dropped before they reach any sink.
+	 *
+	 * Samples are then queued to sinks on the game thread, so sinks should not use the
+	 * Block overflow policy while pacing is enabled.
+	 *
+	 * @param Enabled Whether to pace frames.
+	 * @see GetFramePacingStats, IsFramePacingEnabled
+	 */
+	virtual void SetFramePacing(bool Enabled) = 0;
+
+	/**
+	 * Set the pixel format that video is decoded to.
+	 *
+	 * The new chroma takes effect the next time libvlc sets up the video output.
+	 *
+	 * @param Chroma The chroma to set.
+	 * @return true on success, false otherwise.
+	 * @see GetOutputChroma
+	 */
+	virtual bool SetOutputChroma(EVlcMediaVideoChroma Chroma) = 0;
+
+	/**
+	 * Set the delivery options of a media sink.
+	 *
+	 * Sinks added with IMediaTrack::AddSink use the default options. Changing
+	 * the options discards samples that are waiting for delivery and resets the statistics.
+	 *
+	 * @param Sink The sink (must have been added with IMediaTrack::AddSink).
+	 * @param Options The options to set.
+	 * @return true on success, false if the sink is not registered.
+	 * @see GetSinkStats
+	 */
+	virtual bool SetSinkOptions(const IMediaSinkRef& Sink, const FVlcMediaSinkOptions& Options) = 0;
+
+	/**
+	 * Set the mode for detecting frames that did not change.
+	 *
+	 * Slides, menus and other mostly static content often produce many identical frames.
+	 * When detection is enabled, each decoded frame is compared with the previous one in
+	 * tiles of 64x64 pixels, and frames without changes are not passed to sinks. In the
+	 * DirtyRects mode, samples that changed only partially also carry the changed regions,
+	 * so that sinks can limit texture updates to them (see IVlcMediaSample::GetDirtyRects).
+	 *
+	 * @param Mode The detection mode to set.
+	 * @see GetStaticFrameMode, GetStaticFrameStats
+	 */
+	virtual void SetStaticFrameMode(EVlcMediaStaticFrameMode Mode) = 0;
+
+public:
+
+	/** Virtual destructor. */
+	virtual ~IVlcMediaVideoTrack() { }
+};
@@ -0,0 +1,551 @@
+// Copyright 2015 Headcrash Industries LLC. All Rights Reserved.
+
+#pragma once
+
+#include "IMediaTrack.h"
+
+
+/** Maximum number of planes in a video sample. */
+#define VLCMEDIA_MAX_VIDEO_PLANES 3
+
+
+/**
+ * Enumerates pixel formats that video can be decoded to.
+ */
+enum class EVlcMediaVideoChroma : uint8
+{
+	/** 32-bit BGRA, converted by libvlc. */
+	Rv32,
+
+	/** 8-bit planar YUV 4:2:0 (Y, U and V planes). */
+	I420,
+
+	/** 8-bit semi-planar YUV 4:2:0 (Y plane and interleaved UV plane). */
+	Nv12
+};
+
+
+/**
+ * Enumerates color matrices used to convert YUV video to RGB.
+ */
+enum class EVlcMediaColorMatrix : uint8
+{
+	/** ITU-R BT.601 (standard definition video). */
+	Bt601,
+
+	/** ITU-R BT.709 (high definition video). */
+	Bt709
+};
+
+
+/**
+ * Enumerates value ranges of YUV video.
+ */
+enum class EVlcMediaColorRange : uint8
+{
+	/** Luma in [16, 235] and chroma in [16, 240] (studio swing). */
+	Limited,
+
+	/** Luma and chroma in [0, 255] (full swing). */
+	Full
+};
+
+
+/**
+ * Describes a single plane of a video sample.
+ */
+struct FVlcMediaVideoPlane
+{
+	/** Offset of the plane from the start of the sample buffer (in bytes). */
+	uint32 Offset;
+
+	/** Distance between the starts of two rows (in bytes). */
+	uint32 Pitch;
+
+	/** Number of rows that contain pixel data. */
+	uint32 Lines;
+};
+
+
+/**
+ * Describes the memory layout of video samples.
+ */
+struct FVlcMediaVideoLayout
+{
+	/** The pixel format. */
+	EVlcMediaVideoChroma Chroma;
+
+	/** The visible width and height of the video (in pixels). */
+	FIntPoint Dimensions;
+
+	/** The number of planes in use. */
+	int32 NumPlanes;
+
+	/** The planes (only the first NumPlanes entries are valid). */
+	FVlcMediaVideoPlane Planes[VLCMEDIA_MAX_VIDEO_PLANES];
+
+	/** Total size of a sample buffer (in bytes). */
+	uint32 BufferSize;
+
+public:
+
+	/** Default constructor. */
+	FVlcMediaVideoLayout()
+		: Chroma(EVlcMediaVideoChroma::Rv32)
+		, Dimensions(ForceInitToZero)
+		, NumPlanes(0)
+		, BufferSize(0)
+	{
+		FMemory::Memzero(Planes);
+	}
+};
+
+
+/**
+ * Statistics of a media sample pool.
+ */
+struct FVlcMediaSamplePoolStats
+{
+	/** Size of each pooled buffer (in bytes). */
+	uint32 BufferSize;
+
+	/** Number of buffers in the pool. */
+	int32 Capacity;
+
+	/** Highest number of samples that were in use at the same time. */
+	int32 HighWaterMark;
+
+	/** Number of samples that were served from the pool. */
+	uint64 NumHits;
+
+	/** Number of samples that had to be allocated from the heap because the pool was exhausted. */
+	uint64 NumMisses;
+
+	/** Number of samples currently in use. */
+	int32 NumUsed;
+
+public:
+
+	/** Default constructor. */
+	FVlcMediaSamplePoolStats()
+		: BufferSize(0)
+		, Capacity(0)
+		, HighWaterMark(0)
+		, NumHits(0)
+		, NumMisses(0)
+		, NumUsed(0)
+	{ }
+};
+
+
+/**
+ * Enumerates policies for sink queues that are full.
+ */
+enum class EVlcMediaSinkOverflowPolicy : uint8
+{
+	/** Discard the oldest queued sample to make room for the new one. */
+	DropOldest,
+
+	/** Discard the new sample. */
+	DropNewest,
+
+	/** Block the decoder until the sink caught up. */
+	Block
+};
+
+
+/**
+ * Options for delivering samples to a media sink.
+ */
+struct FVlcMediaSinkOptions
+{
+	/**
+	 * Largest video resolution that the sink needs (zero for no limit in that direction).
+	 *
+	 * Video is decoded to the smallest size that satisfies all sinks of a track, preserving
+	 * the aspect ratio, which reduces memory bandwidth and conversion cost.
+	 */
+	FIntPoint MaxDimensions;
+
+	/** What to do when the sink's queue is full. */
+	EVlcMediaSinkOverflowPolicy OverflowPolicy;
+
+	/** Maximum number of samples waiting for delivery (rounded up to a power of two). */
+	uint32 QueueCapacity;
+
+public:
+
+	/** Default constructor. */
+	FVlcMediaSinkOptions()
+		: MaxDimensions(ForceInitToZero)
+		, OverflowPolicy(EVlcMediaSinkOverflowPolicy::DropOldest)
+		, QueueCapacity(4)
+	{ }
+};
+
+
+/**
+ * Statistics of sample delivery to a media sink.
+ */
+struct FVlcMediaSinkStats
+{
+	/** Average time between queuing and delivering a sample (in seconds). */
+	double AverageLatency;
+
+	/** Time between queuing and delivering the most recent sample (in seconds). */
+	double LastLatency;
+
+	/** Longest time between queuing and delivering a sample (in seconds). */
+	double MaxLatency;
+
+	/** Number of samples that were delivered to the sink. */
+	uint64 NumDelivered;
+
+	/** Number of samples that were dropped because the queue was full. */
+	uint64 NumDropped;
+
+	/** Number of samples that were added to the queue. */
+	uint64 NumQueued;
+
+	/** Number of samples currently waiting for delivery. */
+	int32 QueueLength;
+
+public:
+
+	/** Default constructor. */
+	FVlcMediaSinkStats()
+		: AverageLatency(0.0)
+		, LastLatency(0.0)
+		, MaxLatency(0.0)
+		, NumDelivered(0)
+		, NumDropped(0)
+		, NumQueued(0)
+		, QueueLength(0)
+	{ }
+};
+
+
+/**
+ * Enumerates modes for detecting video frames that did not change.
+ */
+enum class EVlcMediaStaticFrameMode : uint8
+{
+	/** Deliver every frame. */
+	Disabled,
+
+	/** Do not deliver frames that are identical to the previous frame. */
+	Suppress,
+
+	/** Like Suppress, and annotate frames that changed partially with dirty rectangles. */
+	DirtyRects
+};
+
+
+/**
+ * Statistics of static frame detection.
+ */
+struct FVlcMediaStaticFrameStats
+{
+	/** Number of bytes that sinks did not have to process (suppressed frames and clean tiles). */
+	uint64 NumBytesSaved;
+
+	/** Number of frames that were compared with their predecessor. */
+	uint64 NumFramesChecked;
+
+	/** Number of frames that were delivered with dirty rectangles. */
+	uint64 NumFramesPartial;
+
+	/** Number of frames that were not delivered because they did not change. */
+	uint64 NumFramesSuppressed;
+
+public:
+
+	/** Default constructor. */
+	FVlcMediaStaticFrameStats()
+		: NumBytesSaved(0)
+		, NumFramesChecked(0)
+		, NumFramesPartial(0)
+		, NumFramesSuppressed(0)
+	{ }
+};
+
+
+/**
+ * Statistics of video frame pacing.
+ */
+struct FVlcMediaFramePacingStats
+{
+	/** Number of frames that were discarded without being presented. */
+	uint64 NumDropped;
+
+	/** Number of frames that arrived before their presentation time and were held back. */
+	uint64 NumEarly;
+
+	/** Number of frames that were presented after their presentation time had passed. */
+	uint64 NumLate;
+
+	/** Number of frames that were presented. */
+	uint64 NumPresented;
+
+	/** Number of ticks in which the previous frame had to be shown again, because no new frame was available. */
+	uint64 NumRepeated;
+
+public:
+
+	/** Default constructor. */
+	FVlcMediaFramePacingStats()
+		: NumDropped(0)
+		, NumEarly(0)
+		, NumLate(0)
+		, NumPresented(0)
+		, NumRepeated(0)
+	{ }
+};
+
+
+/**
+ * Enumerates the lifecycle states of a media player.
+ */
+enum class EVlcMediaPlayerStatus : uint8
+{
+	/** No media is open, and no libvlc player is being torn down. */
+	Closed,
+
+	/** The media was closed, and its libvlc player is still being torn down in the background. */
+	Closing,
+
+	/** The media is being opened. */
+	Opening,
+
+	/** The media is being buffered. */
+	Buffering,
+
+	/** The media is ready for playback. */
+	Ready,
+
+	/** Opening or playing the media failed. */
+	Error
+};
+
+
+/**
+ * Enumerates media player events.
+ */
+enum class EVlcMediaPlayerEventType : uint8
+{
+	/** The player is buffering (see FVlcMediaPlayerEvent::Buffering). */
+	Buffering,
+
+	/** Playback reached the end of the media. */
+	EndReached,
+
+	/** Playback failed. */
+	Error,
+
+	/** The duration of the media changed (see FVlcMediaPlayerEvent::Length). */
+	LengthChanged,
+
+	/** Looping playback wrapped around to the start of the media. */
+	Looped,
+
+	/** The media is being opened. */
+	Opening,
+
+	/** The media finished parsing. */
+	Parsed,
+
+	/** Playback was paused. */
+	Paused,
+
+	/** Playback started or resumed. */
+	Playing,
+
+	/** The playback position changed (see FVlcMediaPlayerEvent::Position). */
+	PositionChanged,
+
+	/** Playback advanced to the media that was queued with IVlcMediaPlayer::QueueNext. */
+	QueueAdvanced,
+
+	/** The media became seekable or stopped being seekable (see FVlcMediaPlayerEvent::Seekable). */
+	SeekableChanged,
+
+	/** The player's lifecycle status changed (see FVlcMediaPlayerEvent::Status). */
+	StatusChanged,
+
+	/** Playback was stopped. */
+	Stopped,
+
+	/** The playback time changed (see FVlcMediaPlayerEvent::Time). */
+	TimeChanged,
+
+	/** A track was added to the media (see FVlcMediaPlayerEvent::Track). */
+	TrackAdded,
+
+	/** A track was removed from the media (see FVlcMediaPlayerEvent::Track). */
+	TrackRemoved,
+
+	/** A track was selected (see FVlcMediaPlayerEvent::Track). */
+	TrackSelected
+};
+
+
+/**
+ * Identifies the elementary stream of a track event.
+ */
+struct FVlcMediaPlayerEventTrack
+{
+	/** The type of the track. */
+	EMediaTrackTypes Type;
+
+	/** The libvlc identifier of the track's stream (-1 if a track was deselected). */
+	int32 Id;
+};
+
+
+/**
+ * Describes a media player event.
+ *
+ * Events are plain data, so that they can be recorded on libvlc's threads without
+ * allocating memory. Only the payload member that belongs to the event type is valid.
+ */
+struct FVlcMediaPlayerEvent
+{
+	/** The type of event. */
+	EVlcMediaPlayerEventType Type;
+
+	union
+	{
+		/** The amount of data that was buffered (in percent). */
+		float Buffering;
+
+		/** The new duration of the media (in ticks). */
+		int64 Length;
+
+		/** The new playback position (from 0 to 1). */
+		float Position;
+
+		/** Whether the media is seekable. */
+		bool Seekable;
+
+		/** The new lifecycle status. */
+		EVlcMediaPlayerStatus Status;
+
+		/** The new playback time (in ticks). */
+		int64 Time;
+
+		/** The track that was added, removed or selected. */
+		FVlcMediaPlayerEventTrack Track;
+	};
+};
+
+
+/**
+ * Statistics of opening media.
+ */
+struct FVlcMediaOpenStats
+{
+	/** Time that was spent in the Open call (in seconds). */
+	double OpenDuration;
+
+	/** Time from the Open call until the first video frame was delivered (in seconds, negative if none was delivered yet). */
+	double TimeToFirstFrame;
+
+	/** Whether a pre-created player was taken from the pool. */
+	bool UsedPooledPlayer;
+
+public:
+
+	/** Default constructor. */
+	FVlcMediaOpenStats()
+		: OpenDuration(0.0)
+		, TimeToFirstFrame(-1.0)
+		, UsedPooledPlayer(false)
+	{ }
+};
+
+
+/**
+ * Statistics of looping playback.
+ */
+struct FVlcMediaLoopStats
+{
+	/** Time that playback stalled in the latest loop transition (in seconds). */
+	double LastTransitionLatency;
+
+	/** Longest time that playback stalled in a loop transition (in seconds). */
+	double MaxTransitionLatency;
+
+	/** Number of times that playback wrapped around. */
+	uint32 NumLoops;
+
+public:
+
+	/** Default constructor. */
+	FVlcMediaLoopStats()
+		: LastTransitionLatency(0.0)
+		, MaxTransitionLatency(0.0)
+		, NumLoops(0)
+	{ }
+};
+
+
+/**
+ * Options for reading media through the read-ahead cache.
+ */
+struct FVlcMediaPrefetchOptions
+{
+	/** Size of each cached block (in bytes, zero to read without the cache). */
+	uint32 BlockSize;
+
+	/** Number of cached blocks, which is also how far the cache reads ahead during sequential access. */
+	uint32 NumBlocks;
+
+public:
+
+	/** Default constructor. */
+	FVlcMediaPrefetchOptions()
+		: BlockSize(256 * 1024)
+		, NumBlocks(16)
+	{ }
+};
+
+
+/**
+ * Statistics of reading media through the read-ahead cache.
+ */
+struct FVlcMediaPrefetchStats
+{
+	/** Number of bytes that were read from the backing store. */
+	uint64 NumBytesFetched;
+
+	/** Number of reads that were served from the cache. */
+	uint64 NumCacheHits;
+
+	/** Number of reads that had to wait for the backing store. */
+	uint64 NumCacheMisses;
+
+	/** Number of reads that did not continue where the previous read ended. */
+	uint64 NumRandomAccesses;
+
+	/** Time that the read-ahead thread spent reading from the backing store (in seconds). */
+	double FetchTime;
+
+	/** Time that libvlc's input thread spent waiting for data (in seconds). */
+	double StallTime;
+
+	/** Average rate at which the backing store delivered data (in bytes per second). */
+	double Throughput;
+
+public:
+
+	/** Default constructor. */
+	FVlcMediaPrefetchStats()
+		: NumBytesFetched(0)
+		, NumCacheHits(0)
+		, NumCacheMisses(0)
+		, NumRandomAccesses(0)
+		, FetchTime(0.0)
+		, StallTime(0.0)
+		, Throughput(0.0)
+	{ }
+};
@@ -30,10 +30,23 @@ namespace UnrealBuildTool.Rules
 				}
 			);
 
+			PublicIncludePathModuleNames.AddRange(
+				new string[] {
+					"Media",
+				}
+			);
+
+			PublicIncludePaths.AddRange(
+				new string[] {
+					"VlcMedia/Public",
+				}
+			);
+
 			PrivateIncludePaths.AddRange(
 				new string[] {
 					"VlcMedia/Private",
                     "VlcMedia/Private/Player",
+                    "VlcMedia/Private/Shared",
                     "VlcMedia/Private/Tracks",
                     "VlcMedia/Private/Vlc",
 				}